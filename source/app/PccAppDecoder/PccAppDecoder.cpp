@@ -47,9 +47,10 @@ int main( int argc, char* argv[] ) {
   // Timers to count elapsed wall/user time
   pcc::chrono::Stopwatch<std::chrono::steady_clock> clockWall;
   pcc::chrono::StopwatchUserTime                    clockUser;
+  pcc::chrono::Stopwatch<std::chrono::steady_clock> clockDecode;
 
   clockWall.start();
-  int ret = decompressVideo( decoderParams, metricsParams, clockUser );
+  int ret = decompressVideo( decoderParams, metricsParams, clockUser, clockDecode );
   clockWall.stop();
   
   using namespace std::chrono;
@@ -57,6 +58,9 @@ int main( int argc, char* argv[] ) {
   auto totalWall = duration_cast<ms>( clockWall.count() ).count();
   std::cout << "Processing time (wall): " << ( ret == 0 ? totalWall / 1000.0 : -1 ) << " s\n";
 
+  auto totalDecode = duration_cast<ms>( clockDecode.count() ).count();
+  std::cout << "Processing time (decode wall): " << ( ret == 0 ? totalDecode / 1000.0 : -1 ) << " s\n";
+
   auto totalUserSelf = duration_cast<ms>( clockUser.self.count() ).count();
   std::cout << "Processing time (user.self): " << ( ret == 0 ? totalUserSelf / 1000.0 : -1 ) << " s\n";
 
@@ -236,15 +240,17 @@ bool parseParameters( int                   argc,
     return false;
   }
   metricsParams.startFrameNumber_ = decoderParams.startFrameNumber_;
+  metricsParams.nbThread_         = decoderParams.nbThread_;
 
   // report the current configuration (only in the absence of errors so
   // that errors/warnings are more obvious and in the same place).
   return !err.is_errored;
 }
 
-int decompressVideo( const PCCDecoderParameters& decoderParams,
-                     const PCCMetricsParameters& metricsParams,
-                     StopwatchUserTime&          clock ) {
+int decompressVideo( const PCCDecoderParameters&                        decoderParams,
+                     const PCCMetricsParameters&                        metricsParams,
+                     StopwatchUserTime&                                 clock,
+                     pcc::chrono::Stopwatch<std::chrono::steady_clock>& clockDecode ) {
   PCCBitstream     bitstream;
   PCCBitstreamStat bitstreamStat;
 #ifdef BITSTREAM_TRACE
@@ -265,6 +271,36 @@ int decompressVideo( const PCCDecoderParameters& decoderParams,
   if ( metricsParams.computeChecksum_ ) { checksum.read( decoderParams.compressedStreamPath_ ); }
   PCCDecoder decoder;
   decoder.setParameters( decoderParams );
+  // The reconstructed frames are written by a dedicated thread as soon as they are available, while the next ones are
+  // reconstructed: the callback only queues them, so that the file I/O neither holds the decoder tasks nor is counted
+  // by the decode stopwatch. The user time stopwatch counts all the threads of the process, including the writer one.
+  // The writer is joined once the group of frames is decoded, before the checksums and the metrics use the frames.
+  std::mutex                                   writeMutex;
+  std::condition_variable                      writeCondition;
+  std::deque<std::pair<size_t, PCCPointSet3*>> writeQueue;
+  bool                                         writeDone         = false;
+  auto                                         writeReconstructs = [&] {
+    std::unique_lock<std::mutex> lock( writeMutex );
+    while ( true ) {
+      writeCondition.wait( lock, [&] { return !writeQueue.empty() || writeDone; } );
+      if ( writeQueue.empty() ) { return; }
+      const size_t  frameIndex  = writeQueue.front().first;
+      PCCPointSet3& reconstruct = *writeQueue.front().second;
+      writeQueue.pop_front();
+      lock.unlock();
+      reconstruct.write( stringFormat( decoderParams.reconstructedDataPath_.c_str(), frameNumber + frameIndex ), true );
+      lock.lock();
+    }
+  };
+  if ( !decoderParams.reconstructedDataPath_.empty() ) {
+    decoder.setReconstructionCallback( [&]( size_t frameIndex, PCCPointSet3& reconstruct ) {
+      {
+        std::lock_guard<std::mutex> lock( writeMutex );
+        writeQueue.emplace_back( frameIndex, &reconstruct );
+      }
+      writeCondition.notify_one();
+    } );
+  }
 
   SampleStreamV3CUnit ssvu;
   PCCBitstreamReader  bitstreamReader;
@@ -299,8 +335,23 @@ int decompressVideo( const PCCDecoderParameters& decoderParams,
       // first allocating the structures, frames will be added as the V3C
       // units are being decoded ???
       context.setAtlasIndex( atlId );
+      std::thread writer;
+      if ( !decoderParams.reconstructedDataPath_.empty() ) {
+        writeDone = false;
+        writer    = std::thread( writeReconstructs );
+      }
+      clockDecode.start();
       int retDecoding = decoder.decode( context, reconstructs, atlId );
+      clockDecode.stop();
       clock.stop();
+      if ( writer.joinable() ) {
+        {
+          std::lock_guard<std::mutex> lock( writeMutex );
+          writeDone = true;
+        }
+        writeCondition.notify_one();
+        writer.join();
+      }
       if ( retDecoding != 0 ) { return retDecoding; }
       if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstructs ); }
       if ( metricsParams.computeMetrics_ ) {
@@ -320,11 +371,7 @@ int decompressVideo( const PCCDecoderParameters& decoderParams,
         sources.clear();
         normals.clear();
       }
-      if ( !decoderParams.reconstructedDataPath_.empty() ) {
-        reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber );
-      } else {
-        frameNumber += reconstructs.getFrameCount();
-      }
+      frameNumber += reconstructs.getFrameCount();
       bMoreData = ( ssvu.getV3CUnitCount() > 0 );
     }
   }
@@ -50,6 +50,10 @@
 #include "PCCMetricsParameters.h"
 #include <program_options_lite.h>
 #include <tbb/tbb.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 bool parseParameters( int                        argc,
                       char*                      argv[],
@@ -58,6 +62,7 @@ bool parseParameters( int                        argc,
 void usage();
 int  decompressVideo( const pcc::PCCDecoderParameters& decoderParams,
                       const pcc::PCCMetricsParameters& metricsParams,
-                      pcc::chrono::StopwatchUserTime& );
+                      pcc::chrono::StopwatchUserTime&,
+                      pcc::chrono::Stopwatch<std::chrono::steady_clock>& );
 
 #endif /* PCC_APP_ENCODER_H */
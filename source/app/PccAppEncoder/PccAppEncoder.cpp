@@ -47,9 +47,10 @@ int main( int argc, char* argv[] ) {
   // Timers to count elapsed wall/user time
   pcc::chrono::Stopwatch<std::chrono::steady_clock> clockWall;
   pcc::chrono::StopwatchUserTime                    clockUser;
+  pcc::chrono::Stopwatch<std::chrono::steady_clock> clockEncode;
 
   clockWall.start();
-  int ret = compressVideo( encoderParams, metricsParams, clockUser );
+  int ret = compressVideo( encoderParams, metricsParams, clockUser, clockEncode );
   clockWall.stop();
 
   using namespace std::chrono;
@@ -57,6 +58,9 @@ int main( int argc, char* argv[] ) {
   auto totalWall = duration_cast<ms>( clockWall.count() ).count();
   std::cout << "Processing time (wall): " << ( ret == 0 ? totalWall / 1000.0 : -1 ) << " s\n";
 
+  auto totalEncode = duration_cast<ms>( clockEncode.count() ).count();
+  std::cout << "Processing time (encode wall): " << ( ret == 0 ? totalEncode / 1000.0 : -1 ) << " s\n";
+
   auto totalUserSelf = duration_cast<ms>( clockUser.self.count() ).count();
   std::cout << "Processing time (user.self): " << ( ret == 0 ? totalUserSelf / 1000.0 : -1 ) << " s\n";
 
@@ -163,6 +167,11 @@ bool parseParameters( int                   argc,
       encoderParams.nnNormalEstimation_,
       encoderParams.nnNormalEstimation_,
       "Number of points used for normal estimation" )
+    ( "fastNormalEstimation",
+      encoderParams.fastNormalEstimation_,
+      encoderParams.fastNormalEstimation_,
+      "Estimate the normals in single precision with a closed-form eigen solver instead of the Jacobi iterations "
+      "in double precision" )
     ( "gridBasedRefineSegmentation",
       encoderParams.gridBasedRefineSegmentation_,
       encoderParams.gridBasedRefineSegmentation_,
@@ -259,6 +268,10 @@ bool parseParameters( int                   argc,
       encoderParams.occupancyMapQP_,
       encoderParams.occupancyMapQP_,
       "QP for compression of occupancy map video" )
+    ( "occupancyMapCodecId",
+      encoderParams.occupancyMapCodecId_,
+      encoderParams.occupancyMapCodecId_,
+      "Video codec of the occupancy map: 0: HEVC, 1: built-in lossless codec" )
 
     // EOM code
     ( "enhancedOccupancyMapCode",
@@ -497,12 +510,24 @@ bool parseParameters( int                   argc,
       encoderParams.textureMPConfig_,
       encoderParams.textureMPConfig_,
       "HM configuration file for raw points texture compression" )
+    ( "geometryMPCodecId",
+      encoderParams.geometryMPCodecId_,
+      encoderParams.geometryMPCodecId_,
+      "Video codec of the raw points geometry: 0: HEVC, 1: built-in lossless codec" )
+    ( "textureMPCodecId",
+      encoderParams.textureMPCodecId_,
+      encoderParams.textureMPCodecId_,
+      "Video codec of the raw points texture: 0: HEVC, 1: built-in lossless codec" )
 
     // etc
     ( "nbThread",
       encoderParams.nbThread_,
       encoderParams.nbThread_,
       "Number of thread used for parallel processing" )
+    ( "nbFrameParallelSegmentation",
+      encoderParams.nbFrameParallelSegmentation_,
+      encoderParams.nbFrameParallelSegmentation_,
+      "Number of frames of a GOF segmented concurrently (1: sequential)" )
     ( "keepIntermediateFiles",
       encoderParams.keepIntermediateFiles_,
       encoderParams.keepIntermediateFiles_,
@@ -634,6 +659,11 @@ bool parseParameters( int                   argc,
       encoderParams.textureBGFill_,
       "Selects the background filling operation for texture only (0: patch-edge extension, "
       "1(default): smoothed push-pull algorithm), 2: harmonic background filling " )
+    ( "textureBGFillTolerance",
+      encoderParams.textureBGFillTolerance_,
+      encoderParams.textureBGFillTolerance_,
+      "Convergence threshold of the harmonic background filling: mean squared update of the filled pixels "
+      "(default=0.00001)" )
 
     // lossy-raw-points patch
     ( "lossyRawPointsPatch",
@@ -859,6 +889,7 @@ bool parseParameters( int                   argc,
   metricsParams.print();
   if ( !metricsParams.check() ) { std::cerr << "Input metrics parameters not correct \n"; }
   metricsParams.startFrameNumber_ = encoderParams.startFrameNumber_;
+  metricsParams.nbThread_         = encoderParams.nbThread_;
 
   // report the current configuration (only in the absence of errors so
   // that errors/warnings are more obvious and in the same place).
@@ -867,9 +898,18 @@ bool parseParameters( int                   argc,
   return true;
 }
 
-int compressVideo( const PCCEncoderParameters& encoderParams,
-                   const PCCMetricsParameters& metricsParams,
-                   StopwatchUserTime&          clock ) {
+// Sources of a group of frames, and the normals used by the metrics, loaded ahead of their encoding.
+struct GroupOfFramesInput {
+  PCCGroupOfFrames sources;
+  PCCGroupOfFrames normals;
+  bool             loaded        = false;
+  bool             normalsLoaded = true;
+};
+
+int compressVideo( const PCCEncoderParameters&                        encoderParams,
+                   const PCCMetricsParameters&                        metricsParams,
+                   StopwatchUserTime&                                 clock,
+                   pcc::chrono::Stopwatch<std::chrono::steady_clock>& clockEncode ) {
   const size_t startFrameNumber0        = encoderParams.startFrameNumber_;
   size_t endFrameNumber0                = encoderParams.startFrameNumber_ + encoderParams.frameCount_;
   const size_t groupOfFramesSize0       = ( std::max )( size_t( 1 ), encoderParams.groupOfFramesSize_ );
@@ -890,6 +930,29 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
 
   PCCBitstreamStat    bitstreamStat;
   SampleStreamV3CUnit ssvu;
+  // The file I/O is overlapped with the encoding: the sources of the next group of frames are loaded and the
+  // reconstructions of the previous one are written in the background while the current one is encoded, and both
+  // tasks are joined once it is encoded. The user time stopwatch counts all the threads of the process, including the
+  // I/O ones, so the encoding alone is measured by the wall clock stopwatch around encode(). At most one load and one
+  // write are pending.
+  auto loadGroupOfFrames = [&]( size_t startFrame, size_t endFrame ) {
+    std::unique_ptr<GroupOfFramesInput> input( new GroupOfFramesInput );
+    input->loaded = input->sources.load( encoderParams.uncompressedDataPath_, startFrame, endFrame,
+                                         encoderParams.colorTransform_ );
+    if ( input->loaded && metricsParams.computeMetrics_ && !metricsParams.normalDataPath_.empty() ) {
+      input->normalsLoaded = input->normals.load( metricsParams.normalDataPath_, startFrame,
+                                                  startFrame + input->sources.getFrameCount(), COLOR_TRANSFORM_NONE,
+                                                  true );
+    }
+    return input;
+  };
+  PCCGroupOfFrames                                 writtenReconstructs;
+  std::future<bool>                                pendingWrite;
+  std::future<std::unique_ptr<GroupOfFramesInput>> nextInput;
+  if ( startFrameNumber < endFrameNumber0 ) {
+    nextInput = std::async( std::launch::async, loadGroupOfFrames, startFrameNumber,
+                            min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 ) );
+  }
   // Place to get/set default values for gof metadata enabled flags (in sequence
   // level).
   while ( startFrameNumber < endFrameNumber0 ) {
@@ -898,20 +961,25 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
     context.setBitstreamStat( bitstreamStat );
     context.addV3CParameterSet( contextIndex );
     context.setActiveVpsId( contextIndex );
-    PCCGroupOfFrames sources;
-    PCCGroupOfFrames reconstructs;
-    if ( !sources.load( encoderParams.uncompressedDataPath_, startFrameNumber, endFrameNumber,
-                        encoderParams.colorTransform_ ) ) {
-      return -1;
-    }
+    std::unique_ptr<GroupOfFramesInput> input = nextInput.get();
+    if ( !input->loaded ) { return -1; }
+    PCCGroupOfFrames& sources = input->sources;
+    PCCGroupOfFrames& normals = input->normals;
+    PCCGroupOfFrames  reconstructs;
     if ( sources.getFrameCount() < endFrameNumber - startFrameNumber ) {
       endFrameNumber = startFrameNumber + sources.getFrameCount();
       endFrameNumber0 = endFrameNumber;
     }
+    if ( endFrameNumber < endFrameNumber0 ) {
+      nextInput = std::async( std::launch::async, loadGroupOfFrames, endFrameNumber,
+                              min( endFrameNumber + groupOfFramesSize0, endFrameNumber0 ) );
+    }
     clock.start();
     std::cout << "Compressing group of frames " << contextIndex << ": " << startFrameNumber << " -> " << endFrameNumber
               << "..." << std::endl;
+    clockEncode.start();
     int ret = encoder.encode( sources, context, reconstructs );
+    clockEncode.stop();
     PCCBitstreamWriter bitstreamWriter;
 #ifdef BITSTREAM_TRACE
     PCCBitstream bitstream;
@@ -927,17 +995,8 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
     bitstream.closeTrace();
 #endif
     clock.stop();
-    PCCGroupOfFrames normals;
-    bool             bRunMetric = true;
-    if ( metricsParams.computeMetrics_ ) {
-      if ( !metricsParams.normalDataPath_.empty() ) {
-        if ( !normals.load( metricsParams.normalDataPath_, startFrameNumber, endFrameNumber, COLOR_TRANSFORM_NONE,
-                            true ) ) {
-          bRunMetric = false;
-        }
-      }
-      if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
-    }
+    if ( pendingWrite.valid() ) { pendingWrite.get(); }
+    if ( metricsParams.computeMetrics_ && input->normalsLoaded ) { metrics.compute( sources, reconstructs, normals ); }
     if ( metricsParams.computeChecksum_ ) {
       if ( encoderParams.losslessGeo_ ) {
         checksum.computeSource( sources );
@@ -947,14 +1006,15 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
     }
     if ( ret != 0 ) { return ret; }
     if ( !encoderParams.reconstructedDataPath_.empty() ) {
-      reconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+      writtenReconstructs.getFrames().swap( reconstructs.getFrames() );
+      pendingWrite = std::async( std::launch::async, [&] {
+        return writtenReconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+      } );
     }
-    sources.clear();
-    reconstructs.clear();
-    normals.clear();
     startFrameNumber = endFrameNumber;
     contextIndex++;
   }
+  if ( pendingWrite.valid() ) { pendingWrite.get(); }
 
   PCCBitstream bitstream;
 #ifdef BITSTREAM_TRACE
@@ -50,6 +50,7 @@
 #include "PCCMetricsParameters.h"
 #include <program_options_lite.h>
 #include <tbb/tbb.h>
+#include <future>
 
 bool parseParameters( int                        argc,
                       char*                      argv[],
@@ -58,6 +59,7 @@ bool parseParameters( int                        argc,
 void usage();
 int  compressVideo( const pcc::PCCEncoderParameters& encoderParams,
                     const pcc::PCCMetricsParameters& metricsParams,
-                    pcc::chrono::StopwatchUserTime& );
+                    pcc::chrono::StopwatchUserTime&,
+                    pcc::chrono::Stopwatch<std::chrono::steady_clock>& );
 
 #endif /* PCC_APP_DECODER_H */
@@ -167,9 +167,15 @@ class PCCBitstream {
   bool initialize( std::vector<uint8_t>& data );
   bool initialize( const PCCBitstream& bitstream );
   bool initialize( const std::string& compressedStreamPath );
-  void initialize( uint64_t capacity ) { data_.resize( capacity, 0 ); }
+  void initialize( uint64_t capacity ) {
+    view_     = nullptr;
+    viewSize_ = 0;
+    data_.resize( capacity, 0 );
+  }
   void clear() {
     data_.clear();
+    view_            = nullptr;
+    viewSize_        = 0;
     position_.bits_  = 0;
     position_.bytes_ = 0;
   }
@@ -178,10 +184,13 @@ class PCCBitstream {
     position_.bytes_ = 0;
   }
   bool                  write( const std::string& compressedStreamPath );
-  uint8_t*              buffer() { return data_.data(); }
-  std::vector<uint8_t>& vector() { return data_; }
+  const uint8_t*        buffer() const { return data(); }
+  std::vector<uint8_t>& vector() {
+    materialize();
+    return data_;
+  }
   uint64_t&             size() { return position_.bytes_; }
-  uint64_t              capacity() { return data_.size(); }
+  uint64_t              capacity() const { return dataSize(); }
   PCCBistreamPosition   getPosition() { return position_; }
   void                  setPosition( PCCBistreamPosition& val ) { position_ = val; }
   PCCBitstream&         operator+=( const uint64_t size ) {
@@ -190,11 +199,12 @@ class PCCBitstream {
   }
   void writeBuffer( const uint8_t* data, const size_t size );
   void copyFrom( PCCBitstream& dataBitstream, const uint64_t startByte, const uint64_t bitstreamSize );
+  void viewFrom( PCCBitstream& dataBitstream, const uint64_t startByte, const uint64_t bitstreamSize );
   void copyTo( PCCBitstream& dataBitstream, uint64_t startByte, uint64_t outputSize );
   void write( PCCVideoBitstream& videoBitstream );
   void read( PCCVideoBitstream& videoBitstream );
   bool byteAligned() { return ( position_.bits_ == 0 ); }
-  bool moreData() { return position_.bytes_ < data_.size(); }
+  bool moreData() { return position_.bytes_ < dataSize(); }
 
   inline std::string readString() {
     while ( !byteAligned() ) { read( 1 ); }
@@ -272,13 +282,14 @@ class PCCBitstream {
     bool     traceStartingValue = trace_;
     trace_                      = false;
 #endif
-    uint32_t length = 1, temp = ++code;
-    while ( 1 != temp ) {
-      temp >>= 1;
-      length += 2;
+    // length leading zeros followed by the length + 1 bits of code + 1
+    const uint32_t length = floorLog2( ++code );
+    if ( 2 * length + 1 <= 32 ) {
+      write( code, 2 * length + 1, position_ );
+    } else {
+      write( 0, length, position_ );
+      write( code, length + 1, position_ );
     }
-    write( 0, length >> 1 );
-    write( code, ( length + 1 ) >> 1 );
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", orgCode );
@@ -290,17 +301,11 @@ class PCCBitstream {
     bool traceStartingValue = trace_;
     trace_                  = false;
 #endif
-    uint32_t value = 0, code = 0, length = 0;
-    code = read( 1 );
-    if ( 0 == code ) {
-      length = 0;
-      while ( !( code & 1 ) ) {
-        code = read( 1 );
-        length++;
-      }
-      value = read( length );
-      value += ( 1 << length ) - 1;
-    }
+    // the length of the prefix is the number of leading zeros of the next 32 bits
+    const uint32_t next   = static_cast<uint32_t>( ( peek( position_ ) << position_.bits_ ) >> 32 );
+    const uint32_t length = next == 0 ? 32 : 31 - floorLog2( next );
+    advance( position_, length + 1 );
+    uint32_t value = read( length, position_ ) + static_cast<uint32_t>( ( uint64_t( 1 ) << length ) - 1 );
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", value );
@@ -357,35 +362,68 @@ class PCCBitstream {
   }
 #endif
  private:
-  inline void realloc( const size_t size = 4096 ) { data_.resize( data_.size() + ( ( ( size / 4096 ) + 1 ) * 4096 ) ); }
-  inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
-    uint32_t value = 0;
-    for ( size_t i = 0; i < bits; i++ ) {
-      value |= ( ( data_[pos.bytes_] >> ( 7 - pos.bits_ ) ) & 1 ) << ( bits - 1 - i );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
+  // a view reads the bytes of another bitstream, which must outlive it, instead of its own buffer
+  inline const uint8_t* data() const { return view_ != nullptr ? view_ : data_.data(); }
+  inline uint64_t       dataSize() const { return view_ != nullptr ? viewSize_ : data_.size(); }
+
+  // copies the viewed bytes in the own buffer before it is accessed directly
+  inline void materialize() {
+    if ( view_ == nullptr ) { return; }
+    data_.assign( view_, view_ + viewSize_ );
+    view_     = nullptr;
+    viewSize_ = 0;
+  }
+
+  // grows the buffer by at least size bytes and at least doubles it
+  inline void realloc( const size_t size = 4096 ) {
+    materialize();
+    data_.resize( data_.size() + ( std::max )( data_.size(), ( ( size / 4096 ) + 1 ) * 4096 ) );
+  }
+
+  // 64 bits of the stream starting at the byte of pos, the bytes past the end of the buffer are read as 0
+  inline uint64_t peek( const PCCBistreamPosition& pos ) const {
+    uint64_t       window = 0;
+    const uint8_t* data   = this->data();
+    const uint64_t size   = dataSize();
+    if ( pos.bytes_ + 8 <= size ) {
+      for ( size_t i = 0; i < 8; i++ ) { window = ( window << 8 ) | data[pos.bytes_ + i]; }
+    } else {
+      for ( size_t i = 0; i < 8; i++ ) {
+        window = ( window << 8 ) | ( pos.bytes_ + i < size ? data[pos.bytes_ + i] : 0 );
       }
     }
+    return window;
+  }
+
+  inline void advance( PCCBistreamPosition& pos, const size_t bits ) {
+    const size_t offset = pos.bits_ + bits;
+    pos.bytes_ += offset >> 3;
+    pos.bits_ = static_cast<uint8_t>( offset & 7 );
+  }
+
+  inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
+    assert( bits <= 32 );
+    if ( bits == 0 ) { return 0; }
+    const uint32_t value = static_cast<uint32_t>( ( peek( pos ) << pos.bits_ ) >> ( 64 - bits ) );
+    advance( pos, bits );
     return value;
   }
 
   inline void write( uint32_t value, uint8_t bits, PCCBistreamPosition& pos ) {
-    if ( pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
-    for ( size_t i = 0; i < bits; i++ ) {
-      data_[pos.bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - pos.bits_ );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
-    }
+    assert( bits <= 32 );
+    if ( view_ != nullptr || pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
+    if ( bits == 0 ) { return; }
+    // the field is stored on the most significant bits of a window starting at the current byte
+    const uint64_t window = ( uint64_t( value ) << ( 64 - bits ) ) >> pos.bits_;
+    const size_t   count  = ( pos.bits_ + bits + 7 ) >> 3;
+    uint8_t*       data   = data_.data() + pos.bytes_;
+    for ( size_t i = 0; i < count; i++ ) { data[i] |= static_cast<uint8_t>( window >> ( 56 - 8 * i ) ); }
+    advance( pos, bits );
   }
 
   std::vector<uint8_t> data_;
+  const uint8_t*       view_;
+  uint64_t             viewSize_;
   PCCBistreamPosition  position_;
   PCCBistreamPosition  totalSizeIterator_;
 
@@ -169,7 +169,11 @@ enum V3CUnitType {
   NUM_V3C_UNIT_TYPE  // undefined
 };
 
-enum PCCCodecID { CODEC_HEVC = 0 };
+// CODEC_LOSSLESS is the built-in lossless video codec, which has no V3C codec id of its own: the codec id of its
+// sub-streams is mapped to LOSSLESS_CODEC_4CC by the component codec mapping SEI, the sub-streams whose codec id is not
+// mapped are HEVC ones.
+enum PCCCodecID { CODEC_HEVC = 0, CODEC_LOSSLESS };
+const char* const LOSSLESS_CODEC_4CC = "tmcl";
 
 enum PCCCodecGroup {
   CODEC_GROUP_AVC_PROGRESSIVE_HIGH = 0,
@@ -330,6 +330,28 @@ class PCCHighLevelSyntax {
   PCCVideoBitstream& getVideoBitstream( size_t index ) { return atlasHLS_[atlasIndex_].getVideoBitstream( index ); }
   PCCVideoBitstream& getVideoBitstream( PCCVideoType type ) { return atlasHLS_[atlasIndex_].getVideoBitstream( type ); }
   void               printVideoBitstream() { return atlasHLS_[atlasIndex_].printVideoBitstream(); };
+  // codec of a video sub-stream of the current atlas: the codec id signaled in the V3C parameter set is resolved with
+  // the component codec mapping SEI of the atlas
+  PCCCodecID getVideoCodecId( PCCVideoType type ) {
+    auto&   vps = getVps();
+    uint8_t codecId;
+    if ( type == VIDEO_OCCUPANCY ) {
+      codecId = vps.getOccupancyInformation( atlasIndex_ ).getOccupancyCodecId();
+    } else if ( type < VIDEO_GEOMETRY_RAW ) {
+      codecId = vps.getGeometryInformation( atlasIndex_ ).getGeometryCodecId();
+    } else if ( type == VIDEO_GEOMETRY_RAW ) {
+      codecId = vps.getGeometryInformation( atlasIndex_ ).getAuxiliaryGeometryCodecId();
+    } else if ( type < VIDEO_TEXTURE_RAW ) {
+      codecId = vps.getAttributeInformation( atlasIndex_ ).getAttributeCodecId( 0 );
+    } else {
+      codecId = vps.getAttributeInformation( atlasIndex_ ).getAuxiliaryAttributeCodecId( 0 );
+    }
+    if ( seiIsPresent( NAL_PREFIX_ESEI, COMPONENT_CODEC_MAPPING ) ) {
+      auto* sei = static_cast<SEIComponentCodecMapping*>( getSei( NAL_PREFIX_ESEI, COMPONENT_CODEC_MAPPING ) );
+      if ( sei->getCodec4cc( codecId ) == LOSSLESS_CODEC_4CC ) { return CODEC_LOSSLESS; }
+    }
+    return CODEC_HEVC;
+  }
   // ASPS related functions
   void                           setActiveASPS( size_t aspsId ) { atlasHLS_[atlasIndex_].setActiveASPS( aspsId ); }
   AtlasSequenceParameterSetRbsp& getAtlasSequenceParameterSet( size_t setId ) {
@@ -39,14 +39,26 @@ namespace pcc {
 
 class PCCVideoBitstream {
  public:
-  PCCVideoBitstream( PCCVideoType type ) : type_( type ) { data_.clear(); }
+  PCCVideoBitstream( PCCVideoType type ) : view_( nullptr ), viewSize_( 0 ), type_( type ) { data_.clear(); }
   ~PCCVideoBitstream() { data_.clear(); }
 
-  void                  resize( size_t size ) { data_.resize( size ); }
-  std::vector<uint8_t>& vector() { return data_; }
-  uint8_t*              buffer() { return data_.data(); }
-  size_t                size() { return data_.size(); }
-  PCCVideoType          type() { return type_; }
+  void resize( size_t size ) {
+    materialize();
+    data_.resize( size );
+  }
+  std::vector<uint8_t>& vector() {
+    materialize();
+    return data_;
+  }
+  // refers to bytes owned by the decoded bitstream, which must outlive this object, instead of copying them
+  void viewFrom( const uint8_t* data, size_t size ) {
+    data_.clear();
+    view_     = data;
+    viewSize_ = size;
+  }
+  const uint8_t* buffer() const { return view_ != nullptr ? view_ : data_.data(); }
+  size_t         size() const { return view_ != nullptr ? viewSize_ : data_.size(); }
+  PCCVideoType   type() { return type_; }
 
   void trace() { std::cout << toString( type_ ) << " ->" << size() << " B " << std::endl; }
 
@@ -73,7 +85,7 @@ class PCCVideoBitstream {
   bool write( const std::string& filename ) {
     std::ofstream file( filename, std::ios::binary );
     if ( !file.good() ) { return false; }
-    file.write( reinterpret_cast<char*>( data_.data() ), data_.size() );
+    file.write( reinterpret_cast<const char*>( buffer() ), size() );
     file.close();
     return true;
   }
@@ -90,7 +102,16 @@ class PCCVideoBitstream {
   }
 
  private:
+  void materialize() {
+    if ( view_ == nullptr ) { return; }
+    data_.assign( view_, view_ + viewSize_ );
+    view_     = nullptr;
+    viewSize_ = 0;
+  }
+
   std::vector<uint8_t> data_;
+  const uint8_t*       view_;
+  size_t               viewSize_;
   PCCVideoType         type_;
 };
 
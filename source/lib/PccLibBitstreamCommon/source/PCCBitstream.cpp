@@ -39,6 +39,8 @@ using namespace pcc;
 PCCBitstream::PCCBitstream() {
   position_.bytes_ = 0;
   position_.bits_  = 0;
+  view_            = nullptr;
+  viewSize_        = 0;
   data_.clear();
 #ifdef BITSTREAM_TRACE
   trace_     = false;
@@ -51,14 +53,17 @@ PCCBitstream::~PCCBitstream() { data_.clear(); }
 bool PCCBitstream::initialize( const PCCBitstream& bitstream ) {
   position_.bytes_ = 0;
   position_.bits_  = 0;
-  data_.resize( bitstream.data_.size(), 0 );
-  memcpy( data_.data(), bitstream.data_.data(), bitstream.data_.size() );
+  view_            = nullptr;
+  viewSize_        = 0;
+  data_.assign( bitstream.data(), bitstream.data() + bitstream.dataSize() );
   return true;
 }
 
 bool PCCBitstream::initialize( std::vector<uint8_t>& data ) {
   position_.bytes_ = 0;
   position_.bits_  = 0;
+  view_            = nullptr;
+  viewSize_        = 0;
   data_.resize( data.size(), 0 );
   memcpy( data_.data(), data.data(), data.size() );
   return true;
@@ -80,7 +85,7 @@ bool PCCBitstream::initialize( const std::string& compressedStreamPath ) {
 bool PCCBitstream::write( const std::string& compressedStreamPath ) {
   std::ofstream fout( compressedStreamPath, std::ios::binary );
   if ( !fout.is_open() ) { return false; }
-  fout.write( reinterpret_cast<const char*>( data_.data() ), size() );
+  fout.write( reinterpret_cast<const char*>( data() ), size() );
   fout.close();
   return true;
 }
@@ -93,8 +98,13 @@ void PCCBitstream::read( PCCVideoBitstream& videoBitstream ) {
 #ifdef BITSTREAM_TRACE
   trace( "Code: size = %zu \n", size );
 #endif
-  videoBitstream.resize( size );
-  memcpy( videoBitstream.buffer(), data_.data() + position_.bytes_, size );
+  // the video bitstream of a view refers to the same loaded buffer, otherwise it must own its data
+  if ( view_ != nullptr ) {
+    videoBitstream.viewFrom( view_ + position_.bytes_, size );
+  } else {
+    videoBitstream.resize( size );
+    memcpy( videoBitstream.vector().data(), data_.data() + position_.bytes_, size );
+  }
   videoBitstream.trace();
   position_.bytes_ += size;
 #ifdef BITSTREAM_TRACE
@@ -114,7 +124,7 @@ void PCCBitstream::write( PCCVideoBitstream& videoBitstream ) {
 }
 
 void PCCBitstream::writeBuffer( const uint8_t* data, const size_t size ) {
-  realloc( size );
+  if ( view_ != nullptr || position_.bytes_ + size + 4 + 16 >= data_.size() ) { realloc( size ); }
   write( static_cast<int32_t>( size ), 32 );
 #ifdef BITSTREAM_TRACE
   trace( "Code: size = %zu \n", size );
@@ -123,6 +133,7 @@ void PCCBitstream::writeBuffer( const uint8_t* data, const size_t size ) {
   position_.bytes_ += size;
 }
 void PCCBitstream::copyFrom( PCCBitstream& dataBitstream, const uint64_t startByte, const uint64_t bitstreamSize ) {
+  materialize();
   if ( data_.size() < position_.bytes_ + bitstreamSize ) { data_.resize( position_.bytes_ + bitstreamSize ); }
   memcpy( data_.data() + position_.bytes_, dataBitstream.buffer() + startByte,
           bitstreamSize );  // dest, source
@@ -131,11 +142,22 @@ void PCCBitstream::copyFrom( PCCBitstream& dataBitstream, const uint64_t startBy
   pos.bytes_ += bitstreamSize;
   dataBitstream.setPosition( pos );
 }
+void PCCBitstream::viewFrom( PCCBitstream& dataBitstream, const uint64_t startByte, const uint64_t bitstreamSize ) {
+  data_.clear();
+  view_            = dataBitstream.data() + startByte;
+  viewSize_        = bitstreamSize;
+  position_.bytes_ = bitstreamSize;
+  position_.bits_  = 0;
+  PCCBistreamPosition pos = dataBitstream.getPosition();
+  pos.bytes_ += bitstreamSize;
+  dataBitstream.setPosition( pos );
+}
 void PCCBitstream::copyTo( PCCBitstream& dataBitstream, uint64_t startByte, uint64_t outputSize ) {
 #ifdef BITSTREAM_TRACE
   trace( "Code copied to: size = %zu \n", outputSize );
 #endif
   dataBitstream.initialize( outputSize );
+  materialize();
   PCCBistreamPosition pos = dataBitstream.getPosition();
   memcpy( data_.data() + startByte, dataBitstream.buffer(), outputSize );
   pos.bytes_ += outputSize;
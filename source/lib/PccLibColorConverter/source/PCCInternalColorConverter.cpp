@@ -397,116 +397,219 @@ void PCCInternalColorConverter<T>::convertRGB44ToYUV420( PCCVideo<T, 3>& videoSr
   }
 }
 
-template <typename T>
-void PCCInternalColorConverter<T>::convertRGB44ToYUV420( PCCImage<T, 3>& imageSrc,
-                                                         PCCImage<T, 3>& imageDst,
-                                                         size_t          nbyte,
-                                                         size_t          filter ) {
-  int width  = (int)imageSrc.getWidth();
-  int height = (int)imageSrc.getHeight();
-  imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV420 );
-  std::vector<float> RGB444[3], YUV444[3], YUV420[3];
-  RGBtoFloatRGB( imageSrc[0], RGB444[0], nbyte );
-  RGBtoFloatRGB( imageSrc[1], RGB444[1], nbyte );
-  RGBtoFloatRGB( imageSrc[2], RGB444[2], nbyte );
-  convertRGBToYUV( RGB444[0], RGB444[1], RGB444[2], YUV444[0], YUV444[1], YUV444[2] );
-  downsampling( YUV444[1], YUV420[1], width, height, nbyte == 1 ? 255 : 1023, filter );
-  downsampling( YUV444[2], YUV420[2], width, height, nbyte == 1 ? 255 : 1023, filter );
-  floatYUVToYUV( YUV444[0], imageDst[0], 0, nbyte );
-  floatYUVToYUV( YUV420[1], imageDst[1], 1, nbyte );
-  floatYUVToYUV( YUV420[2], imageDst[2], 1, nbyte );
+// The conversions are computed row by row, without full-frame float planes: the horizontal filters are applied to
+// the rows extended by their borders and the vertical filters to the rows kept in a ring buffer. The filters loop over
+// their taps and apply each tap to the whole row with the float and double operations, in the same order, of the
+// sample-wise definition of the filters: the loops over the samples are vectorized and the output is unchanged.
+
+// Extends a row by pad samples replicating its borders on each side.
+static void extendRow( const float* row, const int width, const int pad, float* extended ) {
+  for ( int x = 0; x < pad; x++ ) {
+    extended[x]               = row[0];
+    extended[pad + width + x] = row[width - 1];
+  }
+  std::copy( row, row + width, extended + pad );
+}
+
+// std::round() written with a truncation to be vectorized.
+static inline float roundHalfAway( const float value ) {
+  return static_cast<float>( static_cast<int32_t>( value + std::copysign( 0.49999997f, value ) ) );
 }
 
+// Quantizes the float samples of a row with the scale and the offset of the luma or of the chroma.
 template <typename T>
-void PCCInternalColorConverter<T>::convertYUV420ToYUV444( PCCVideo<T, 3>& videoSrc,
-                                                          PCCVideo<T, 3>& videoDst,
-                                                          size_t          nbyte,
-                                                          size_t          filter ) {
-  videoDst.resize( videoSrc.getFrameCount() );
-  for ( size_t i = 0; i < videoSrc.getFrameCount(); i++ ) {
-    convertYUV420ToYUV444( videoSrc[i], videoDst[i], nbyte, filter );
+static void quantizeRow( const float* src, const int count, const double scale, const double offset, T* dst ) {
+  const float maxValue = static_cast<float>( scale );
+  for ( int x = 0; x < count; x++ ) {
+    const float value = roundHalfAway( static_cast<float>( scale * static_cast<double>( src[x] ) + offset ) );
+    dst[x]            = static_cast<T>( ( std::min )( ( std::max )( value, 0.f ), maxValue ) );
   }
 }
 
-template <typename T>
-void PCCInternalColorConverter<T>::convertYUV420ToYUV444( PCCImage<T, 3>& imageSrc,
-                                                          PCCImage<T, 3>& imageDst,
-                                                          size_t          nbyte,
-                                                          size_t          filter ) {
-  int width  = (int)imageSrc.getWidth();
-  int height = (int)imageSrc.getHeight();
-  imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV444 );
-  size_t             widthChroma  = width / 2;
-  size_t             heightChroma = height / 2;
-  std::vector<float> YUV444[3], YUV420[3];
-  YUVtoFloatYUV( imageSrc[0], YUV420[0], 0, nbyte );
-  YUVtoFloatYUV( imageSrc[1], YUV420[1], 1, nbyte );
-  YUVtoFloatYUV( imageSrc[2], YUV420[2], 1, nbyte );
-  upsampling( YUV420[1], YUV444[1], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  upsampling( YUV420[2], YUV444[2], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  floatYUVToYUV( YUV420[0], imageDst[0], 0, 2 );
-  floatYUVToYUV( YUV444[1], imageDst[1], 1, 2 );
-  floatYUVToYUV( YUV444[2], imageDst[2], 1, 2 );
+// 444 to 420 filter: src[k] is the sample read by the tap k for the first output sample and step the distance between
+// the samples read for two consecutive outputs. The taps are accumulated in double precision.
+static void downsample( const Filter&       filter,
+                        const float* const* src,
+                        const int           step,
+                        const int           count,
+                        double*             sum,
+                        float*              dst ) {
+  const double scale = 1.0f / ( (float)( 1 << ( (int)filter.shift_ ) ) );
+  std::fill( sum, sum + count, 0.0 );
+  for ( size_t k = 0; k < filter.data_.size(); k++ ) {
+    const double coefficient = filter.data_[k];
+    const float* tap         = src[k];
+    for ( int x = 0; x < count; x++ ) { sum[x] += coefficient * (double)tap[x * step]; }
+  }
+  for ( int x = 0; x < count; x++ ) { dst[x] = (float)( ( sum[x] + 0.0 ) * scale ); }
 }
 
-template <typename T>
-void PCCInternalColorConverter<T>::RGBtoFloatRGB( const std::vector<T>& src,
-                                                  std::vector<float>&   dst,
-                                                  const size_t          nbyte ) const {
-  size_t count = src.size();
-  dst.resize( count );
-  float offset = nbyte == 1 ? 255.f : 1023.f;
-  for ( size_t i = 0; i < count; i++ ) { dst[i] = (float)src[i] / offset; }
+// 420 to 444 filter: src[k] is the row read by the tap k and the output samples are written every step samples. The
+// taps are accumulated in single precision.
+static void upsample( const Filter&       filter,
+                      const float* const* src,
+                      const int           count,
+                      float*              sum,
+                      float*              dst,
+                      const int           step ) {
+  const float scale = 1.0f / ( (float)( 1 << ( (int)filter.shift_ ) ) );
+  std::fill( sum, sum + count, 0.f );
+  for ( size_t k = 0; k < filter.data_.size(); k++ ) {
+    const float  coefficient = filter.data_[k];
+    const float* tap         = src[k];
+    for ( int x = 0; x < count; x++ ) { sum[x] += coefficient * tap[x]; }
+  }
+  for ( int x = 0; x < count; x++ ) { dst[x * step] = ( sum[x] + 0.f ) * scale; }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::convertRGBToYUV( const std::vector<float>& R,
-                                                    const std::vector<float>& G,
-                                                    const std::vector<float>& B,
-                                                    std::vector<float>&       Y,
-                                                    std::vector<float>&       U,
-                                                    std::vector<float>&       V ) const {
-  size_t count = R.size();
-  Y.resize( count );
-  U.resize( count );
-  V.resize( count );
-  for ( size_t i = 0; i < count; i++ ) {
-    Y[i] = (float)( (double)clamp( 0.212600 * R[i] + 0.715200 * G[i] + 0.072200 * B[i], 0.0, 1.0 ) );
-    U[i] = (float)( (double)clamp( -0.114572 * R[i] - 0.385428 * G[i] + 0.500000 * B[i], -0.5, 0.5 ) );
-    V[i] = (float)( (double)clamp( 0.500000 * R[i] - 0.454153 * G[i] - 0.045847 * B[i], -0.5, 0.5 ) );
+void PCCInternalColorConverter<T>::convertRGB44ToYUV420( const PCCImage<T, 3>& imageSrc,
+                                                         PCCImage<T, 3>&       imageDst,
+                                                         size_t                nbyte,
+                                                         size_t                filter ) {
+  const int                 width       = (int)imageSrc.getWidth();
+  const int                 height      = (int)imageSrc.getHeight();
+  const int                 widthOut    = width / 2;
+  const int                 heightOut   = height / 2;
+  const Filter&             horizontal  = g_filter444to420[filter].horizontal_;
+  const Filter&             vertical    = g_filter444to420[filter].vertical_;
+  const int                 tapCountH   = int( horizontal.data_.size() );
+  const int                 tapCountV   = int( vertical.data_.size() );
+  const int                 positionH   = ( tapCountH - 1 ) >> 1;
+  const int                 positionV   = ( tapCountV - 1 ) >> 1;
+  const int                 pad         = tapCountH;
+  const int                 ringSize    = tapCountV + 1;
+  const float               maxRGB      = nbyte == 1 ? 255.f : 1023.f;
+  const double              scale       = nbyte == 1 ? 255. : 65535.;
+  const double              offset      = nbyte == 1 ? 128. : 32768.;
+  std::vector<float>        Y( width ), U( width + 2 * pad ), V( width + 2 * pad ), row( widthOut );
+  std::vector<float>        ringU( ringSize * widthOut ), ringV( ringSize * widthOut );
+  std::vector<double>       sum( widthOut );
+  std::vector<const float*> taps( ( std::max )( tapCountH, tapCountV ) );
+  imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV420 );
+  const auto& R = imageSrc.getChannel( 0 );
+  const auto& G = imageSrc.getChannel( 1 );
+  const auto& B = imageSrc.getChannel( 2 );
+  // filters vertically the rows of the ring buffer, from 2 * i - positionV, to the output row i
+  auto verticalFilter = [&]( const int i ) {
+    for ( size_t c = 1; c < 3; c++ ) {
+      for ( int k = 0; k < tapCountV; k++ ) {
+        const int r = clamp( 2 * i + k - positionV, 0, height - 1 );
+        taps[k]     = ( c == 1 ? ringU : ringV ).data() + ( r % ringSize ) * widthOut;
+      }
+      downsample( vertical, taps.data(), 1, widthOut, sum.data(), row.data() );
+      quantizeRow( row.data(), widthOut, scale, offset, imageDst.getChannel( c ).data() + i * widthOut );
+    }
+  };
+  int next = 0;
+  for ( int r = 0; r < height; r++ ) {
+    const size_t begin = size_t( r ) * width;
+    for ( int x = 0; x < width; x++ ) {
+      const float red   = (float)R[begin + x] / maxRGB;
+      const float green = (float)G[begin + x] / maxRGB;
+      const float blue  = (float)B[begin + x] / maxRGB;
+      Y[x]              = (float)( (double)clamp( 0.212600 * red + 0.715200 * green + 0.072200 * blue, 0.0, 1.0 ) );
+      U[pad + x] = (float)( (double)clamp( -0.114572 * red - 0.385428 * green + 0.500000 * blue, -0.5, 0.5 ) );
+      V[pad + x] = (float)( (double)clamp( 0.500000 * red - 0.454153 * green - 0.045847 * blue, -0.5, 0.5 ) );
+    }
+    quantizeRow( Y.data(), width, scale, 0., imageDst.getChannel( 0 ).data() + begin );
+    // filters horizontally the chroma of the row to the ring buffer
+    for ( size_t c = 1; c < 3; c++ ) {
+      auto& chroma = c == 1 ? U : V;
+      extendRow( chroma.data() + pad, width, pad, chroma.data() );
+      for ( int k = 0; k < tapCountH; k++ ) { taps[k] = chroma.data() + pad + k - positionH; }
+      downsample( horizontal, taps.data(), 2, widthOut, sum.data(),
+                  ( c == 1 ? ringU : ringV ).data() + ( r % ringSize ) * widthOut );
+    }
+    // the output rows are filtered once the last row they read is in the ring buffer
+    while ( next < heightOut && ( std::min )( 2 * next - positionV + tapCountV - 1, height - 1 ) <= r ) {
+      verticalFilter( next++ );
+    }
   }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::floatYUVToYUV( const std::vector<float>& src,
-                                                  std::vector<T>&           dst,
-                                                  const bool                chroma,
-                                                  const size_t              nbyte ) const {
-  size_t count = src.size();
-  dst.resize( count );
-  // double offset = chroma ? nbyte == 1 ? 128. : 512. : 0;
-  // double scale  = nbyte == 1 ? 255. : 1023.;
-  double offset = chroma ? nbyte == 1 ? 128. : 32768. : 0;
-  double scale  = nbyte == 1 ? 255. : 65535.;
-  for ( size_t i = 0; i < count; i++ ) {
-    dst[i] = static_cast<T>( fClip( std::round( (float)( scale * (double)src[i] + offset ) ), 0.f, (float)scale ) );
+void PCCInternalColorConverter<T>::convertYUV420ToYUV444( PCCVideo<T, 3>& videoSrc,
+                                                          PCCVideo<T, 3>& videoDst,
+                                                          size_t          nbyte,
+                                                          size_t          filter ) {
+  videoDst.resize( videoSrc.getFrameCount() );
+  for ( size_t i = 0; i < videoSrc.getFrameCount(); i++ ) {
+    convertYUV420ToYUV444( videoSrc[i], videoDst[i], nbyte, filter );
   }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::YUVtoFloatYUV( const std::vector<T>& src,
-                                                  std::vector<float>&   dst,
-                                                  const bool            chroma,
-                                                  const size_t          nbBytes ) const {
-  size_t count = src.size();
-  dst.resize( count );
-  float    minV   = chroma ? -0.5f : 0.f;
-  float    maxV   = chroma ? 0.5f : 1.f;
-  uint16_t offset = chroma ? nbBytes == 1 ? 128 : 512 : 0;
-  double   scale  = nbBytes == 1 ? 255. : 1023.;
-  double   weight = 1.0 / scale;
-  for ( size_t i = 0; i < count; i++ ) {
-    dst[i] = clamp( (float)( weight * (double)( src[i] - offset ) ), minV, maxV );
+void PCCInternalColorConverter<T>::convertYUV420ToYUV444( const PCCImage<T, 3>& imageSrc,
+                                                          PCCImage<T, 3>&       imageDst,
+                                                          size_t                nbyte,
+                                                          size_t                filter ) {
+  const int             width         = (int)imageSrc.getWidth();
+  const int             height        = (int)imageSrc.getHeight();
+  const int             widthChroma   = width / 2;
+  const int             heightChroma  = height / 2;
+  const Filter420to444& filters       = g_filter420to444[filter];
+  const Filter*         vertical[2]   = {&filters.vertical0_, &filters.vertical1_};
+  const Filter*         horizontal[2] = {&filters.horizontal0_, &filters.horizontal1_};
+  const size_t          tapCount      = ( std::max )( { vertical[0]->data_.size(), vertical[1]->data_.size(),
+                                            horizontal[0]->data_.size(), horizontal[1]->data_.size()} );
+  const int             pad           = int( tapCount );
+  const int             ringSize      = int( vertical[0]->data_.size() + vertical[1]->data_.size() ) + 2;
+  imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV444 );
+  // the samples are converted by look-up tables of all the values of T: the luma to the 16-bit output and the chroma
+  // to the input of the filters
+  const size_t       valueCount = size_t( 1 ) << ( 8 * sizeof( T ) );
+  const int          offset     = nbyte == 1 ? 128 : 512;
+  const double       weight     = 1.0 / ( nbyte == 1 ? 255. : 1023. );
+  std::vector<T>     lumaTable( valueCount );
+  std::vector<float> chromaTable( valueCount );
+  for ( size_t value = 0; value < valueCount; value++ ) {
+    const float luma   = clamp( (float)( weight * (double)( int( value ) ) ), 0.f, 1.f );
+    lumaTable[value]   = static_cast<T>( fClip( std::round( (float)( 65535. * (double)luma ) ), 0.f, 65535.f ) );
+    chromaTable[value] = clamp( (float)( weight * (double)( int( value ) - offset ) ), -0.5f, 0.5f );
+  }
+  const auto& srcY = imageSrc.getChannel( 0 );
+  auto&       dstY = imageDst.getChannel( 0 );
+  for ( size_t i = 0; i < srcY.size(); i++ ) { dstY[i] = lumaTable[srcY[i]]; }
+  std::vector<float>        ring( ringSize * widthChroma ), column( widthChroma ), extended( widthChroma + 2 * pad );
+  std::vector<float>        sum( widthChroma ), row( width );
+  std::vector<int>          ringRow( ringSize );
+  std::vector<const float*> taps( tapCount );
+  for ( size_t c = 1; c < 3; c++ ) {
+    const auto& src = imageSrc.getChannel( c );
+    auto&       dst = imageDst.getChannel( c );
+    std::fill( ringRow.begin(), ringRow.end(), -1 );
+    // the rows of the chroma plane, converted to float when first read
+    auto getRow = [&]( const int r ) {
+      float* values = ring.data() + ( r % ringSize ) * widthChroma;
+      if ( ringRow[r % ringSize] != r ) {
+        const T* codes = src.data() + size_t( r ) * widthChroma;
+        for ( int x = 0; x < widthChroma; x++ ) { values[x] = chromaTable[codes[x]]; }
+        ringRow[r % ringSize] = r;
+      }
+      return values;
+    };
+    for ( int y = 0; y < 2 * heightChroma; y++ ) {
+      // the even rows are interpolated by vertical0 from the row y / 2, the odd ones by vertical1 from y / 2 + 1
+      const Filter& filterV  = *vertical[y % 2];
+      const int     position = int( filterV.data_.size() + 1 ) >> 1;
+      for ( size_t k = 0; k < filterV.data_.size(); k++ ) {
+        taps[k] = getRow( clamp( y / 2 + y % 2 + int( k ) - position, 0, heightChroma - 1 ) );
+      }
+      upsample( filterV, taps.data(), widthChroma, sum.data(), column.data(), 1 );
+      // the even samples are interpolated by horizontal0 from the sample x / 2, the odd ones by horizontal1 from the
+      // sample x / 2 + 1
+      extendRow( column.data(), widthChroma, pad, extended.data() );
+      for ( int parity = 0; parity < 2; parity++ ) {
+        const Filter& filterH   = *horizontal[parity];
+        const int     positionH = int( filterH.data_.size() + 1 ) >> 1;
+        for ( size_t k = 0; k < filterH.data_.size(); k++ ) {
+          taps[k] = extended.data() + pad + parity + int( k ) - positionH;
+        }
+        upsample( filterH, taps.data(), widthChroma, sum.data(), row.data() + parity, 2 );
+      }
+      quantizeRow( row.data(), width, 65535., 32768., dst.data() + size_t( y ) * width );
+    }
   }
 }
 
@@ -540,60 +643,5 @@ void PCCInternalColorConverter<T>::floatRGBToRGB( const std::vector<float>& src,
   }
 }
 
-template <typename T>
-void PCCInternalColorConverter<T>::downsampling( const std::vector<float>& chroma_in,
-                                                 std::vector<float>&       chroma_out,
-                                                 const int                 widthIn,
-                                                 const int                 heightIn,
-                                                 const int                 maxValue,
-                                                 const size_t              filter ) const {
-  int                widthOut  = widthIn / 2;
-  int                heightOut = heightIn / 2;
-  std::vector<float> temp;
-  chroma_out.resize( widthOut * heightOut );
-  temp.resize( widthOut * heightIn );
-  for ( int i = 0; i < heightIn; i++ ) {
-    for ( int j = 0; j < widthOut; j++ ) {
-      temp[i * widthOut + j] =
-          downsamplingHorizontal( g_filter444to420[filter], chroma_in, widthIn, heightIn, i, j * 2 );
-    }
-  }
-  for ( int i = 0; i < heightOut; i++ ) {
-    for ( int j = 0; j < widthOut; j++ ) {
-      chroma_out[i * widthOut + j] =
-          downsamplingVertical( g_filter444to420[filter], temp, widthOut, heightIn, 2 * i, j );
-    }
-  }
-}
-
-template <typename T>
-void PCCInternalColorConverter<T>::upsampling( const std::vector<float>& chromaIn,
-                                               std::vector<float>&       chromaOut,
-                                               const int                 widthIn,
-                                               const int                 heightIn,
-                                               const int                 maxValue,
-                                               const size_t              filter ) const {
-  int                widthOut = widthIn * 2, heightOut = heightIn * 2;
-  std::vector<float> temp;
-  chromaOut.resize( widthOut * heightOut );
-  temp.resize( widthIn * heightOut );
-  for ( int i = 0; i < heightIn; i++ ) {
-    for ( int j = 0; j < widthIn; j++ ) {
-      temp[( 2 * i ) * widthIn + j] =
-          upsamplingVertical0( g_filter420to444[filter], chromaIn, widthIn, heightIn, i + 0, j );
-      temp[( 2 * i + 1 ) * widthIn + j] =
-          upsamplingVertical1( g_filter420to444[filter], chromaIn, widthIn, heightIn, i + 1, j );
-    }
-  }
-  for ( int i = 0; i < heightOut; i++ ) {
-    for ( int j = 0; j < widthIn; j++ ) {
-      chromaOut[i * widthOut + j * 2] =
-          upsamplingHorizontal0( g_filter420to444[filter], temp, widthIn, heightOut, i, j + 0 );
-      chromaOut[i * widthOut + j * 2 + 1] =
-          upsamplingHorizontal1( g_filter420to444[filter], temp, widthIn, heightOut, i, j + 1 );
-    }
-  }
-}
-
 template class pcc::PCCInternalColorConverter<uint8_t>;
 template class pcc::PCCInternalColorConverter<uint16_t>;
\ No newline at end of file
@@ -99,6 +99,58 @@ struct GeneratePointCloudParameters {
   int16_t     pbfLog2Threshold_;
 };
 
+// Indices of the occupied cells of a smoothing grid, stored in an open-addressing hash table keyed by the linear
+// cell index: only the cells touched by the boundary points are stored instead of the whole grid.
+class PCCGridCellIndex {
+ public:
+  PCCGridCellIndex() : count_( 0 ), log2Capacity_( 0 ) { resize( 10 ); }
+  ~PCCGridCellIndex() = default;
+
+  // Returns the index of the cell, -1 if the cell is not occupied.
+  int operator[]( const size_t cellId ) const {
+    for ( size_t slot = hash( cellId );; slot = ( slot + 1 ) & ( cells_.size() - 1 ) ) {
+      if ( cells_[slot].id == cellId ) { return cells_[slot].index; }
+      if ( cells_[slot].id == emptyCell ) { return -1; }
+    }
+  }
+
+  // Adds the cell with the next index if it is not occupied yet.
+  void insert( const size_t cellId ) {
+    if ( 2 * ( count_ + 1 ) > cells_.size() ) { resize( log2Capacity_ + 1 ); }
+    size_t slot = hash( cellId );
+    for ( ; cells_[slot].id != emptyCell; slot = ( slot + 1 ) & ( cells_.size() - 1 ) ) {
+      if ( cells_[slot].id == cellId ) { return; }
+    }
+    cells_[slot].id    = static_cast<uint32_t>( cellId );
+    cells_[slot].index = static_cast<int>( count_++ );
+  }
+  size_t size() const { return count_; }
+
+ private:
+  struct Cell {
+    uint32_t id;
+    int      index;
+  };
+  static const uint32_t emptyCell = ( std::numeric_limits<uint32_t>::max )();
+  size_t                hash( const size_t cellId ) const {
+    return static_cast<size_t>( ( uint64_t( cellId ) * 0x9E3779B97F4A7C15ULL ) >> ( 64 - log2Capacity_ ) );
+  }
+  void resize( const size_t log2Capacity ) {
+    std::vector<Cell> cells( size_t( 1 ) << log2Capacity, Cell{emptyCell, -1} );
+    log2Capacity_ = log2Capacity;
+    for ( const auto& cell : cells_ ) {
+      if ( cell.id == emptyCell ) { continue; }
+      size_t slot = hash( cell.id );
+      while ( cells[slot].id != emptyCell ) { slot = ( slot + 1 ) & ( cells.size() - 1 ); }
+      cells[slot] = cell;
+    }
+    cells_.swap( cells );
+  }
+  std::vector<Cell> cells_;
+  size_t            count_;
+  size_t            log2Capacity_;
+};
+
 #ifdef CODEC_TRACE
 #define TRACE_CODEC( fmt, ... ) trace( fmt, ##__VA_ARGS__ );
 #else
@@ -264,16 +316,15 @@ class PCCCodec {
     return s;
   }
 
-  inline double median( std::vector<uint16_t>& Data, int N ) {
-    std::sort( Data.begin(), Data.end() );
-
+  // Data must be sorted.
+  inline double median( const std::vector<uint16_t>& Data, int N ) {
     if ( N % 2 == 0 )
       return ( double( Data[N / 2] ) + double( Data[N / 2 - 1] ) ) / 2.0;
     else
       return double( Data[N / 2] );
   }
 
-  inline double mean( std::vector<uint16_t>& Data, int N ) {
+  inline double mean( const std::vector<uint16_t>& Data, int N ) {
     double s = 0.0;
     for ( size_t i = 0; i < N; ++i ) { s += double( Data[i] ); }
     return s / double( N );
@@ -310,7 +361,10 @@ class PCCCodec {
                              const std::vector<uint32_t>&        partition,
                              const GeneratePointCloudParameters& params,
                              uint16_t                            gridWidth,
-                             std::vector<int>&                   cellIndex );
+                             std::vector<uint16_t>&              gridCount,
+                             std::vector<PCCVector3<float>>&     center,
+                             std::vector<bool>&                  doSmooth,
+                             const PCCGridCellIndex&             cellIndex );
 
   void addGridCentroid( PCCPoint3D&                     point,
                         uint32_t                        patchIdx,
@@ -340,14 +394,19 @@ class PCCCodec {
                            std::vector<uint16_t>&              colorGridCount,
                            std::vector<PCCVector3<float>>&     colorCenterGrid,
                            std::vector<bool>&                  colorDoSmooth,
+                           std::vector<std::vector<uint16_t>>& colorLum,
                            uint8_t                             gridSize,
                            PCCVector3D&                        curPosColor,
                            const GeneratePointCloudParameters& params,
-                           std::vector<int>&                   cellIndex );
+                           const PCCGridCellIndex&             cellIndex );
 
   void smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                 const GeneratePointCloudParameters& params,
-                                std::vector<int>&                   cellIndex );
+                                std::vector<uint16_t>&              colorGridCount,
+                                std::vector<PCCVector3<float>>&     colorCenter,
+                                std::vector<bool>&                  colorDoSmooth,
+                                std::vector<std::vector<uint16_t>>& colorLum,
+                                const PCCGridCellIndex&             cellIndex );
 
   bool gridFiltering( const std::vector<uint32_t>&    partition,
                       PCCPointSet3&                   pointCloud,
@@ -359,7 +418,7 @@ class PCCCodec {
                       std::vector<bool>&              doSmooth,
                       uint8_t                         gridSize,
                       uint16_t                        gridWidth,
-                      std::vector<int>&               cellIndex );
+                      const PCCGridCellIndex&         cellIndex );
 
   bool gridFilteringTransfer( const std::vector<uint32_t>& partition,
                               PCCPointSet3&                pointCloud,
@@ -374,27 +433,18 @@ class PCCCodec {
                               std::vector<PCCVector3D>&    colorGrid,
                               PCCVector3D&                 color );
 
-  void identifyBoundaryPoints( const std::vector<uint32_t>& occupancyMap,
-                               const size_t                 x,
-                               const size_t                 y,
-                               const size_t                 imageWidth,
-                               const size_t                 imageHeight,
-                               const size_t                 pointIndex,
-                               std::vector<uint32_t>&       BPflag,
-                               PCCPointSet3&                reconstruct );
+  void identifyBoundaryPoints( const std::vector<uint8_t>& occupancyMap,
+                               const size_t                x,
+                               const size_t                y,
+                               const size_t                imageWidth,
+                               const size_t                imageHeight,
+                               const size_t                pointIndex,
+                               std::vector<uint32_t>&      BPflag,
+                               PCCPointSet3&               reconstruct );
 
 #ifdef CODEC_TRACE
   void printChecksum( PCCPointSet3& ePointcloud, std::string eString );
 #endif
-  std::vector<uint16_t>              geoSmoothingCount_;
-  std::vector<PCCVector3<float>>     geoSmoothingCenter_;
-  std::vector<bool>                  geoSmoothingDoSmooth_;
-  std::vector<uint32_t>              geoSmoothingPartition_;
-  std::vector<uint16_t>              colorSmoothingCount_;
-  std::vector<PCCVector3<float>>     colorSmoothingCenter_;
-  std::vector<bool>                  colorSmoothingDoSmooth_;
-  std::vector<uint32_t>              colorSmoothingPartition_;
-  std::vector<std::vector<uint16_t>> colorSmoothingLum_;
 #ifdef CODEC_TRACE
   bool  trace_;
   FILE* traceFile_;
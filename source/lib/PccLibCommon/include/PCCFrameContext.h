@@ -56,18 +56,18 @@ class PCCFrameContext {
  public:
   PCCFrameContext();
   ~PCCFrameContext();
-  std::vector<PCCVector3<size_t>>& getPointToPixel() { return pointToPixel_; }
-  std::vector<size_t>&             getBlockToPatch() { return blockToPatch_; }
-  std::vector<uint32_t>&           getOccupancyMap() { return occupancyMap_; }
-  std::vector<uint32_t>&           getFullOccupancyMap() { return fullOccupancyMap_; }
-  std::vector<PCCPatch>&           getPatches() { return patches_; }
-  PCCPatch&                        getPatch( size_t index ) { return patches_[index]; }
-  const PCCPatch&                  getPatch( size_t index ) const { return patches_[index]; }
-  std::vector<PCCRawPointsPatch>&  getRawPointsPatches() { return rawPointsPatches_; }
-  PCCRawPointsPatch&               getRawPointsPatch( size_t index ) { return rawPointsPatches_[index]; }
-  std::vector<size_t>&             getNumberOfRawPoints() { return numberOfRawPoints_; };
-  std::vector<PCCColor3B>&         getRawPointsTextures() { return rawTextures_; };
-  std::vector<PCCColor3B>&         getEOMTextures() { return eomTextures_; };
+  std::vector<PCCVector3<uint16_t>>& getPointToPixel() { return pointToPixel_; }
+  std::vector<uint32_t>&             getBlockToPatch() { return blockToPatch_; }
+  std::vector<uint8_t>&              getOccupancyMap() { return occupancyMap_; }
+  std::vector<uint8_t>&              getFullOccupancyMap() { return fullOccupancyMap_; }
+  std::vector<PCCPatch>&             getPatches() { return patches_; }
+  PCCPatch&                          getPatch( size_t index ) { return patches_[index]; }
+  const PCCPatch&                    getPatch( size_t index ) const { return patches_[index]; }
+  std::vector<PCCRawPointsPatch>&    getRawPointsPatches() { return rawPointsPatches_; }
+  PCCRawPointsPatch&                 getRawPointsPatch( size_t index ) { return rawPointsPatches_[index]; }
+  std::vector<size_t>&               getNumberOfRawPoints() { return numberOfRawPoints_; };
+  std::vector<PCCColor3B>&           getRawPointsTextures() { return rawTextures_; };
+  std::vector<PCCColor3B>&           getEOMTextures() { return eomTextures_; };
   size_t&                          getWidth() { return width_; }
   size_t&                          getHeight() { return height_; }
   const size_t                     getIndex() { return index_; }
@@ -178,10 +178,10 @@ class PCCFrameContext {
   std::vector<std::vector<size_t>>             refAFOCList_;
   size_t                                       log2PatchQuantizerSizeX_;
   size_t                                       log2PatchQuantizerSizeY_;
-  std::vector<PCCVector3<size_t>>              pointToPixel_;
-  std::vector<size_t>                          blockToPatch_;
-  std::vector<uint32_t>                        occupancyMap_;
-  std::vector<uint32_t>                        fullOccupancyMap_;
+  std::vector<PCCVector3<uint16_t>>            pointToPixel_;
+  std::vector<uint32_t>                        blockToPatch_;
+  std::vector<uint8_t>                         occupancyMap_;
+  std::vector<uint8_t>                         fullOccupancyMap_;
   std::vector<PCCPatch>                        patches_;
   std::vector<PCCRawPointsPatch>               rawPointsPatches_;
   std::vector<size_t>                          numberOfRawPoints_;
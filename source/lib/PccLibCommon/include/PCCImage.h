@@ -38,16 +38,38 @@
 
 namespace pcc {
 
+// The channels are reference counted and shared between the copies of an image, so that a copy is cheap. The
+// non-const accessors duplicate the channel they return if it is shared (copy-on-write), so that writing an image
+// never changes its copies. The loops over the pixels take the channel once rather than calling the pixel accessors,
+// and an image written by concurrent tasks is detached before them. clone() makes an independent copy.
 template <typename T, size_t N>
 class PCCImage {
  public:
-  PCCImage() : width_( 0 ), height_( 0 ), format_( PCCCOLORFORMAT::UNKNOWN ), deprecatedColorFormat_( 0 ) {}
+  PCCImage() : width_( 0 ), height_( 0 ), format_( PCCCOLORFORMAT::UNKNOWN ), deprecatedColorFormat_( 0 ) {
+    for ( auto& buffer : channels_ ) { buffer = emptyChannel(); }
+  }
   PCCImage( const PCCImage& ) = default;
+  PCCImage( PCCImage&& image ) noexcept : PCCImage() { swap( image ); }
   PCCImage& operator=( const PCCImage& rhs ) = default;
-  ~PCCImage()                                = default;
-  std::vector<T>& operator[]( int index ) { return channels_[index]; }
+  PCCImage& operator=( PCCImage&& rhs ) noexcept {
+    swap( rhs );
+    return *this;
+  }
+  ~PCCImage() = default;
+  std::vector<T>&       operator[]( int index ) { return channel( index ); }
+  const std::vector<T>& operator[]( int index ) const { return *channels_[index]; }
 
-  void swap( PCCImage<T, N>& image ) {
+  // duplicates the channels shared with other images, so that the image can then be written by concurrent tasks
+  void detach() {
+    for ( size_t c = 0; c < N; c++ ) { channel( c ); }
+  }
+
+  PCCImage<T, N> clone() const {
+    PCCImage<T, N> image( *this );
+    for ( size_t c = 0; c < N; c++ ) { image.channels_[c] = std::make_shared<std::vector<T>>( *channels_[c] ); }
+    return image;
+  }
+  void swap( PCCImage<T, N>& image ) noexcept {
     std::swap( width_, image.width_ );
     std::swap( height_, image.height_ );
     std::swap( format_, image.format_ );
@@ -59,9 +81,9 @@ class PCCImage {
     resize( image.getWidth(), image.getHeight(), image.getColorFormat() );
     deprecatedColorFormat_ = image.getDeprecatedColorFormat();
     for ( size_t c = 0; c < 3; ++c ) {
-      size_t size = channels_[c].size();
       auto&  src  = image.getChannel( c );
-      auto&  dst  = channels_[c];
+      auto&  dst  = channel( c );
+      size_t size = dst.size();
       for ( size_t i = 0; i < size; ++i ) { dst[i] = static_cast<T>( src[i] ); }
     }
     return *this;
@@ -74,16 +96,17 @@ class PCCImage {
       exit( -1 );
     }
     resize( image.getWidth(), image.getHeight(), PCCCOLORFORMAT::YUV420 );
-    std::copy( image.channels_[0].begin(), image.channels_[0].end(), channels_[0].begin() );
+    std::copy( image.getChannel( 0 ).begin(), image.getChannel( 0 ).end(), channel( 0 ).begin() );
     for ( size_t c = 1; c < N; ++c ) {
-      const auto& channel = image.channels_[c];
+      const auto& src = image.getChannel( c );
+      auto&       dst = channel( c );
       for ( size_t y = 0; y < height_; y += 2 ) {
-        const T* const buffer1 = channel.data() + y * width_;
+        const T* const buffer1 = src.data() + y * width_;
         const T* const buffer2 = buffer1 + width_;
         for ( size_t x = 0; x < width_; x += 2 ) {
           const size_t   x2  = x / 2;
           const uint64_t sum = buffer1[x] + buffer1[x + 1] + buffer2[x] + buffer2[x + 1];
-          channels_[c][x2]   = T( ( sum + 2 ) / 4 );
+          dst[x2]            = T( ( sum + 2 ) / 4 );
         }
       }
     }
@@ -96,11 +119,11 @@ class PCCImage {
       exit( -1 );
     }
     resize( image.getWidth(), image.getHeight(), PCCCOLORFORMAT::YUV444 );
-    std::copy( image.channels_[0].begin(), image.channels_[0].end(), channels_[0].begin() );
+    std::copy( image.getChannel( 0 ).begin(), image.getChannel( 0 ).end(), channel( 0 ).begin() );
     const size_t width2 = width_ / 2;
     for ( size_t c = 1; c < N; ++c ) {
-      auto&    dst = channels_[c];
-      const T* src = image.channels_[c].data();
+      auto&    dst = channel( c );
+      const T* src = image.getChannel( c ).data();
       for ( size_t y = 0; y < height_; y += 2 ) {
         T* const buffer = dst.data() + y * width_;
         for ( size_t x2 = 0; x2 < width2; ++x2, src++ ) {
@@ -124,7 +147,7 @@ class PCCImage {
     this->swap( image );
   }
   void clear() {
-    for ( auto& channel : channels_ ) { channel.clear(); }
+    for ( auto& buffer : channels_ ) { buffer = emptyChannel(); }
   }
   size_t                getWidth() const { return width_; }
   size_t                getHeight() const { return height_; }
@@ -132,11 +155,15 @@ class PCCImage {
   size_t                getChannelCount() const { return N; }
   size_t                getDeprecatedColorFormat() const { return deprecatedColorFormat_; }
   void                  setDeprecatedColorFormat( size_t value ) { deprecatedColorFormat_ = value; }
-  const std::vector<T>& getChannel( size_t index ) const { return channels_[index]; }
-  std::vector<T>&       getChannel( size_t index ) { return channels_[index]; }
+  const std::vector<T>& getChannel( size_t index ) const { return *channels_[index]; }
+  std::vector<T>&       getChannel( size_t index ) { return channel( index ); }
   void                  set( const T value = 0 ) {
-    for ( auto& channel : channels_ ) {
-      for ( auto& p : channel ) { p = value; }
+    for ( auto& buffer : channels_ ) {
+      if ( buffer.use_count() > 1 ) {
+        buffer = std::make_shared<std::vector<T>>( buffer->size(), value );
+      } else {
+        std::fill( buffer->begin(), buffer->end(), value );
+      }
     }
   }
   void resize( const size_t sizeU0, const size_t sizeV0, PCCCOLORFORMAT format ) {
@@ -150,11 +177,11 @@ class PCCImage {
     printf( "Image resize: %zu x %zu format = %d \n", width_, height_, format_ );
     const size_t size = width_ * height_;
     if ( format_ == PCCCOLORFORMAT::YUV420 ) {
-      channels_[0].resize( size );
-      channels_[1].resize( size >> 2 );
-      channels_[2].resize( size >> 2 );
+      channel( 0 ).resize( size );
+      channel( 1 ).resize( size >> 2 );
+      channel( 2 ).resize( size >> 2 );
     } else {
-      for ( auto& channel : channels_ ) { channel.resize( size ); }
+      for ( size_t c = 0; c < N; c++ ) { channel( c ).resize( size ); }
     }
   }
 
@@ -181,7 +208,7 @@ class PCCImage {
             rounding, widthY, heightY, strideY, widthC, heightC, width_, height_, rgb2bgr );
     for ( size_t c = 0; c < 3; c++ ) {
       auto* src = ptr[rgb2bgr][c];
-      auto* dst = channels_[c].data();
+      auto* dst = channel( c ).data();
       if ( shiftbits > 0 ) {
         T minval = 0;
         T maxval = ( T )( ( 1 << ( 10 - (int)shiftbits ) ) - 1 );
@@ -209,7 +236,7 @@ class PCCImage {
             size_t  heightC,
             size_t  strideC,
             int16_t shiftbits,
-            bool    rgb2bgr ) {
+            bool    rgb2bgr ) const {
     size_t chromaSubsample = widthY / widthC;
     if ( ( chromaSubsample == 1 && format_ == PCCCOLORFORMAT::YUV420 ) ||
          ( chromaSubsample == 2 && format_ != PCCCOLORFORMAT::YUV420 ) ) {
@@ -227,7 +254,7 @@ class PCCImage {
     printf( "copy image from PCC to HM: S = %d (%4zux%4zu => %4zux%4zu S=%4zu C: %4zux%4zu ) \n", shiftbits, width_,
             height_, widthY, heightY, strideY, widthC, heightC );
     for ( size_t c = 0; c < 3; c++ ) {
-      auto* src = channels_[c].data();
+      auto* src = channels_[c]->data();
       auto* dst = ptr[rgb2bgr][c];
       if ( shiftbits > 0 ) {
         for ( size_t v = 0; v < heightSrc[c]; ++v, src += width[c], dst += stride[c] ) {
@@ -244,14 +271,14 @@ class PCCImage {
     }
   }
 
-  bool write( std::ofstream& outfile, const size_t nbyte ) {
+  bool write( std::ofstream& outfile, const size_t nbyte ) const {
     printf( "Image write %zux%zu T = %zu nbyte = %zu color format = %d channel size = %zu %zu %zu \n", width_, height_,
-            sizeof( T ), nbyte, format_, channels_[0].size(), channels_[1].size(), channels_[2].size() );
+            sizeof( T ), nbyte, format_, channels_[0]->size(), channels_[1]->size(), channels_[2]->size() );
     fflush( stdout );
     if ( nbyte == sizeof( T ) ) {
       if ( !outfile.good() ) { return false; }
-      for ( const auto& channel : channels_ ) {
-        outfile.write( (const char*)( channel.data() ), channel.size() * sizeof( T ) );
+      for ( size_t c = 0; c < N; c++ ) {
+        outfile.write( (const char*)( channels_[c]->data() ), channels_[c]->size() * sizeof( T ) );
       }
     } else {
       assert( nbyte < sizeof( T ) );
@@ -262,7 +289,7 @@ class PCCImage {
     return true;
   }
 
-  bool write( const std::string fileName, const size_t nbyte ) {
+  bool write( const std::string fileName, const size_t nbyte ) const {
     std::ofstream outfile( fileName, std::ios::binary );
     if ( write( outfile, nbyte ) ) {
       outfile.close();
@@ -284,7 +311,10 @@ class PCCImage {
     }
     if ( nbyte == sizeof( T ) ) {
       resize( sizeU0, sizeV0, format );
-      for ( auto& channel : channels_ ) { infile.read( (char*)( channel.data() ), channel.size() * sizeof( T ) ); }
+      for ( size_t c = 0; c < N; c++ ) {
+        auto& dst = channel( c );
+        infile.read( (char*)( dst.data() ), dst.size() * sizeof( T ) );
+      }
     } else {
       assert( nbyte < sizeof( T ) );
       PCCImage<uint8_t, 3> image;
@@ -309,23 +339,25 @@ class PCCImage {
 
   void setValue( const size_t channelIndex, const size_t u, const size_t v, const T value ) {
     assert( channelIndex < N && u < width_ && v < height_ );
-    channels_[channelIndex][v * width_ + u] = value;
+    channel( channelIndex )[v * width_ + u] = value;
   }
   T getValue( const size_t channelIndex, const size_t u, const size_t v ) const {
     assert( channelIndex < N && u < width_ && v < height_ );
-    return channels_[channelIndex][v * width_ + u];
+    return ( *channels_[channelIndex] )[v * width_ + u];
   }
   T& getValue( const size_t channelIndex, const size_t u, const size_t v ) {
     assert( channelIndex < N && u < width_ && v < height_ );
-    return channels_[channelIndex][v * width_ + u];
+    return channel( channelIndex )[v * width_ + u];
   }
 
-  bool copyBlock( size_t top, size_t left, size_t width, size_t height, PCCImage& block ) {
+  bool copyBlock( size_t top, size_t left, size_t width, size_t height, PCCImage& block ) const {
     assert( top >= 0 && left >= 0 && ( width + left ) < width_ && ( height + top ) < height_ );
     for ( size_t cc = 0; cc < N; cc++ ) {
+      const auto& src = *channels_[cc];
+      auto&       dst = block.channel( cc );
       for ( size_t i = top; i < top + height; i++ ) {
         for ( size_t j = left; j < left + width; j++ ) {
-          block.setValue( cc, ( j - left ), ( i - top ), getValue( cc, j, i ) );
+          dst[( i - top ) * block.width_ + j - left] = src[i * width_ + j];
         }
       }
     }
@@ -334,9 +366,11 @@ class PCCImage {
   bool setBlock( size_t top, size_t left, PCCImage& block ) {
     assert( top >= 0 && left >= 0 && ( block.getWidth() + left ) < width_ && ( block.getHeight() + top ) < height_ );
     for ( size_t cc = 0; cc < N; cc++ ) {
+      const auto& src = *block.channels_[cc];
+      auto&       dst = channel( cc );
       for ( size_t i = top; i < top + block.getHeight(); i++ ) {
         for ( size_t j = left; j < left + block.getWidth(); j++ ) {
-          setValue( cc, j, i, block.getValue( cc, ( j - left ), ( i - top ) ) );
+          dst[i * width_ + j] = src[( i - top ) * block.width_ + j - left];
         }
       }
     }
@@ -362,25 +396,22 @@ class PCCImage {
     if ( bitDiff >= 0 ) {
       if ( msbAlignFlag ) {
         for ( size_t cc = 0; cc < N; cc++ ) {
-          for ( size_t h = 0; h < height_; h++ ) {
-            for ( size_t w = 0; w < width_; w++ ) { setValue( cc, w, h, ( getValue( cc, w, h ) >> bitDiff ) ); }
-          }
+          auto& values = channel( cc );
+          for ( size_t i = 0; i < values.size(); i++ ) { values[i] = values[i] >> bitDiff; }
         }
       } else {
         for ( size_t cc = 0; cc < N; cc++ ) {
-          for ( size_t h = 0; h < height_; h++ ) {
-            for ( size_t w = 0; w < width_; w++ ) {
-              setValue( cc, w, h, tMin( getValue( cc, w, h ), ( T )( ( 1 << bitdepthOutput ) - 1 ) ) );
-            }
+          auto& values = channel( cc );
+          for ( size_t i = 0; i < values.size(); i++ ) {
+            values[i] = tMin( values[i], ( T )( ( 1 << bitdepthOutput ) - 1 ) );
           }
         }
       }
     } else {
       if ( msbAlignFlag ) {
         for ( size_t cc = 0; cc < N; cc++ ) {
-          for ( size_t h = 0; h < height_; h++ ) {
-            for ( size_t w = 0; w < width_; w++ ) { setValue( cc, w, h, ( getValue( cc, w, h ) << ( -bitDiff ) ) ); }
-          }
+          auto& values = channel( cc );
+          for ( size_t i = 0; i < values.size(); i++ ) { values[i] = values[i] << ( -bitDiff ); }
         }
       } else {
         // do nothing, the vaue is correct
@@ -389,6 +420,18 @@ class PCCImage {
   }
 
  private:
+  // the channel index, duplicated first if it is shared with other images
+  std::vector<T>& channel( const size_t index ) {
+    auto& buffer = channels_[index];
+    if ( buffer.use_count() > 1 ) { buffer = std::make_shared<std::vector<T>>( *buffer ); }
+    return *buffer;
+  }
+  // empty channel shared by the default constructed and the moved from images, so that they don't allocate
+  static const std::shared_ptr<std::vector<T>>& emptyChannel() {
+    static const std::shared_ptr<std::vector<T>> empty = std::make_shared<std::vector<T>>();
+    return empty;
+  }
+
   T      clamp( T v, T a, T b ) const { return ( ( v < a ) ? a : ( ( v > b ) ? b : v ) ); }
   int    clamp( int v, int a, int b ) const { return ( ( v < a ) ? a : ( ( v > b ) ? b : v ) ); }
   float  clamp( float v, float a, float b ) const { return ( ( v < a ) ? a : ( ( v > b ) ? b : v ) ); }
@@ -396,8 +439,8 @@ class PCCImage {
 
   size_t         width_;
   size_t         height_;
-  std::vector<T> channels_[N];
-  PCCCOLORFORMAT format_;
+  std::shared_ptr<std::vector<T>> channels_[N];
+  PCCCOLORFORMAT                  format_;
   size_t         deprecatedColorFormat_;  // 0.RGB 1.YUV420 2.YUV444 16bits  // TODO JR: must be removed
 };
 }  // namespace pcc
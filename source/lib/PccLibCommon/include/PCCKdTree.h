@@ -71,6 +71,38 @@ class PCCNNResult {
   std::vector<double> dist_;
 };
 
+// Results of a batch of queries, stored in flat arrays with a fixed stride: the neighbors of the query q are the
+// count( q ) first entries of indices( q ) and dist( q ). The arrays keep their capacity when the object is reused.
+class PCCNNResults {
+ public:
+  PCCNNResults() : stride_( 0 ) {}
+  ~PCCNNResults() {
+    counts_.clear();
+    indices_.clear();
+    dist_.clear();
+  }
+  inline void resize( const size_t queryCount, const size_t stride ) {
+    stride_ = stride;
+    counts_.resize( queryCount );
+    indices_.resize( queryCount * stride );
+    dist_.resize( queryCount * stride );
+  }
+  inline size_t        size() const { return counts_.size(); }
+  inline size_t        stride() const { return stride_; }
+  inline size_t&       count( size_t query ) { return counts_[query]; }
+  inline size_t        count( size_t query ) const { return counts_[query]; }
+  inline size_t*       indices( size_t query ) { return indices_.data() + query * stride_; }
+  inline const size_t* indices( size_t query ) const { return indices_.data() + query * stride_; }
+  inline double*       dist( size_t query ) { return dist_.data() + query * stride_; }
+  inline const double* dist( size_t query ) const { return dist_.data() + query * stride_; }
+
+ private:
+  size_t              stride_;
+  std::vector<size_t> counts_;
+  std::vector<size_t> indices_;
+  std::vector<double> dist_;
+};
+
 class PCCKdTree {
  public:
   PCCKdTree();
@@ -83,6 +115,21 @@ class PCCKdTree {
                      const double      radius,
                      PCCNNResult&      results ) const;
 
+  // Batched versions of the searches above: the queries of the pointCount points are processed in parallel and their
+  // results are stored in the order of the points. With mortonOrder, the queries are scheduled in the Morton order of
+  // the points, so that consecutive queries visit the same nodes of the tree.
+  void search( const PCCPoint3D* points,
+               const size_t      pointCount,
+               const size_t      num_results,
+               PCCNNResults&     results,
+               const bool        mortonOrder = false ) const;
+  void searchRadius( const PCCPoint3D* points,
+                     const size_t      pointCount,
+                     const size_t      num_results,
+                     const double      radius,
+                     PCCNNResults&     results,
+                     const bool        mortonOrder = false ) const;
+
  private:
   void  clear();
   void* kdtree_;
@@ -0,0 +1,60 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCLosslessVideoCodec_h
+#define PCCLosslessVideoCodec_h
+
+#include "PCCCommon.h"
+#include "PCCVideo.h"
+
+namespace pcc {
+
+// Built-in lossless 2D video codec. Each plane of each frame is split in square tiles coded independently with a
+// median edge detector prediction and context adaptive binary range coding of the residuals, so the frames and the
+// tiles are coded in parallel and fully in memory.
+template <typename T>
+class PCCLosslessVideoCodec {
+ public:
+  PCCLosslessVideoCodec( size_t nbThread ) : nbThread_( nbThread ) {}
+  ~PCCLosslessVideoCodec() {}
+
+  void encode( const PCCVideo<T, 3>& video, std::vector<uint8_t>& bitstream );
+  bool decode( const uint8_t* bitstream, size_t size, PCCVideo<T, 3>& video );
+
+ private:
+  static const size_t tileSize_ = 128;
+  size_t              nbThread_;
+};
+
+};  // namespace pcc
+
+#endif /* PCCLosslessVideoCodec_h */
@@ -560,6 +560,121 @@ static inline void PCCDiagonalize( const PCCMatrix3<double>& A, PCCMatrix3<doubl
   }
 }
 
+// Closed-form eigen decomposition of a symmetric 3x3 matrix in single precision (D. Eberly, "A Robust Eigensolver for
+// 3x3 Symmetric Matrices"): the eigenvalues are the trigonometric roots of the characteristic polynomial, and the
+// eigenvectors are computed from the most isolated eigenvalue first.
+// returns the eigenvalues in increasing order and the unit eigenvector of the smallest one.
+static inline void PCCDiagonalizeClosedForm( const PCCMatrix3<float>& A,
+                                             PCCVector3<float>&       eigenvalues,
+                                             PCCVector3<float>&       eigenvector ) {
+  auto dot = []( const PCCVector3<float>& a, const PCCVector3<float>& b ) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  };
+  // eigenvector of the simple eigenvalue value: the largest cross product of two rows of A - value * I
+  auto simpleEigenvector = [&]( const PCCVector3<float> ( &a )[3], const float value ) {
+    const PCCVector3<float> row0( a[0][0] - value, a[0][1], a[0][2] );
+    const PCCVector3<float> row1( a[1][0], a[1][1] - value, a[1][2] );
+    const PCCVector3<float> row2( a[2][0], a[2][1], a[2][2] - value );
+    const PCCVector3<float> cross[3] = {row0 ^ row1, row0 ^ row2, row1 ^ row2};
+    size_t                  best     = 0;
+    float                   bestNorm = dot( cross[0], cross[0] );
+    for ( size_t i = 1; i < 3; ++i ) {
+      const float norm2 = dot( cross[i], cross[i] );
+      if ( norm2 > bestNorm ) {
+        best     = i;
+        bestNorm = norm2;
+      }
+    }
+    return bestNorm > 0.F ? cross[best] / std::sqrt( bestNorm ) : PCCVector3<float>( 0.F, 0.F, 1.F );
+  };
+  float maxAbs = 0.F;
+  for ( size_t i = 0; i < 3; ++i ) {
+    for ( size_t j = i; j < 3; ++j ) { maxAbs = ( std::max )( maxAbs, std::fabs( A[i][j] ) ); }
+  }
+  eigenvector = PCCVector3<float>( 0.F, 0.F, 1.F );
+  if ( maxAbs == 0.F ) {
+    eigenvalues = 0.F;
+    return;
+  }
+  // the matrix is scaled by its largest entry to keep the products in range
+  const PCCVector3<float> a[3] = {PCCVector3<float>( A[0][0], A[0][1], A[0][2] ) / maxAbs,
+                                  PCCVector3<float>( A[0][1], A[1][1], A[1][2] ) / maxAbs,
+                                  PCCVector3<float>( A[0][2], A[1][2], A[2][2] ) / maxAbs};
+  const float             q    = ( a[0][0] + a[1][1] + a[2][2] ) / 3.F;
+  const float             b00  = a[0][0] - q;
+  const float             b11  = a[1][1] - q;
+  const float             b22  = a[2][2] - q;
+  const float             off2 = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+  const float             p2   = ( b00 * b00 + b11 * b11 + b22 * b22 + 2.F * off2 ) / 6.F;
+  if ( p2 == 0.F ) {
+    eigenvalues = q * maxAbs;
+    return;
+  }
+  const float p       = std::sqrt( p2 );
+  const float halfDet = ( b00 * ( b11 * b22 - a[1][2] * a[1][2] ) - a[0][1] * ( a[0][1] * b22 - a[1][2] * a[0][2] ) +
+                          a[0][2] * ( a[0][1] * a[1][2] - b11 * a[0][2] ) ) /
+                        ( 2.F * p2 * p );
+  const float angle   = std::acos( ( std::min )( ( std::max )( halfDet, -1.F ), 1.F ) ) / 3.F;
+  const float beta2   = 2.F * std::cos( angle );
+  const float beta0   = 2.F * std::cos( angle + 2.09439510F );
+  const float beta1   = -( beta0 + beta2 );
+  const float value0  = q + p * beta0;
+  const float value1  = q + p * beta1;
+  const float value2  = q + p * beta2;
+  eigenvalues         = PCCVector3<float>( value0, value1, value2 ) * maxAbs;
+  if ( halfDet < 0.F ) {
+    // the smallest eigenvalue is the isolated one
+    eigenvector = simpleEigenvector( a, value0 );
+    return;
+  }
+  // the largest eigenvalue is the isolated one: its eigenvector gives the plane of the two others, in which the
+  // eigenvector of the middle eigenvalue is solved, and the smallest eigenvector is orthogonal to both
+  const PCCVector3<float> vector2 = simpleEigenvector( a, value2 );
+  PCCVector3<float>       u;
+  if ( std::fabs( vector2[0] ) > std::fabs( vector2[1] ) ) {
+    u = PCCVector3<float>( -vector2[2], 0.F, vector2[0] ) /
+        std::sqrt( vector2[0] * vector2[0] + vector2[2] * vector2[2] );
+  } else {
+    u = PCCVector3<float>( 0.F, vector2[2], -vector2[1] ) /
+        std::sqrt( vector2[1] * vector2[1] + vector2[2] * vector2[2] );
+  }
+  const PCCVector3<float> v = vector2 ^ u;
+  const PCCVector3<float> au( dot( a[0], u ), dot( a[1], u ), dot( a[2], u ) );
+  const PCCVector3<float> av( dot( a[0], v ), dot( a[1], v ), dot( a[2], v ) );
+  float                   m00     = dot( u, au ) - value1;
+  float                   m01     = dot( u, av );
+  float                   m11     = dot( v, av ) - value1;
+  PCCVector3<float>       vector1 = u;
+  if ( std::fabs( m00 ) >= std::fabs( m11 ) ) {
+    if ( ( std::max )( std::fabs( m00 ), std::fabs( m01 ) ) > 0.F ) {
+      if ( std::fabs( m00 ) >= std::fabs( m01 ) ) {
+        m01 /= m00;
+        m00 = 1.F / std::sqrt( 1.F + m01 * m01 );
+        m01 *= m00;
+      } else {
+        m00 /= m01;
+        m01 = 1.F / std::sqrt( 1.F + m00 * m00 );
+        m00 *= m01;
+      }
+      vector1 = m01 * u - m00 * v;
+    }
+  } else {
+    if ( ( std::max )( std::fabs( m11 ), std::fabs( m01 ) ) > 0.F ) {
+      if ( std::fabs( m11 ) >= std::fabs( m01 ) ) {
+        m01 /= m11;
+        m11 = 1.F / std::sqrt( 1.F + m01 * m01 );
+        m01 *= m11;
+      } else {
+        m11 /= m01;
+        m01 = 1.F / std::sqrt( 1.F + m11 * m11 );
+        m11 *= m01;
+      }
+      vector1 = m11 * u - m01 * v;
+    }
+  }
+  eigenvector = vector1 ^ vector2;
+}
+
 template <typename T>
 T PCCClip( const T& n, const T& lower, const T& upper ) {
   return ( std::max )( lower, ( std::min )( n, upper ) );
@@ -0,0 +1,123 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCPackingCanvas_h
+#define PCCPackingCanvas_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Block footprint of a patch in canvas orientation, dilated by the packing
+// safeguard. Rows are stored as 64-bit words so that a footprint row can be
+// tested against the canvas with a few word-level AND operations.
+class PCCPackingFootprint {
+ public:
+  PCCPackingFootprint() : width_( 0 ), height_( 0 ), stride_( 0 ), offset_( 0 ), valid_( false ), empty_( true ) {}
+  ~PCCPackingFootprint() {
+    bits_.clear();
+    firstSet_.clear();
+  }
+  // width and height of the non dilated patch, expressed in canvas blocks.
+  void initialize( size_t width, size_t height, size_t offset );
+  // marks the block (x,y) of the non dilated patch and its safeguard area.
+  void set( size_t x, size_t y );
+  void invalidate() {
+    initialize( 0, 0, 0 );
+    valid_ = false;
+  }
+
+  inline size_t          getWidth() const { return width_; }
+  inline size_t          getHeight() const { return height_; }
+  inline size_t          getStride() const { return stride_; }
+  inline size_t          getOffset() const { return offset_; }
+  inline bool            isValid() const { return valid_; }
+  inline bool            isEmpty() const { return empty_; }
+  inline const uint64_t* getRow( size_t y ) const { return bits_.data() + y * stride_; }
+  // index of the first marked block of the row y or width if the row is empty.
+  inline size_t getFirstSet( size_t y ) const { return firstSet_[y]; }
+
+ private:
+  size_t                width_;
+  size_t                height_;
+  size_t                stride_;
+  size_t                offset_;
+  bool                  valid_;
+  bool                  empty_;
+  std::vector<uint64_t> bits_;
+  std::vector<size_t>   firstSet_;
+};
+
+// Block occupancy of the atlas used while packing the patches. The canvas is a
+// row-major bitset with one padding word per row. For each row, the index of the
+// first free block is maintained to skip the positions that can't be used.
+class PCCPackingCanvas {
+ public:
+  PCCPackingCanvas();
+  PCCPackingCanvas( size_t width, size_t height );
+  ~PCCPackingCanvas();
+
+  // the content of the canvas is kept when the canvas is resized.
+  void resize( size_t width, size_t height );
+
+  inline size_t getWidth() const { return width_; }
+  inline size_t getHeight() const { return height_; }
+  inline bool   isOccupied( size_t x, size_t y ) const {
+    return ( ( bits_[y * stride_ + ( x >> 6 )] >> ( x & 63 ) ) & 1 ) != 0;
+  }
+  inline bool isOccupied( size_t pos ) const { return isOccupied( pos % width_, pos / width_ ); }
+  void        setOccupied( size_t x, size_t y );
+  inline void setOccupied( size_t pos ) { setOccupied( pos % width_, pos / width_ ); }
+
+  // return true if the footprint placed with its patch origin on (u,v) lies
+  // in the canvas (and in the tile if defined) without overlapping occupied blocks.
+  bool checkFit( const PCCPackingFootprint& footprint, size_t u, size_t v, const Tile& tile = Tile() ) const;
+
+  // return the first u for which the footprint placed on row v could fit,
+  // according to the first free block of the rows it covers.
+  size_t getFirstCandidate( const PCCPackingFootprint& footprint, size_t v ) const;
+  size_t getFirstCandidate( const std::vector<PCCPackingFootprint>& footprints, size_t v ) const;
+
+ private:
+  void updateFirstFree( size_t y );
+
+  size_t                width_;
+  size_t                height_;
+  size_t                stride_;
+  std::vector<uint64_t> bits_;
+  std::vector<size_t>   firstFree_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCPackingCanvas_h */
@@ -36,6 +36,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCPackingCanvas.h"
 
 namespace pcc {
 
@@ -528,31 +529,20 @@ class PCCPatch {
     return int( x + canvasStrideBlk * y );
   }
 
-  bool checkFitPatchCanvas( std::vector<bool> canvas,
-                            size_t            canvasStrideBlk,
-                            size_t            canvasHeightBlk,
-                            bool              bPrecedence,
-                            int               safeguard = 0,
-                            const Tile        tile      = Tile() ) {
-    for ( size_t v0 = 0; v0 < getSizeV0(); ++v0 ) {
-      for ( size_t u0 = 0; u0 < getSizeU0(); ++u0 ) {
-        for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-          for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-            int pos = patchBlock2CanvasBlock( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk, tile );
-            if ( pos < 0 ) {
-              return false;
-            } else {
-              if ( bPrecedence ) {
-                if ( canvas[pos] && occupancy_[u0 + getSizeU0() * v0] ) { return false; }
-              } else {
-                if ( canvas[pos] ) { return false; }
-              }
-            }
-          }
-        }
-      }
-    }
-    return true;
+  bool checkFitPatchCanvas( const PCCPackingCanvas& canvas,
+                            bool                    bPrecedence,
+                            int                     safeguard = 0,
+                            const Tile              tile      = Tile() ) const {
+    PCCPackingFootprint footprint;
+    getPackingFootprint( footprint, patchOrientation_, bPrecedence, safeguard );
+    return canvas.checkFit( footprint, u0_, v0_, tile );
+  }
+
+  void getPackingFootprint( PCCPackingFootprint& footprint,
+                            size_t               patchOrientation,
+                            bool                 bPrecedence,
+                            int                  safeguard ) const {
+    buildPackingFootprint( footprint, patchOrientation, sizeU0_, sizeV0_, bPrecedence, safeguard );
   }
 
   bool smallerRefFirst( const PCCPatch& rhs ) {
@@ -916,31 +906,18 @@ class PCCPatch {
     return int( x + canvasStrideBlk * y );
   }
 
-  bool checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                  size_t            canvasStrideBlk,
-                                  size_t            canvasHeightBlk,
-                                  bool              bPrecedence,
-                                  int               safeguard = 0 ) {
-    for ( size_t v0 = 0; v0 < curGPAPatchData_.sizeV0; ++v0 ) {
-      for ( size_t u0 = 0; u0 < curGPAPatchData_.sizeU0; ++u0 ) {
-        for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-          for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-            int pos = patchBlock2CanvasBlockForGPA( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk );
-            if ( pos < 0 ) {
-              return false;
-            } else {
-              if ( bPrecedence ) {
-                if ( canvas[pos] && occupancy_[u0 + getSizeU0() * v0] ) { return false; }
-              } else {
-                if ( canvas[pos] ) { return false; }
-              }
-            }
-          }
-        }
-      }
-    }
+  bool checkFitPatchCanvasForGPA( const PCCPackingCanvas& canvas, bool bPrecedence, int safeguard = 0 ) const {
+    PCCPackingFootprint footprint;
+    getPackingFootprintForGPA( footprint, curGPAPatchData_.patchOrientation, bPrecedence, safeguard );
+    return canvas.checkFit( footprint, curGPAPatchData_.u0, curGPAPatchData_.v0 );
+  }
 
-    return true;
+  void getPackingFootprintForGPA( PCCPackingFootprint& footprint,
+                                  size_t               patchOrientation,
+                                  bool                 bPrecedence,
+                                  int                  safeguard ) const {
+    buildPackingFootprint( footprint, patchOrientation, curGPAPatchData_.sizeU0, curGPAPatchData_.sizeV0, bPrecedence,
+                           safeguard );
   }
 
   void allocOneLayerData() {
@@ -1124,7 +1101,7 @@ class PCCPatch {
 
   void setLocalData( const std::vector<uint8_t>&  occupancyMapVideo,
                      const std::vector<uint16_t>& geometryVideo,
-                     std::vector<size_t>&         blockToPatch,
+                     const std::vector<uint32_t>& blockToPatch,
                      const int32_t                width,
                      const int32_t                height,
                      const int32_t                occupancyPrecision,
@@ -1302,6 +1279,52 @@ class PCCPatch {
   }
 
  private:
+  // marks the canvas blocks covered by the patch placed in (0,0) with the
+  // given orientation (same mapping as patchBlock2CanvasBlock()).
+  void buildPackingFootprint( PCCPackingFootprint& footprint,
+                              size_t               patchOrientation,
+                              size_t               sizeU0,
+                              size_t               sizeV0,
+                              bool                 bPrecedence,
+                              int                  safeguard ) const {
+    if ( sizeU0 == 0 || sizeV0 == 0 ) {
+      footprint.initialize( 0, 0, safeguard );
+      return;
+    }
+    bool switched = false;
+    switch ( patchOrientation ) {
+      case PATCH_ORIENTATION_DEFAULT:
+      case PATCH_ORIENTATION_ROT180:
+      case PATCH_ORIENTATION_MIRROR:
+      case PATCH_ORIENTATION_MROT180: switched = false; break;
+      case PATCH_ORIENTATION_ROT90:
+      case PATCH_ORIENTATION_ROT270:
+      case PATCH_ORIENTATION_MROT90:
+      case PATCH_ORIENTATION_MROT270:
+      case PATCH_ORIENTATION_SWAP: switched = true; break;
+      default: footprint.invalidate(); return;
+    }
+    footprint.initialize( switched ? sizeV0 : sizeU0, switched ? sizeU0 : sizeV0, safeguard );
+    for ( size_t v0 = 0; v0 < sizeV0; ++v0 ) {
+      for ( size_t u0 = 0; u0 < sizeU0; ++u0 ) {
+        if ( bPrecedence && !occupancy_[u0 + getSizeU0() * v0] ) { continue; }
+        size_t x = 0, y = 0;
+        switch ( patchOrientation ) {
+          case PATCH_ORIENTATION_DEFAULT: x = u0, y = v0; break;
+          case PATCH_ORIENTATION_ROT90: x = sizeV0 - 1 - v0, y = u0; break;
+          case PATCH_ORIENTATION_ROT180: x = sizeU0 - 1 - u0, y = sizeV0 - 1 - v0; break;
+          case PATCH_ORIENTATION_ROT270: x = v0, y = sizeU0 - 1 - u0; break;
+          case PATCH_ORIENTATION_MIRROR: x = sizeU0 - 1 - u0, y = v0; break;
+          case PATCH_ORIENTATION_MROT90: x = sizeV0 - 1 - v0, y = sizeU0 - 1 - u0; break;
+          case PATCH_ORIENTATION_MROT180: x = u0, y = sizeV0 - 1 - v0; break;
+          case PATCH_ORIENTATION_MROT270:
+          case PATCH_ORIENTATION_SWAP: x = v0, y = u0; break;
+        }
+        footprint.set( x, y );
+      }
+    }
+  }
+
   size_t index_;          // patch index
   size_t originalIndex_;  // patch original index
   size_t u1_;             // tangential shift
@@ -1364,8 +1387,8 @@ class PatchBlockFiltering {
   ~PatchBlockFiltering() {}
 
   inline void setPatches( std::vector<PCCPatch>* patches ) { patches_ = patches; }
-  inline void setBlockToPatch( std::vector<size_t>* value ) { blockToPatch_ = value; }
-  inline void setOccupancyMapEncoder( std::vector<uint32_t>* value ) { occupancyMapEncoder_ = value; }
+  inline void setBlockToPatch( std::vector<uint32_t>* value ) { blockToPatch_ = value; }
+  inline void setOccupancyMapEncoder( std::vector<uint8_t>* value ) { occupancyMapEncoder_ = value; }
   inline void setOccupancyMapVideo( const std::vector<uint8_t>* value ) { occupancyMapVideo_ = value; }
   inline void setGeometryVideo( const std::vector<uint16_t>* value ) { geometryVideo_ = value; }
 
@@ -1399,8 +1422,8 @@ class PatchBlockFiltering {
 
  private:
   std::vector<PCCPatch>*       patches_;
-  std::vector<size_t>*         blockToPatch_;
-  std::vector<uint32_t>*       occupancyMapEncoder_;
+  std::vector<uint32_t>*       blockToPatch_;
+  std::vector<uint8_t>*        occupancyMapEncoder_;
   const std::vector<uint8_t>*  occupancyMapVideo_;
   const std::vector<uint16_t>* geometryVideo_;
 };
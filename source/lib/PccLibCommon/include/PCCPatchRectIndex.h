@@ -0,0 +1,83 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCPatchRectIndex_h
+#define PCCPatchRectIndex_h
+
+#include "PCCCommon.h"
+#include <map>
+#include <tuple>
+
+namespace pcc {
+
+class PCCPatch;
+
+// Uniform grid over the rectangles ( u1, v1, sizeU, sizeV ) of the patches of a
+// frame, used to match the patches of two frames without comparing all of them.
+// Only the patches with the same view and level of detail scales are matched, so
+// the patches are bucketed by these values and each bucket has its own grid, with
+// about one cell per patch over the bounding box of its rectangles.
+class PCCPatchRectIndex {
+ public:
+  PCCPatchRectIndex( const std::vector<PCCPatch>& patches );
+
+  // bucket of the patches with the view and scales of patch, or -1 if there is none.
+  int    getBucket( const PCCPatch& patch ) const;
+  size_t getBucketCount() const { return buckets_.size(); }
+
+  // indices, in increasing order, of the patches of the bucket whose rectangle
+  // overlaps the rectangle of patch. The intersection of the rectangle of patch
+  // with the ones of the other patches of the bucket is empty.
+  void getCandidates( int bucket, const PCCPatch& patch, std::vector<size_t>& candidates ) const;
+
+ private:
+  struct Bucket {
+    size_t                           size_;
+    int64_t                          minU_;
+    int64_t                          minV_;
+    int64_t                          maxU_;
+    int64_t                          maxV_;
+    int64_t                          cellSize_;
+    int64_t                          cellCountU_;
+    int64_t                          cellCountV_;
+    std::vector<std::vector<size_t>> cells_;
+  };
+
+  const std::vector<PCCPatch>&                      patches_;
+  std::map<std::tuple<size_t, size_t, size_t>, int> bucketIndices_;
+  std::vector<Bucket>                               buckets_;
+};
+
+};  // namespace pcc
+
+#endif /* PCCPatchRectIndex_h */
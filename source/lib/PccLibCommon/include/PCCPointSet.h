@@ -39,6 +39,8 @@
 
 namespace pcc {
 
+class PCCKdTree;
+
 class PCCPointSet3 {
  public:
   PCCPointSet3() : withNormals_( false ), withColors_( false ), withReflectances_( false ) {}
@@ -175,11 +177,12 @@ class PCCPointSet3 {
     assert( index < reflectances_.size() && withReflectances_ );
     reflectances_[index] = reflectance;
   }
-  std::vector<PCCPoint3D>&    getPositions() { return positions_; }
-  std::vector<PCCColor3B>&    getColors() { return colors_; }
-  std::vector<PCCColor16bit>& getColors16bit() { return colors16bit_; }
-  std::vector<uint16_t>&      getReflectances() { return reflectances_; }
-  std::vector<uint8_t>&       getTypes() { return types_; }
+  std::vector<PCCPoint3D>&       getPositions() { return positions_; }
+  const std::vector<PCCPoint3D>& getPositions() const { return positions_; }
+  std::vector<PCCColor3B>&       getColors() { return colors_; }
+  std::vector<PCCColor16bit>&    getColors16bit() { return colors16bit_; }
+  std::vector<uint16_t>&         getReflectances() { return reflectances_; }
+  std::vector<uint8_t>&          getTypes() { return types_; }
 
   bool hasReflectances() const { return withReflectances_; }
   void addReflectances() {
@@ -408,6 +411,8 @@ class PCCPointSet3 {
 
   void removeDuplicate();
   void distanceGeo( const PCCPointSet3& pointcloud, float& distPAB, float& distPBA ) const;
+  // mean squared distance to the point cloud of kdtree, built by the caller
+  void distance( const PCCKdTree& kdtree, float& distP ) const;
   void distanceGeoColor( const PCCPointSet3& pointcloud,
                          float&              distPAB,
                          float&              distPBA,
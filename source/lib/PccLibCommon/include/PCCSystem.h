@@ -48,6 +48,30 @@ int system( const char* command ) noexcept;
 #else
 static inline int system( const char* command ) { return ::system( command ); }
 #endif
+
+/**
+ * a read-only memory mapping of a whole file (mmap or winapi file mapping).
+ */
+class PCCMemoryMappedFile {
+ public:
+  PCCMemoryMappedFile() = default;
+  PCCMemoryMappedFile( const PCCMemoryMappedFile& ) = delete;
+  PCCMemoryMappedFile& operator=( const PCCMemoryMappedFile& ) = delete;
+  ~PCCMemoryMappedFile() { close(); }
+
+  bool        open( const std::string& fileName );
+  void        close();
+  const char* data() const { return data_; }
+  size_t      size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t      size_ = 0;
+#ifdef _WIN32
+  void* file_    = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
 }  // namespace pcc
 
 //===========================================================================
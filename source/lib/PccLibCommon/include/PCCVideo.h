@@ -44,14 +44,25 @@ class PCCVideo {
  public:
   PCCVideo()                  = default;
   PCCVideo( const PCCVideo& ) = default;
+  PCCVideo( PCCVideo&& )      = default;
   PCCVideo& operator=( const PCCVideo& rhs ) = default;
-  ~PCCVideo()                                = default;
+  PCCVideo& operator=( PCCVideo&& rhs ) = default;
+  ~PCCVideo()                           = default;
+
+  // the frames of a copy share their channels with the ones of the video, see PCCImage
+  PCCVideo<T, N> clone() const {
+    PCCVideo<T, N> video;
+    video.frames_.reserve( frames_.size() );
+    for ( const auto& frame : frames_ ) { video.frames_.push_back( frame.clone() ); }
+    return video;
+  }
 
   void clear() {
     for ( auto& frame : frames_ ) { frame.clear(); }
     frames_.clear();
   }
-  std::vector<PCCImage<T, N> >& getFrames() { return frames_; }
+  std::vector<PCCImage<T, N> >&       getFrames() { return frames_; }
+  const std::vector<PCCImage<T, N> >& getFrames() const { return frames_; }
   void                          swap( PCCVideo<T, N>& video ) { frames_.swap( video.frames_ ); }
 
   PCCImage<T, N>& getFrame( const size_t index ) {
@@ -62,8 +73,9 @@ class PCCVideo {
     assert( index < frames_.size() );
     return frames_[index];
   }
-  PCCImage<T, N>& operator[]( int index ) { return frames_[index]; }
-  void            setDeprecatedColorFormat( size_t value ) {
+  PCCImage<T, N>&       operator[]( int index ) { return frames_[index]; }
+  const PCCImage<T, N>& operator[]( int index ) const { return frames_[index]; }
+  void                  setDeprecatedColorFormat( size_t value ) {
     for ( auto& f : frames_ ) f.setDeprecatedColorFormat( value );
   }
   void resize( const size_t frameCount ) { frames_.resize( frameCount ); }
@@ -79,7 +91,7 @@ class PCCVideo {
   }
   size_t getFrameCount() const { return frames_.size(); }
 
-  bool write( const std::string fileName, const size_t nbyte ) {
+  bool write( const std::string fileName, const size_t nbyte ) const {
     printf( "Write video: %s \n", fileName.c_str() );
     fflush( stdout );
     std::ofstream outfile( fileName, std::ios::binary );
@@ -116,8 +128,8 @@ class PCCVideo {
   }
 
  private:
-  bool write( std::ofstream& outfile, const size_t nbyte ) {
-    for ( auto& frame : frames_ ) {
+  bool write( std::ofstream& outfile, const size_t nbyte ) const {
+    for ( const auto& frame : frames_ ) {
       if ( !frame.write( outfile, nbyte ) ) { return false; }
     }
     return true;
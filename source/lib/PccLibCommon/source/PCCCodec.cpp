@@ -124,12 +124,9 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
 
       // identify boundary cells
       size_t           pointCount = reconstruct.getPointCount();
-      std::vector<int> cellIndex;
-      cellIndex.resize( w * w * w );
-      std::fill( cellIndex.begin(), cellIndex.end(), -1 );
-      size_t    numBoundaryCells = 0;
-      const int disth            = ( std::max )( static_cast<int>( params.gridSize_ ) / 2, 1 );
-      const int th               = params.gridSize_ * w;
+      PCCGridCellIndex cellIndex;
+      const int        disth = ( std::max )( static_cast<int>( params.gridSize_ ) / 2, 1 );
+      const int        th    = params.gridSize_ * w;
       for ( size_t n = 0; n < pointCount; ++n ) {
         if ( reconstruct.getBoundaryPointType( n ) == 1 ) {
           PCCPoint3D point = reconstruct[n];
@@ -159,41 +156,36 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
                 int x4     = qx + ix;
                 int y4     = qy + iy;
                 int z4     = qz + iz;
-                int cellId = x4 + y4 * w + z4 * w * w;
-                if ( cellIndex[cellId] == -1 ) {
-                  cellIndex[cellId] = numBoundaryCells;
-                  numBoundaryCells++;
-                }
+                cellIndex.insert( x4 + y4 * w + z4 * w * w );
               }
             }
           }
         }
       }
 
-      geoSmoothingCenter_.resize( numBoundaryCells );
-      geoSmoothingCount_.resize( numBoundaryCells );
-      geoSmoothingPartition_.resize( numBoundaryCells );
-      geoSmoothingDoSmooth_.resize( numBoundaryCells );
-      int size = static_cast<int>( geoSmoothingCount_.size() );
-      geoSmoothingCount_.resize( 0 );
-      geoSmoothingCount_.resize( size, 0 );
+      // the smoothing grid is local to the call so that frames can be smoothed concurrently.
+      const size_t                   numBoundaryCells = cellIndex.size();
+      std::vector<uint16_t>          geoSmoothingCount( numBoundaryCells, 0 );
+      std::vector<PCCVector3<float>> geoSmoothingCenter( numBoundaryCells );
+      std::vector<bool>              geoSmoothingDoSmooth( numBoundaryCells );
+      std::vector<uint32_t>          geoSmoothingPartition( numBoundaryCells );
       for ( int j = 0; j < reconstruct.getPointCount(); j++ ) {
         PCCPoint3D point  = reconstruct[j];
         int        x2     = point.x() / params.gridSize_;
         int        y2     = point.y() / params.gridSize_;
         int        z2     = point.z() / params.gridSize_;
         int        cellId = x2 + y2 * w + z2 * w * w;
-        if ( cellIndex[cellId] != -1 ) {
-          addGridCentroid( reconstruct[j], partition[j] + 1, geoSmoothingCount_, geoSmoothingCenter_,
-                           geoSmoothingPartition_, geoSmoothingDoSmooth_, static_cast<int>( params.gridSize_ ), w,
-                           cellIndex[cellId] );
+        const int  cell   = cellIndex[cellId];
+        if ( cell != -1 ) {
+          addGridCentroid( reconstruct[j], partition[j] + 1, geoSmoothingCount, geoSmoothingCenter,
+                           geoSmoothingPartition, geoSmoothingDoSmooth, static_cast<int>( params.gridSize_ ), w, cell );
         }
       }
-      for ( int i = 0; i < geoSmoothingCount_.size(); i++ ) {
-        if ( geoSmoothingCount_[i] != 0U ) { geoSmoothingCenter_[i] /= geoSmoothingCount_[i]; }
+      for ( int i = 0; i < geoSmoothingCount.size(); i++ ) {
+        if ( geoSmoothingCount[i] != 0U ) { geoSmoothingCenter[i] /= geoSmoothingCount[i]; }
       }
-      smoothPointCloudGrid( reconstruct, partition, params, w, cellIndex );
-      cellIndex.clear();
+      smoothPointCloudGrid( reconstruct, partition, params, w, geoSmoothingCount, geoSmoothingCenter,
+                            geoSmoothingDoSmooth, cellIndex );
     } else {
       if ( !params.pbfEnableFlag_ ) { smoothPointCloud( reconstruct, partition, params ); }
     }
@@ -207,16 +199,13 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
                                PCCContext&                         context,
                                const PCCColorTransform             colorTransform,
                                const GeneratePointCloudParameters& params ) {
-  const size_t     gridSize         = params.occupancyPrecision_;
-  int              pcMaxSize        = pow( 2, params.geometryBitDepth3D_ );
-  const size_t     w                = pcMaxSize / gridSize;
-  const size_t     w3               = w * w * w;
-  size_t           pointCount       = reconstruct.getPointCount();
-  size_t           numBoundaryCells = 0;
-  const size_t     disth            = ( std::max )( gridSize / 2, (size_t)1 );
-  std::vector<int> cellIndex;
-  cellIndex.resize( w3 );
-  std::fill( cellIndex.begin(), cellIndex.end(), -1 );
+  const size_t     gridSize   = params.occupancyPrecision_;
+  int              pcMaxSize  = pow( 2, params.geometryBitDepth3D_ );
+  const size_t     w          = pcMaxSize / gridSize;
+  const size_t     w3         = w * w * w;
+  size_t           pointCount = reconstruct.getPointCount();
+  const size_t     disth      = ( std::max )( gridSize / 2, (size_t)1 );
+  PCCGridCellIndex cellIndex;
   assert( params.flagColorSmoothing_ );
   TRACE_CODEC( "colorSmoothing \n" );
   TRACE_CODEC( "  geometryBitDepth3D_       = %zu \n", params.geometryBitDepth3D_ );
@@ -251,57 +240,46 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
             int x4     = qx + ix;
             int y4     = qy + iy;
             int z4     = qz + iz;
-            int cellId = x4 + y4 * w + z4 * w * w;
-            if ( cellIndex[cellId] == -1 ) {
-              cellIndex[cellId] = numBoundaryCells;
-              numBoundaryCells++;
-            }
+            cellIndex.insert( x4 + y4 * w + z4 * w * w );
           }
         }
       }
     }
   }
-  colorSmoothingCenter_.resize( numBoundaryCells );
-  colorSmoothingCount_.resize( numBoundaryCells );
-  colorSmoothingPartition_.resize( numBoundaryCells );
-  colorSmoothingDoSmooth_.resize( numBoundaryCells );
-  std::fill( colorSmoothingCenter_.begin(), colorSmoothingCenter_.end(), 0 );
-  std::fill( colorSmoothingCount_.begin(), colorSmoothingCount_.end(), 0 );
-  std::fill( colorSmoothingPartition_.begin(), colorSmoothingPartition_.end(), 0 );
-  std::fill( colorSmoothingDoSmooth_.begin(), colorSmoothingDoSmooth_.end(), 0 );
-  colorSmoothingLum_.clear();
-  colorSmoothingLum_.resize( numBoundaryCells );
+  // the smoothing grid is local to the call so that frames can be smoothed concurrently.
+  const size_t                       numBoundaryCells = cellIndex.size();
+  std::vector<uint16_t>              colorSmoothingCount( numBoundaryCells, 0 );
+  std::vector<PCCVector3<float>>     colorSmoothingCenter( numBoundaryCells, PCCVector3<float>( 0.0F ) );
+  std::vector<bool>                  colorSmoothingDoSmooth( numBoundaryCells, false );
+  std::vector<uint32_t>              colorSmoothingPartition( numBoundaryCells, 0 );
+  std::vector<std::vector<uint16_t>> colorSmoothingLum( numBoundaryCells );
   for ( int k = 0; k < reconstruct.getPointCount(); k++ ) {
     PCCPoint3D point  = reconstruct[k];
     int        x2     = point.x() / gridSize;
     int        y2     = point.y() / gridSize;
     int        z2     = point.z() / gridSize;
     size_t     cellId = x2 + y2 * w + z2 * w * w;
-    if( cellId >= cellIndex.size() ){
-      TRACE_CODEC( " cellId >  cellIndex.size() <=>  %zu > %zu \n",cellId, cellIndex.size() );      
+    if( cellId >= w3 ){
+      TRACE_CODEC( " cellId >  w3 <=>  %zu > %zu \n",cellId, w3 );      
     } else {
-      if ( cellIndex[cellId] != -1 ) {
+      const int cell = cellIndex[cellId];
+      if ( cell != -1 ) {
         PCCColor16bit color16bit = reconstruct.getColor16bit( k );
         PCCVector3D   clr;
         for ( size_t c = 0; c < 3; ++c ) { clr[c] = double( color16bit[c] ); }
         const size_t patchIndexPlusOne = reconstruct.getPointPatchIndex( k ) + 1;
-        addGridColorCentroid( reconstruct[k], clr, patchIndexPlusOne, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingPartition_, colorSmoothingDoSmooth_, gridSize, colorSmoothingLum_, params,
-                              cellIndex[cellId] );
+        addGridColorCentroid( reconstruct[k], clr, patchIndexPlusOne, colorSmoothingCount, colorSmoothingCenter,
+                              colorSmoothingPartition, colorSmoothingDoSmooth, gridSize, colorSmoothingLum, params,
+                              cell );
       }
     }
   }
-  smoothPointCloudColorLC( reconstruct, params, cellIndex );
-  colorSmoothingCenter_.resize( 0 );
-  colorSmoothingCenter_.shrink_to_fit();
-  colorSmoothingCount_.resize( 0 );
-  colorSmoothingCount_.shrink_to_fit();
-  colorSmoothingPartition_.resize( 0 );
-  colorSmoothingPartition_.shrink_to_fit();
-  colorSmoothingDoSmooth_.resize( 0 );
-  colorSmoothingDoSmooth_.shrink_to_fit();
-  colorSmoothingLum_.resize( 0 );
-  colorSmoothingLum_.shrink_to_fit();
+  // the luminances are sorted once for the medians computed by the concurrent lookups.
+  tbb::parallel_for( size_t( 0 ), numBoundaryCells, [&]( const size_t cell ) {
+    std::sort( colorSmoothingLum[cell].begin(), colorSmoothingLum[cell].end() );
+  } );
+  smoothPointCloudColorLC( reconstruct, params, colorSmoothingCount, colorSmoothingCenter, colorSmoothingDoSmooth,
+                           colorSmoothingLum, cellIndex );
 }
 
 int PCCCodec::getDeltaNeighbors( const PCCImageGeometry& frame,
@@ -330,14 +308,14 @@ int PCCCodec::getDeltaNeighbors( const PCCImageGeometry& frame,
   return deltaMax;
 }
 
-void PCCCodec::identifyBoundaryPoints( const std::vector<uint32_t>& occupancyMap,
-                                       const size_t                 x,
-                                       const size_t                 y,
-                                       const size_t                 imageWidth,
-                                       const size_t                 imageHeight,
-                                       const size_t                 pointindex,
-                                       std::vector<uint32_t>&       BPflag,
-                                       PCCPointSet3&                reconstruct ) {
+void PCCCodec::identifyBoundaryPoints( const std::vector<uint8_t>& occupancyMap,
+                                       const size_t                x,
+                                       const size_t                y,
+                                       const size_t                imageWidth,
+                                       const size_t                imageHeight,
+                                       const size_t                pointindex,
+                                       std::vector<uint32_t>&      BPflag,
+                                       PCCPointSet3&               reconstruct ) {
   if ( occupancyMap[y * imageWidth + x] != 0 ) {
     if ( y > 0 && y < imageHeight - 1 ) {
       if ( occupancyMap[( y - 1 ) * imageWidth + x] == 0 || occupancyMap[( y + 1 ) * imageWidth + x] == 0 ) {
@@ -654,6 +632,8 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   const size_t blockToPatchHeight    = frame.getHeight() / params.occupancyResolution_;
   const size_t patchCount            = patches.size();
   uint32_t     patchIndex            = 0;
+  assert( frame.getWidth() <= ( std::numeric_limits<uint16_t>::max )() &&
+          frame.getHeight() <= ( std::numeric_limits<uint16_t>::max )() );
   reconstruct.addColors();
 
   printf( "generatePointCloud pbfEnableFlag_ = %d \n", params.pbfEnableFlag_ );
@@ -1144,9 +1124,9 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
     }
     size_t pointCount = reconstruct.getPointCount() - frame.getTotalNumberOfRawPoints();
     for ( size_t i = 0; i < pointCount; ++i ) {
-      const PCCVector3<size_t> location = pointToPixel[i];
-      const size_t             x        = location[0];
-      const size_t             y        = location[1];
+      const PCCVector3<uint16_t> location = pointToPixel[i];
+      const size_t               x        = location[0];
+      const size_t               y        = location[1];
       if ( occupancyMap[y * imageWidth + x] != 0 ) {
         identifyBoundaryPoints( occupancyMap, x, y, imageWidth, imageHeight, i, BPflag, reconstruct );
       }
@@ -1193,7 +1173,7 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
                               std::vector<bool>&              doSmooth,
                               uint8_t                         gridSize,
                               uint16_t                        gridWidth,
-                              std::vector<int>&               cellIndex ) {
+                              const PCCGridCellIndex&         cellIndex ) {
   uint16_t gridSizeHalf           = gridSize / 2;
   bool     otherClusterPointCount = false;
   int      x                      = curPoint.x();
@@ -1209,15 +1189,17 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   int      sy                     = y2 + ( ( y3 < gridSizeHalf ) ? -1 : 0 );
   int      sz                     = z2 + ( ( z3 < gridSizeHalf ) ? -1 : 0 );
   int      idx[2][2][2];
+  int      cells[2][2][2];
   for ( int dz = 0; dz < 2; dz++ ) {
     int z4 = sz + dz;
     for ( int dy = 0; dy < 2; dy++ ) {
       int y4 = sy + dy;
       for ( int dx = 0; dx < 2; dx++ ) {
-        int x4          = sx + dx;
-        int tmp         = x4 + y4 * gridWidth + z4 * gridWidth * gridWidth;
-        idx[dz][dy][dx] = tmp;
-        if ( doSmooth[cellIndex[tmp]] && ( gridCount[cellIndex[tmp]] != 0U ) ) { otherClusterPointCount = true; }
+        int x4            = sx + dx;
+        int tmp           = x4 + y4 * gridWidth + z4 * gridWidth * gridWidth;
+        idx[dz][dy][dx]   = tmp;
+        cells[dz][dy][dx] = cellIndex[tmp];
+        if ( doSmooth[cells[dz][dy][dx]] && ( gridCount[cells[dz][dy][dx]] != 0U ) ) { otherClusterPointCount = true; }
       }
     }
   }
@@ -1236,101 +1218,80 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   int wz         = ( z - sz2 - gridSizeHalf ) * 2 + 1;
 
   centroid3[0][0][0][0] =
-      gridCount[cellIndex[idx[0][0][0]]] > 0 ? static_cast<double>( center[cellIndex[idx[0][0][0]]][0] ) : curVector[0];
+      gridCount[cells[0][0][0]] > 0 ? static_cast<double>( center[cells[0][0][0]][0] ) : curVector[0];
   centroid3[0][0][0][1] =
-      gridCount[cellIndex[idx[0][0][0]]] > 0 ? static_cast<double>( center[cellIndex[idx[0][0][0]]][1] ) : curVector[1];
+      gridCount[cells[0][0][0]] > 0 ? static_cast<double>( center[cells[0][0][0]][1] ) : curVector[1];
   centroid3[0][0][0][2] =
-      gridCount[cellIndex[idx[0][0][0]]] > 0 ? static_cast<double>( center[cellIndex[idx[0][0][0]]][2] ) : curVector[2];
+      gridCount[cells[0][0][0]] > 0 ? static_cast<double>( center[cells[0][0][0]][2] ) : curVector[2];
 
   centroid3[0][0][1] = curVector;
   if ( idx[0][0][1] < gridWidth3 ) {
-    centroid3[0][0][1][0] = gridCount[cellIndex[idx[0][0][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][0][1]]][0] )
-                                : curVector[0];
-    centroid3[0][0][1][1] = gridCount[cellIndex[idx[0][0][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][0][1]]][1] )
-                                : curVector[1];
-    centroid3[0][0][1][2] = gridCount[cellIndex[idx[0][0][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][0][1]]][2] )
-                                : curVector[2];
+    centroid3[0][0][1][0] =
+        gridCount[cells[0][0][1]] > 0 ? static_cast<double>( center[cells[0][0][1]][0] ) : curVector[0];
+    centroid3[0][0][1][1] =
+        gridCount[cells[0][0][1]] > 0 ? static_cast<double>( center[cells[0][0][1]][1] ) : curVector[1];
+    centroid3[0][0][1][2] =
+        gridCount[cells[0][0][1]] > 0 ? static_cast<double>( center[cells[0][0][1]][2] ) : curVector[2];
   }
 
   centroid3[0][1][0] = curVector;
   if ( idx[0][1][0] < gridWidth3 ) {
-    centroid3[0][1][0][0] = gridCount[cellIndex[idx[0][1][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][1][0]]][0] )
-                                : curVector[0];
-    centroid3[0][1][0][1] = gridCount[cellIndex[idx[0][1][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][1][0]]][1] )
-                                : curVector[1];
-    centroid3[0][1][0][2] = gridCount[cellIndex[idx[0][1][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][1][0]]][2] )
-                                : curVector[2];
+    centroid3[0][1][0][0] =
+        gridCount[cells[0][1][0]] > 0 ? static_cast<double>( center[cells[0][1][0]][0] ) : curVector[0];
+    centroid3[0][1][0][1] =
+        gridCount[cells[0][1][0]] > 0 ? static_cast<double>( center[cells[0][1][0]][1] ) : curVector[1];
+    centroid3[0][1][0][2] =
+        gridCount[cells[0][1][0]] > 0 ? static_cast<double>( center[cells[0][1][0]][2] ) : curVector[2];
   }
 
   centroid3[0][1][1] = curVector;
   if ( idx[0][1][1] < gridWidth3 ) {
-    centroid3[0][1][1][0] = gridCount[cellIndex[idx[0][1][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][1][1]]][0] )
-                                : curVector[0];
-    centroid3[0][1][1][1] = gridCount[cellIndex[idx[0][1][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][1][1]]][1] )
-                                : curVector[1];
-    centroid3[0][1][1][2] = gridCount[cellIndex[idx[0][1][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[0][1][1]]][2] )
-                                : curVector[2];
+    centroid3[0][1][1][0] =
+        gridCount[cells[0][1][1]] > 0 ? static_cast<double>( center[cells[0][1][1]][0] ) : curVector[0];
+    centroid3[0][1][1][1] =
+        gridCount[cells[0][1][1]] > 0 ? static_cast<double>( center[cells[0][1][1]][1] ) : curVector[1];
+    centroid3[0][1][1][2] =
+        gridCount[cells[0][1][1]] > 0 ? static_cast<double>( center[cells[0][1][1]][2] ) : curVector[2];
   }
 
   centroid3[1][0][0] = curVector;
   if ( idx[1][0][0] < gridWidth3 ) {
-    centroid3[1][0][0][0] = gridCount[cellIndex[idx[1][0][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][0][0]]][0] )
-                                : curVector[0];
-    centroid3[1][0][0][1] = gridCount[cellIndex[idx[1][0][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][0][0]]][1] )
-                                : curVector[1];
-    centroid3[1][0][0][2] = gridCount[cellIndex[idx[1][0][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][0][0]]][2] )
-                                : curVector[2];
+    centroid3[1][0][0][0] =
+        gridCount[cells[1][0][0]] > 0 ? static_cast<double>( center[cells[1][0][0]][0] ) : curVector[0];
+    centroid3[1][0][0][1] =
+        gridCount[cells[1][0][0]] > 0 ? static_cast<double>( center[cells[1][0][0]][1] ) : curVector[1];
+    centroid3[1][0][0][2] =
+        gridCount[cells[1][0][0]] > 0 ? static_cast<double>( center[cells[1][0][0]][2] ) : curVector[2];
   }
 
   centroid3[1][0][1] = curVector;
   if ( idx[1][0][1] < gridWidth3 ) {
-    centroid3[1][0][1][0] = gridCount[cellIndex[idx[1][0][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][0][1]]][0] )
-                                : curVector[0];
-    centroid3[1][0][1][1] = gridCount[cellIndex[idx[1][0][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][0][1]]][1] )
-                                : curVector[1];
-    centroid3[1][0][1][2] = gridCount[cellIndex[idx[1][0][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][0][1]]][2] )
-                                : curVector[2];
+    centroid3[1][0][1][0] =
+        gridCount[cells[1][0][1]] > 0 ? static_cast<double>( center[cells[1][0][1]][0] ) : curVector[0];
+    centroid3[1][0][1][1] =
+        gridCount[cells[1][0][1]] > 0 ? static_cast<double>( center[cells[1][0][1]][1] ) : curVector[1];
+    centroid3[1][0][1][2] =
+        gridCount[cells[1][0][1]] > 0 ? static_cast<double>( center[cells[1][0][1]][2] ) : curVector[2];
   }
 
   centroid3[1][1][0] = curVector;
   if ( idx[1][1][0] < gridWidth3 ) {
-    centroid3[1][1][0][0] = gridCount[cellIndex[idx[1][1][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][1][0]]][0] )
-                                : curVector[0];
-    centroid3[1][1][0][1] = gridCount[cellIndex[idx[1][1][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][1][0]]][1] )
-                                : curVector[1];
-    centroid3[1][1][0][2] = gridCount[cellIndex[idx[1][1][0]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][1][0]]][2] )
-                                : curVector[2];
+    centroid3[1][1][0][0] =
+        gridCount[cells[1][1][0]] > 0 ? static_cast<double>( center[cells[1][1][0]][0] ) : curVector[0];
+    centroid3[1][1][0][1] =
+        gridCount[cells[1][1][0]] > 0 ? static_cast<double>( center[cells[1][1][0]][1] ) : curVector[1];
+    centroid3[1][1][0][2] =
+        gridCount[cells[1][1][0]] > 0 ? static_cast<double>( center[cells[1][1][0]][2] ) : curVector[2];
   }
 
   centroid3[1][1][1] = curVector;
   if ( idx[1][1][1] < gridWidth3 ) {
-    centroid3[1][1][1][0] = gridCount[cellIndex[idx[1][1][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][1][1]]][0] )
-                                : curVector[0];
-    centroid3[1][1][1][1] = gridCount[cellIndex[idx[1][1][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][1][1]]][1] )
-                                : curVector[1];
-    centroid3[1][1][1][2] = gridCount[cellIndex[idx[1][1][1]]] > 0
-                                ? static_cast<double>( center[cellIndex[idx[1][1][1]]][2] )
-                                : curVector[2];
+    centroid3[1][1][1][0] =
+        gridCount[cells[1][1][1]] > 0 ? static_cast<double>( center[cells[1][1][1]][0] ) : curVector[0];
+    centroid3[1][1][1][1] =
+        gridCount[cells[1][1][1]] > 0 ? static_cast<double>( center[cells[1][1][1]][1] ) : curVector[1];
+    centroid3[1][1][1][2] =
+        gridCount[cells[1][1][1]] > 0 ? static_cast<double>( center[cells[1][1][1]][2] ) : curVector[2];
   }
 
   int gridSizeWx     = ( gridSize2 - wx );
@@ -1349,14 +1310,14 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   centroid4 = centroid3[0][0][0] + centroid3[0][0][1] + centroid3[0][1][0] + centroid3[0][1][1] + centroid3[1][0][0] +
               centroid3[1][0][1] + centroid3[1][1][0] + centroid3[1][1][1];
 
-  count = gridSizeWx * gridSizeWy * gridSizeWz * gridCount[cellIndex[idx[0][0][0]]];
-  count += (wx)*gridSizeWy * gridSizeWz * gridCount[cellIndex[idx[0][0][1]]];
-  count += gridSizeWx * (wy)*gridSizeWz * gridCount[cellIndex[idx[0][1][0]]];
-  count += ( wx ) * (wy)*gridSizeWz * gridCount[cellIndex[idx[0][1][1]]];
-  count += gridSizeWx * gridSizeWy * (wz)*gridCount[cellIndex[idx[1][0][0]]];
-  count += (wx)*gridSizeWy * (wz)*gridCount[cellIndex[idx[1][0][1]]];
-  count += gridSizeWx * ( wy ) * (wz)*gridCount[cellIndex[idx[1][1][0]]];
-  count += ( wx ) * ( wy ) * (wz)*gridCount[cellIndex[idx[1][1][1]]];
+  count = gridSizeWx * gridSizeWy * gridSizeWz * gridCount[cells[0][0][0]];
+  count += (wx)*gridSizeWy * gridSizeWz * gridCount[cells[0][0][1]];
+  count += gridSizeWx * (wy)*gridSizeWz * gridCount[cells[0][1][0]];
+  count += ( wx ) * (wy)*gridSizeWz * gridCount[cells[0][1][1]];
+  count += gridSizeWx * gridSizeWy * (wz)*gridCount[cells[1][0][0]];
+  count += (wx)*gridSizeWy * (wz)*gridCount[cells[1][0][1]];
+  count += gridSizeWx * ( wy ) * (wz)*gridCount[cells[1][1][0]];
+  count += ( wx ) * ( wy ) * (wz)*gridCount[cells[1][1][1]];
   centroid4 /= gridSize2 * gridSize2 * gridSize2;
   count /= gridSize2 * gridSize2 * gridSize2;
   centroid = centroid4 * count;
@@ -1459,44 +1420,51 @@ void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconst
                                      const std::vector<uint32_t>&        partition,
                                      const GeneratePointCloudParameters& params,
                                      uint16_t                            gridWidth,
-                                     std::vector<int>&                   cellIndex ) {
+                                     std::vector<uint16_t>&              gridCount,
+                                     std::vector<PCCVector3<float>>&     center,
+                                     std::vector<bool>&                  doSmooth,
+                                     const PCCGridCellIndex&             cellIndex ) {
   TRACE_CODEC( " smoothPointCloudGrid start \n" );
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = static_cast<int>( params.gridSize_ );
   const int    disth      = ( std::max )( gridSize / 2, 1 );
   const int    th         = gridSize * gridWidth;
-  for ( int c = 0; c < pointCount; c++ ) {
-    PCCPoint3D curPoint = reconstruct[c];
-    int        x        = static_cast<int>( curPoint.x() );
-    int        y        = static_cast<int>( curPoint.y() );
-    int        z        = static_cast<int>( curPoint.z() );
-    if ( x < disth || y < disth || z < disth || th <= x + disth || th <= y + disth || th <= z + disth ) { continue; }
-    PCCVector3D centroid( 0.0 );
-    PCCVector3D curVector( x, y, z );
-    int         count                  = 0;
-    bool        otherClusterPointCount = false;
-    PCCVector3D color( 0, 0, 0 );
-    if ( reconstruct.getBoundaryPointType( c ) == 1 ) {
-      otherClusterPointCount =
-          gridFiltering( partition, reconstruct, curPoint, centroid, count, geoSmoothingCount_, geoSmoothingCenter_,
-                         geoSmoothingDoSmooth_, gridSize, gridWidth, cellIndex );
-    }
-    if ( otherClusterPointCount ) {
-      // double dist2 = ( ( curVector * count - centroid ).getNorm2() +
-      // (double)count / 2.0 ) / (double)count;
-      double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
-      if ( dist2 >= ( std::max )( static_cast<int>( params.thresholdSmoothing_ ), count ) * 2 ) {
-        centroid = centroid / static_cast<double>( count ) + 0.5;
-        for ( size_t k = 0; k < 3; ++k ) {
-          centroid[k]       = double( int64_t( centroid[k] ) );
-          reconstruct[c][k] = centroid[k];
-        }
+  // the grid is complete: each point only reads it and only updates itself.
+  tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t c ) {
+      PCCPoint3D curPoint = reconstruct[c];
+      int        x        = static_cast<int>( curPoint.x() );
+      int        y        = static_cast<int>( curPoint.y() );
+      int        z        = static_cast<int>( curPoint.z() );
+      if ( x < disth || y < disth || z < disth || th <= x + disth || th <= y + disth || th <= z + disth ) { return; }
+      PCCVector3D centroid( 0.0 );
+      PCCVector3D curVector( x, y, z );
+      int         count                  = 0;
+      bool        otherClusterPointCount = false;
+      PCCVector3D color( 0, 0, 0 );
+      if ( reconstruct.getBoundaryPointType( c ) == 1 ) {
+        otherClusterPointCount =
+            gridFiltering( partition, reconstruct, curPoint, centroid, count, gridCount, center, doSmooth, gridSize,
+                           gridWidth, cellIndex );
+      }
+      if ( otherClusterPointCount ) {
+        // double dist2 = ( ( curVector * count - centroid ).getNorm2() +
+        // (double)count / 2.0 ) / (double)count;
+        double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
+        if ( dist2 >= ( std::max )( static_cast<int>( params.thresholdSmoothing_ ), count ) * 2 ) {
+          centroid = centroid / static_cast<double>( count ) + 0.5;
+          for ( size_t k = 0; k < 3; ++k ) {
+            centroid[k]       = double( int64_t( centroid[k] ) );
+            reconstruct[c][k] = centroid[k];
+          }
 
-        if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( c, POINT_SMOOTH ); }
-        reconstruct.setBoundaryPointType( c, static_cast<uint16_t>( 3 ) );
+          if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( c, POINT_SMOOTH ); }
+          reconstruct.setBoundaryPointType( c, static_cast<uint16_t>( 3 ) );
+        }
       }
-    }
-  }
+    } );
+  } );
   TRACE_CODEC( " smoothPointCloudGrid done \n" );
 }
 
@@ -1588,10 +1556,11 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
                                    std::vector<uint16_t>&              colorGridCount,
                                    std::vector<PCCVector3<float>>&     colorCenter,
                                    std::vector<bool>&                  colorDoSmooth,
+                                   std::vector<std::vector<uint16_t>>& colorLum,
                                    uint8_t                             gridSize,
                                    PCCVector3D&                        curPosColor,
                                    const GeneratePointCloudParameters& params,
-                                   std::vector<int>&                   cellIndex ) {
+                                   const PCCGridCellIndex&             cellIndex ) {
   const int w                      = pow( 2, params.geometryBitDepth3D_ ) / gridSize;
   bool      otherClusterPointCount = false;
   int       x                      = curPos.x();
@@ -1613,15 +1582,17 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
   int       wy                     = ( y - sy2 - gridSize / 2 ) * 2 + 1;
   int       wz                     = ( z - sz2 - gridSize / 2 ) * 2 + 1;
   int       idx[2][2][2];
+  int       cells[2][2][2];
   for ( int dz = 0; dz < 2; dz++ ) {
     for ( int dy = 0; dy < 2; dy++ ) {
       for ( int dx = 0; dx < 2; dx++ ) {
-        int x3          = sx + dx;
-        int y3          = sy + dy;
-        int z3          = sz + dz;
-        int tmp         = x3 + y3 * w + z3 * w * w;
-        idx[dz][dy][dx] = tmp;
-        if ( colorDoSmooth[cellIndex[tmp]] && ( colorGridCount[cellIndex[tmp]] != 0U ) ) {
+        int x3            = sx + dx;
+        int y3            = sy + dy;
+        int z3            = sz + dz;
+        int tmp           = x3 + y3 * w + z3 * w * w;
+        idx[dz][dy][dx]   = tmp;
+        cells[dz][dy][dx] = cellIndex[tmp];
+        if ( colorDoSmooth[cells[dz][dy][dx]] && ( colorGridCount[cells[dz][dy][dx]] != 0U ) ) {
           otherClusterPointCount = true;
         }
       }
@@ -1633,19 +1604,14 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
   int         gridSize2               = gridSize * 2;
   double      mmThresh                = params.thresholdColorVariation_ * 256.0;
   double      yThresh                 = params.thresholdColorDifference_ * 256.0;
-  if ( colorGridCount[cellIndex[idx[0][0][0]]] > 0 ) {
-    colorCentroid3[0][0][0][0] =
-        double( colorCenter[cellIndex[idx[0][0][0]]][0] ) / double( colorGridCount[cellIndex[idx[0][0][0]]] );
-    colorCentroid3[0][0][0][1] =
-        double( colorCenter[cellIndex[idx[0][0][0]]][1] ) / double( colorGridCount[cellIndex[idx[0][0][0]]] );
-    colorCentroid3[0][0][0][2] =
-        double( colorCenter[cellIndex[idx[0][0][0]]][2] ) / double( colorGridCount[cellIndex[idx[0][0][0]]] );
-    cnt0 = colorGridCount[cellIndex[idx[0][0][0]]];
-    if ( colorGridCount[cellIndex[idx[0][0][0]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][0][0]]], int( colorGridCount[cellIndex[idx[0][0][0]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][0][0]]], int( colorGridCount[cellIndex[idx[0][0][0]]] ) );
+  if ( colorGridCount[cells[0][0][0]] > 0 ) {
+    colorCentroid3[0][0][0][0] = double( colorCenter[cells[0][0][0]][0] ) / double( colorGridCount[cells[0][0][0]] );
+    colorCentroid3[0][0][0][1] = double( colorCenter[cells[0][0][0]][1] ) / double( colorGridCount[cells[0][0][0]] );
+    colorCentroid3[0][0][0][2] = double( colorCenter[cells[0][0][0]][2] ) / double( colorGridCount[cells[0][0][0]] );
+    cnt0 = colorGridCount[cells[0][0][0]];
+    if ( colorGridCount[cells[0][0][0]] > 1 ) {
+      double meanY = mean( colorLum[cells[0][0][0]], int( colorGridCount[cells[0][0][0]] ) );
+      double medianY = median( colorLum[cells[0][0][0]], int( colorGridCount[cells[0][0][0]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) {
         colorCentroid = curPosColor;
         colorCount    = 1;
@@ -1659,147 +1625,112 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
 
   double Y0 = colorCentroid3[0][0][0][0];
 
-  if ( colorGridCount[cellIndex[idx[0][0][1]]] > 0 ) {
-    colorCentroid3[0][0][1][0] =
-        double( colorCenter[cellIndex[idx[0][0][1]]][0] ) / double( colorGridCount[cellIndex[idx[0][0][1]]] );
-    colorCentroid3[0][0][1][1] =
-        double( colorCenter[cellIndex[idx[0][0][1]]][1] ) / double( colorGridCount[cellIndex[idx[0][0][1]]] );
-    colorCentroid3[0][0][1][2] =
-        double( colorCenter[cellIndex[idx[0][0][1]]][2] ) / double( colorGridCount[cellIndex[idx[0][0][1]]] );
+  if ( colorGridCount[cells[0][0][1]] > 0 ) {
+    colorCentroid3[0][0][1][0] = double( colorCenter[cells[0][0][1]][0] ) / double( colorGridCount[cells[0][0][1]] );
+    colorCentroid3[0][0][1][1] = double( colorCenter[cells[0][0][1]][1] ) / double( colorGridCount[cells[0][0][1]] );
+    colorCentroid3[0][0][1][2] = double( colorCenter[cells[0][0][1]][2] ) / double( colorGridCount[cells[0][0][1]] );
     double Y1 = colorCentroid3[0][0][1][0];
     if ( abs( Y0 - Y1 ) > yThresh ) { colorCentroid3[0][0][1] = curPosColor; }
-    if ( colorGridCount[cellIndex[idx[0][0][1]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][0][1]]], int( colorGridCount[cellIndex[idx[0][0][1]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][0][1]]], int( colorGridCount[cellIndex[idx[0][0][1]]] ) );
+    if ( colorGridCount[cells[0][0][1]] > 1 ) {
+      double meanY = mean( colorLum[cells[0][0][1]], int( colorGridCount[cells[0][0][1]] ) );
+      double medianY = median( colorLum[cells[0][0][1]], int( colorGridCount[cells[0][0][1]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[0][0][1] = curPosColor; }
     }
   } else {
     colorCentroid3[0][0][1] = curPosColor;
   }
 
-  if ( colorGridCount[cellIndex[idx[0][1][0]]] > 0 ) {
-    colorCentroid3[0][1][0][0] =
-        double( colorCenter[cellIndex[idx[0][1][0]]][0] ) / double( colorGridCount[cellIndex[idx[0][1][0]]] );
-    colorCentroid3[0][1][0][1] =
-        double( colorCenter[cellIndex[idx[0][1][0]]][1] ) / double( colorGridCount[cellIndex[idx[0][1][0]]] );
-    colorCentroid3[0][1][0][2] =
-        double( colorCenter[cellIndex[idx[0][1][0]]][2] ) / double( colorGridCount[cellIndex[idx[0][1][0]]] );
+  if ( colorGridCount[cells[0][1][0]] > 0 ) {
+    colorCentroid3[0][1][0][0] = double( colorCenter[cells[0][1][0]][0] ) / double( colorGridCount[cells[0][1][0]] );
+    colorCentroid3[0][1][0][1] = double( colorCenter[cells[0][1][0]][1] ) / double( colorGridCount[cells[0][1][0]] );
+    colorCentroid3[0][1][0][2] = double( colorCenter[cells[0][1][0]][2] ) / double( colorGridCount[cells[0][1][0]] );
     double Y2 = colorCentroid3[0][1][0][0];
 
     if ( abs( Y0 - Y2 ) > yThresh ) { colorCentroid3[0][1][0] = curPosColor; }
-    if ( colorGridCount[cellIndex[idx[0][1][0]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][1][0]]], int( colorGridCount[cellIndex[idx[0][1][0]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][1][0]]], int( colorGridCount[cellIndex[idx[0][1][0]]] ) );
+    if ( colorGridCount[cells[0][1][0]] > 1 ) {
+      double meanY = mean( colorLum[cells[0][1][0]], int( colorGridCount[cells[0][1][0]] ) );
+      double medianY = median( colorLum[cells[0][1][0]], int( colorGridCount[cells[0][1][0]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[0][1][0] = curPosColor; }
     }
   } else {
     colorCentroid3[0][1][0] = curPosColor;
   }
 
-  if ( colorGridCount[cellIndex[idx[0][1][1]]] > 0 ) {
-    colorCentroid3[0][1][1][0] =
-        double( colorCenter[cellIndex[idx[0][1][1]]][0] ) / double( colorGridCount[cellIndex[idx[0][1][1]]] );
-    colorCentroid3[0][1][1][1] =
-        double( colorCenter[cellIndex[idx[0][1][1]]][1] ) / double( colorGridCount[cellIndex[idx[0][1][1]]] );
-    colorCentroid3[0][1][1][2] =
-        double( colorCenter[cellIndex[idx[0][1][1]]][2] ) / double( colorGridCount[cellIndex[idx[0][1][1]]] );
+  if ( colorGridCount[cells[0][1][1]] > 0 ) {
+    colorCentroid3[0][1][1][0] = double( colorCenter[cells[0][1][1]][0] ) / double( colorGridCount[cells[0][1][1]] );
+    colorCentroid3[0][1][1][1] = double( colorCenter[cells[0][1][1]][1] ) / double( colorGridCount[cells[0][1][1]] );
+    colorCentroid3[0][1][1][2] = double( colorCenter[cells[0][1][1]][2] ) / double( colorGridCount[cells[0][1][1]] );
 
     double Y3 = colorCentroid3[0][1][1][0];
 
     if ( abs( Y0 - Y3 ) > yThresh ) { colorCentroid3[0][1][1] = curPosColor; }
-    if ( colorGridCount[cellIndex[idx[0][1][1]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][1][1]]], int( colorGridCount[cellIndex[idx[0][1][1]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][1][1]]], int( colorGridCount[cellIndex[idx[0][1][1]]] ) );
+    if ( colorGridCount[cells[0][1][1]] > 1 ) {
+      double meanY = mean( colorLum[cells[0][1][1]], int( colorGridCount[cells[0][1][1]] ) );
+      double medianY = median( colorLum[cells[0][1][1]], int( colorGridCount[cells[0][1][1]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[0][1][1] = curPosColor; }
     }
   } else {
     colorCentroid3[0][1][1] = curPosColor;
   }
 
-  if ( colorGridCount[cellIndex[idx[1][0][0]]] > 0 ) {
-    colorCentroid3[1][0][0][0] =
-        double( colorCenter[cellIndex[idx[1][0][0]]][0] ) / double( colorGridCount[cellIndex[idx[1][0][0]]] );
-    colorCentroid3[1][0][0][1] =
-        double( colorCenter[cellIndex[idx[1][0][0]]][1] ) / double( colorGridCount[cellIndex[idx[1][0][0]]] );
-    colorCentroid3[1][0][0][2] =
-        double( colorCenter[cellIndex[idx[1][0][0]]][2] ) / double( colorGridCount[cellIndex[idx[1][0][0]]] );
+  if ( colorGridCount[cells[1][0][0]] > 0 ) {
+    colorCentroid3[1][0][0][0] = double( colorCenter[cells[1][0][0]][0] ) / double( colorGridCount[cells[1][0][0]] );
+    colorCentroid3[1][0][0][1] = double( colorCenter[cells[1][0][0]][1] ) / double( colorGridCount[cells[1][0][0]] );
+    colorCentroid3[1][0][0][2] = double( colorCenter[cells[1][0][0]][2] ) / double( colorGridCount[cells[1][0][0]] );
     double Y4 = colorCentroid3[1][0][0][0];
 
     if ( abs( Y0 - Y4 ) > yThresh ) { colorCentroid3[1][0][0] = curPosColor; }
-    if ( colorGridCount[cellIndex[idx[1][0][0]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][0][0]]], int( colorGridCount[cellIndex[idx[1][0][0]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][0][0]]], int( colorGridCount[cellIndex[idx[1][0][0]]] ) );
+    if ( colorGridCount[cells[1][0][0]] > 1 ) {
+      double meanY = mean( colorLum[cells[1][0][0]], int( colorGridCount[cells[1][0][0]] ) );
+      double medianY = median( colorLum[cells[1][0][0]], int( colorGridCount[cells[1][0][0]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][0][0] = curPosColor; }
     }
   } else {
     colorCentroid3[1][0][0] = curPosColor;
   }
 
-  if ( colorGridCount[cellIndex[idx[1][0][1]]] > 0 ) {
-    colorCentroid3[1][0][1][0] =
-        double( colorCenter[cellIndex[idx[1][0][1]]][0] ) / double( colorGridCount[cellIndex[idx[1][0][1]]] );
-    colorCentroid3[1][0][1][1] =
-        double( colorCenter[cellIndex[idx[1][0][1]]][1] ) / double( colorGridCount[cellIndex[idx[1][0][1]]] );
-    colorCentroid3[1][0][1][2] =
-        double( colorCenter[cellIndex[idx[1][0][1]]][2] ) / double( colorGridCount[cellIndex[idx[1][0][1]]] );
+  if ( colorGridCount[cells[1][0][1]] > 0 ) {
+    colorCentroid3[1][0][1][0] = double( colorCenter[cells[1][0][1]][0] ) / double( colorGridCount[cells[1][0][1]] );
+    colorCentroid3[1][0][1][1] = double( colorCenter[cells[1][0][1]][1] ) / double( colorGridCount[cells[1][0][1]] );
+    colorCentroid3[1][0][1][2] = double( colorCenter[cells[1][0][1]][2] ) / double( colorGridCount[cells[1][0][1]] );
     double Y5 = colorCentroid3[1][0][1][0];
 
     if ( abs( Y0 - Y5 ) > yThresh ) { colorCentroid3[1][0][1] = curPosColor; }
-    if ( colorGridCount[cellIndex[idx[1][0][1]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][0][1]]], int( colorGridCount[cellIndex[idx[1][0][1]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][0][1]]], int( colorGridCount[cellIndex[idx[1][0][1]]] ) );
+    if ( colorGridCount[cells[1][0][1]] > 1 ) {
+      double meanY = mean( colorLum[cells[1][0][1]], int( colorGridCount[cells[1][0][1]] ) );
+      double medianY = median( colorLum[cells[1][0][1]], int( colorGridCount[cells[1][0][1]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][0][1] = curPosColor; }
     }
   } else {
     colorCentroid3[1][0][1] = curPosColor;
   }
 
-  if ( colorGridCount[cellIndex[idx[1][1][0]]] > 0 ) {
-    colorCentroid3[1][1][0][0] =
-        double( colorCenter[cellIndex[idx[1][1][0]]][0] ) / double( colorGridCount[cellIndex[idx[1][1][0]]] );
-    colorCentroid3[1][1][0][1] =
-        double( colorCenter[cellIndex[idx[1][1][0]]][1] ) / double( colorGridCount[cellIndex[idx[1][1][0]]] );
-    colorCentroid3[1][1][0][2] =
-        double( colorCenter[cellIndex[idx[1][1][0]]][2] ) / double( colorGridCount[cellIndex[idx[1][1][0]]] );
+  if ( colorGridCount[cells[1][1][0]] > 0 ) {
+    colorCentroid3[1][1][0][0] = double( colorCenter[cells[1][1][0]][0] ) / double( colorGridCount[cells[1][1][0]] );
+    colorCentroid3[1][1][0][1] = double( colorCenter[cells[1][1][0]][1] ) / double( colorGridCount[cells[1][1][0]] );
+    colorCentroid3[1][1][0][2] = double( colorCenter[cells[1][1][0]][2] ) / double( colorGridCount[cells[1][1][0]] );
     double Y6 = colorCentroid3[1][1][0][0];
 
     if ( abs( Y0 - Y6 ) > yThresh ) { colorCentroid3[1][1][0] = curPosColor; }
-    if ( colorGridCount[cellIndex[idx[1][1][0]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][1][0]]], int( colorGridCount[cellIndex[idx[1][1][0]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][1][0]]], int( colorGridCount[cellIndex[idx[1][1][0]]] ) );
+    if ( colorGridCount[cells[1][1][0]] > 1 ) {
+      double meanY = mean( colorLum[cells[1][1][0]], int( colorGridCount[cells[1][1][0]] ) );
+      double medianY = median( colorLum[cells[1][1][0]], int( colorGridCount[cells[1][1][0]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][1][0] = curPosColor; }
     }
   } else {
     colorCentroid3[1][1][0] = curPosColor;
   }
 
-  if ( colorGridCount[cellIndex[idx[1][1][1]]] > 0 ) {
-    colorCentroid3[1][1][1][0] =
-        double( colorCenter[cellIndex[idx[1][1][1]]][0] ) / double( colorGridCount[cellIndex[idx[1][1][1]]] );
-    colorCentroid3[1][1][1][1] =
-        double( colorCenter[cellIndex[idx[1][1][1]]][1] ) / double( colorGridCount[cellIndex[idx[1][1][1]]] );
-    colorCentroid3[1][1][1][2] =
-        double( colorCenter[cellIndex[idx[1][1][1]]][2] ) / double( colorGridCount[cellIndex[idx[1][1][1]]] );
+  if ( colorGridCount[cells[1][1][1]] > 0 ) {
+    colorCentroid3[1][1][1][0] = double( colorCenter[cells[1][1][1]][0] ) / double( colorGridCount[cells[1][1][1]] );
+    colorCentroid3[1][1][1][1] = double( colorCenter[cells[1][1][1]][1] ) / double( colorGridCount[cells[1][1][1]] );
+    colorCentroid3[1][1][1][2] = double( colorCenter[cells[1][1][1]][2] ) / double( colorGridCount[cells[1][1][1]] );
     double Y7 = colorCentroid3[1][1][1][0];
 
     if ( abs( Y0 - Y7 ) > yThresh ) { colorCentroid3[1][1][1] = curPosColor; }
-    if ( colorGridCount[cellIndex[idx[1][1][1]]] > 1 ) {
-      double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][1][1]]], int( colorGridCount[cellIndex[idx[1][1][1]]] ) );
-      double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][1][1]]], int( colorGridCount[cellIndex[idx[1][1][1]]] ) );
+    if ( colorGridCount[cells[1][1][1]] > 1 ) {
+      double meanY = mean( colorLum[cells[1][1][1]], int( colorGridCount[cells[1][1][1]] ) );
+      double medianY = median( colorLum[cells[1][1][1]], int( colorGridCount[cells[1][1][1]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][1][1] = curPosColor; }
     }
   } else {
@@ -1839,53 +1770,61 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
 
 void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                         const GeneratePointCloudParameters& params,
-                                        std::vector<int>&                   cellIndex ) {
+                                        std::vector<uint16_t>&              colorGridCount,
+                                        std::vector<PCCVector3<float>>&     colorCenter,
+                                        std::vector<bool>&                  colorDoSmooth,
+                                        std::vector<std::vector<uint16_t>>& colorLum,
+                                        const PCCGridCellIndex&             cellIndex ) {
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = params.occupancyPrecision_;
   const int    disth      = ( std::max )( gridSize / 2, 1 );
-  for ( int i = 0; i < pointCount; i++ ) {
-    PCCPoint3D curPos    = reconstruct[i];
-    int        x         = curPos.x();
-    int        y         = curPos.y();
-    int        z         = curPos.z();
-    int        pcMaxSize = pow( 2, params.geometryBitDepth3D_ );
-    if ( x < disth || y < disth || z < disth || pcMaxSize <= x + disth || pcMaxSize <= y + disth ||
-         pcMaxSize <= z + disth ) {
-      continue;
-    }
-    PCCVector3D   colorCentroid( 0.0 );
-    int           colorCount             = 0;
-    bool          otherClusterPointCount = false;
-    PCCColor16bit color16bit             = reconstruct.getColor16bit( i );
-    PCCVector3D   curPosColor( 0.0 );
-    curPosColor[0] = double( color16bit[0] );
-    curPosColor[1] = double( color16bit[1] );
-    curPosColor[2] = double( color16bit[2] );
-    if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
-      otherClusterPointCount =
-          gridFilteringColor( curPos, colorCentroid, colorCount, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingDoSmooth_, gridSize, curPosColor, params, cellIndex );
-    }
-    if ( otherClusterPointCount ) {
-      colorCentroid = ( colorCentroid + static_cast<double>( colorCount ) / 2.0 ) / static_cast<double>( colorCount );
-      for ( size_t k = 0; k < 3; ++k ) { colorCentroid[k] = double( int64_t( colorCentroid[k] ) ); }
-      double distToCentroid2 = 0;
+  // the grid is complete: each point only reads it and only updates its own color.
+  tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+      PCCPoint3D curPos    = reconstruct[i];
+      int        x         = curPos.x();
+      int        y         = curPos.y();
+      int        z         = curPos.z();
+      int        pcMaxSize = pow( 2, params.geometryBitDepth3D_ );
+      if ( x < disth || y < disth || z < disth || pcMaxSize <= x + disth || pcMaxSize <= y + disth ||
+           pcMaxSize <= z + disth ) {
+        return;
+      }
+      PCCVector3D   colorCentroid( 0.0 );
+      int           colorCount             = 0;
+      bool          otherClusterPointCount = false;
+      PCCColor16bit color16bit             = reconstruct.getColor16bit( i );
+      PCCVector3D   curPosColor( 0.0 );
+      curPosColor[0] = double( color16bit[0] );
+      curPosColor[1] = double( color16bit[1] );
+      curPosColor[2] = double( color16bit[2] );
+      if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
+        otherClusterPointCount =
+            gridFilteringColor( curPos, colorCentroid, colorCount, colorGridCount, colorCenter, colorDoSmooth, colorLum,
+                                gridSize, curPosColor, params, cellIndex );
+      }
+      if ( otherClusterPointCount ) {
+        colorCentroid = ( colorCentroid + static_cast<double>( colorCount ) / 2.0 ) / static_cast<double>( colorCount );
+        for ( size_t k = 0; k < 3; ++k ) { colorCentroid[k] = double( int64_t( colorCentroid[k] ) ); }
+        double distToCentroid2 = 0;
 
-      double Ycent = colorCentroid[0];
-      double Ycur  = curPosColor[0];
+        double Ycent = colorCentroid[0];
+        double Ycur  = curPosColor[0];
 
-      distToCentroid2 = abs( Ycent - Ycur ) * 10. / 256.;
+        distToCentroid2 = abs( Ycent - Ycur ) * 10. / 256.;
 
-      if ( distToCentroid2 >= params.thresholdColorSmoothing_ ) {
-        PCCColor16bit color16bit;
-        color16bit[0] = uint16_t( colorCentroid[0] );
-        color16bit[1] = uint16_t( colorCentroid[1] );
-        color16bit[2] = uint16_t( colorCentroid[2] );
+        if ( distToCentroid2 >= params.thresholdColorSmoothing_ ) {
+          PCCColor16bit color16bit;
+          color16bit[0] = uint16_t( colorCentroid[0] );
+          color16bit[1] = uint16_t( colorCentroid[1] );
+          color16bit[2] = uint16_t( colorCentroid[2] );
 
-        reconstruct.setColor16bit( i, color16bit );
+          reconstruct.setColor16bit( i, color16bit );
+        }
       }
-    }
-  }
+    } );
+  } );
 }
 
 void PCCCodec::createSpecificLayerReconstruct( const PCCPointSet3&                 reconstruct,
@@ -1903,8 +1842,8 @@ void PCCCodec::createSpecificLayerReconstruct( const PCCPointSet3&
   const size_t pointCount   = reconstruct.getPointCount();
   if ( ( pointCount == 0U ) || !reconstruct.hasColors() ) { return; }
   for ( size_t i = 0; i < pointCount; ++i ) {
-    const PCCVector3<size_t> location = pointToPixel[i];
-    const size_t             f        = location[2];
+    const PCCVector3<uint16_t> location = pointToPixel[i];
+    const size_t               f        = location[2];
     if ( f == frameCount ) {
       subReconstruct.addPoint( reconstruct[i] );
       subPartition.push_back( partition[i] );
@@ -1929,8 +1868,8 @@ void PCCCodec::createSubReconstruct( const PCCPointSet3&                 reconst
   const size_t pointCount   = reconstruct.getPointCount();
   if ( ( pointCount == 0U ) || !reconstruct.hasColors() ) { return; }
   for ( size_t i = 0; i < pointCount; ++i ) {
-    const PCCVector3<size_t> location = pointToPixel[i];
-    const size_t             f        = location[2];
+    const PCCVector3<uint16_t> location = pointToPixel[i];
+    const size_t               f        = location[2];
     if ( f < frameCount ) {
       subReconstruct.addPoint( reconstruct[i] );
       subReconstruct.setType( frameCount, POINT_UNSET );
@@ -2029,10 +1968,10 @@ bool PCCCodec::colorPointCloud( PCCPointSet3&                       reconstruct,
     source.addColors16bit();
     const size_t pcFrameIndex = frame.getIndex() * mapCount;
     for ( size_t i = 0; i < pointCount; ++i ) {
-      const PCCVector3<size_t> location = pointToPixel[i];
-      const size_t             x        = location[0];
-      const size_t             y        = location[1];
-      const size_t             f        = location[2];
+      const PCCVector3<uint16_t> location = pointToPixel[i];
+      const size_t               x        = location[0];
+      const size_t               y        = location[1];
+      const size_t               f        = location[2];
       if ( params.singleMapPixelInterleaving_ ) {
         if ( ( static_cast<int>( f == 0 && ( x + y ) % 2 == 0 ) | static_cast<int>( f == 1 && ( x + y ) % 2 == 1 ) ) !=
              0 ) {
@@ -2189,6 +2128,8 @@ void PCCCodec::generateRawPointsTexturefromVideo( PCCContext& context ) {
   const size_t gofSize               = context.size();
   auto&        videoRawPointsTexture = context.getVideoRawPointsTexture();
   videoRawPointsTexture.resize( gofSize );
+  context.setRawAttWidth( videoRawPointsTexture.getWidth() );
+  context.setRawAttHeight( videoRawPointsTexture.getHeight() );
   TRACE_CODEC( "generateRawPointsTexturefromVideo \n" );
   for ( auto& frame : context.getFrames() ) {
     generateRawPointsTexturefromVideo( context, frame, frame.getIndex() );
@@ -2204,8 +2145,6 @@ void PCCCodec::generateRawPointsTexturefromVideo( PCCContext& context, PCCFrameC
   auto&  image                 = videoRawPointsTexture.getFrame( frameIndex );
   size_t width                 = image.getWidth();
   size_t height                = image.getHeight();
-  context.setRawAttWidth( width );
-  context.setRawAttHeight( height );
   size_t                   numberOfEOMPoints = frame.getTotalNumberOfEOMPoints();
   size_t                   numOfRawGeos      = frame.getTotalNumberOfRawPoints();
   std::vector<PCCColor3B>& mpsTextures       = frame.getRawPointsTextures();
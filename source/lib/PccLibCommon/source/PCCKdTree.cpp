@@ -36,6 +36,7 @@
 #include "PCCKdTree.h"
 
 #include "KDTreeVectorOfVectorsAdaptor.h"
+#include "tbb/tbb.h"
 
 using namespace pcc;
 
@@ -88,3 +89,65 @@ void PCCKdTree::searchRadius( const PCCPoint3D& point,
   }
 }
 #endif
+
+// Calls process( q ) in parallel for the queries of the batch, in the order of the Morton codes of the points relative
+// to their bounding box when mortonOrder is set.
+template <typename Process>
+static void forEachQuery( const PCCPoint3D* points,
+                          const size_t      pointCount,
+                          const bool        mortonOrder,
+                          Process           process ) {
+  if ( !mortonOrder ) {
+    tbb::parallel_for( size_t( 0 ), pointCount, process );
+    return;
+  }
+  PCCPoint3D minPoint( ( std::numeric_limits<PCCType>::max )() );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    for ( int k = 0; k < 3; ++k ) { minPoint[k] = ( std::min )( minPoint[k], points[i][k] ); }
+  }
+  std::vector<std::pair<uint64_t, size_t>> order( pointCount );
+  tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    uint64_t code = 0;
+    for ( int k = 0; k < 3; ++k ) {
+      const auto coord = static_cast<uint64_t>( points[i][k] - minPoint[k] );
+      for ( int b = 0; b < 16; ++b ) { code |= ( ( coord >> b ) & 1 ) << ( 3 * b + 2 - k ); }
+    }
+    order[i] = std::make_pair( code, i );
+  } );
+  tbb::parallel_sort( order.begin(), order.end() );
+  tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) { process( order[i].second ); } );
+}
+
+void PCCKdTree::search( const PCCPoint3D* points,
+                        const size_t      pointCount,
+                        const size_t      num_results,
+                        PCCNNResults&     results,
+                        const bool        mortonOrder ) const {
+  const auto* kdtree = static_cast<KdTreeAdaptor*>( kdtree_ );
+  results.resize( pointCount, num_results );
+  forEachQuery( points, pointCount, mortonOrder, [&]( const size_t q ) {
+    results.count( q ) =
+        kdtree->index->knnSearch( &points[q][0], num_results, results.indices( q ), results.dist( q ) );
+  } );
+}
+
+void PCCKdTree::searchRadius( const PCCPoint3D* points,
+                              const size_t      pointCount,
+                              const size_t      num_results,
+                              const double      radius,
+                              PCCNNResults&     results,
+                              const bool        mortonOrder ) const {
+  const auto* kdtree = static_cast<KdTreeAdaptor*>( kdtree_ );
+  tbb::enumerable_thread_specific<std::vector<std::pair<size_t, double>>> rets;
+  results.resize( pointCount, num_results );
+  forEachQuery( points, pointCount, mortonOrder, [&]( const size_t q ) {
+    auto&                   ret = rets.local();
+    nanoflann::SearchParams params;
+    const size_t            count = kdtree->index->radiusSearch( &points[q][0], radius, ret, params );
+    results.count( q )            = ( std::min )( count, num_results );
+    for ( size_t i = 0; i < results.count( q ); i++ ) {
+      results.indices( q )[i] = ret[i].first;
+      results.dist( q )[i]    = ret[i].second;
+    }
+  } );
+}
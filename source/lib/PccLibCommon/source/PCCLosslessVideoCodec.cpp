@@ -0,0 +1,339 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCLosslessVideoCodec.h"
+#include <tbb/tbb.h>
+
+using namespace pcc;
+
+namespace {
+
+// the probabilities of the bit 0 are stored on 11 bits and adapted by 1/32 of the error after each bit
+const uint32_t probabilityBits = 11;
+const uint16_t probabilityHalf = 1 << ( probabilityBits - 1 );
+const uint32_t adaptationShift = 5;
+const uint32_t rangeTop        = 1 << 24;
+const size_t   activityCount   = 16;
+const size_t   maxLength       = 16;
+
+class PCCRangeEncoder {
+ public:
+  PCCRangeEncoder( std::vector<uint8_t>& data ) :
+      low_( 0 ),
+      range_( 0xFFFFFFFF ),
+      cache_( 0 ),
+      cacheSize_( 1 ),
+      data_( data ) {}
+
+  inline bool code( uint16_t& probability, const bool bit ) {
+    const uint32_t bound = ( range_ >> probabilityBits ) * probability;
+    if ( bit ) {
+      low_ += bound;
+      range_ -= bound;
+      probability -= probability >> adaptationShift;
+    } else {
+      range_ = bound;
+      probability += ( ( 1 << probabilityBits ) - probability ) >> adaptationShift;
+    }
+    while ( range_ < rangeTop ) {
+      range_ <<= 8;
+      shiftLow();
+    }
+    return bit;
+  }
+  template <typename P>
+  inline void reconstruct( P&, const int32_t ) {}
+  void        finish() {
+    for ( size_t i = 0; i < 5; i++ ) { shiftLow(); }
+  }
+
+ private:
+  // the bytes are delayed until the carry of the following ones is known
+  inline void shiftLow() {
+    if ( static_cast<uint32_t>( low_ ) < 0xFF000000 || ( low_ >> 32 ) != 0 ) {
+      const uint8_t carry = static_cast<uint8_t>( low_ >> 32 );
+      uint8_t       byte  = cache_;
+      do {
+        data_.push_back( static_cast<uint8_t>( byte + carry ) );
+        byte = 0xFF;
+      } while ( --cacheSize_ != 0 );
+      cache_ = static_cast<uint8_t>( low_ >> 24 );
+    }
+    cacheSize_++;
+    low_ = ( low_ & 0x00FFFFFF ) << 8;
+  }
+
+  uint64_t              low_;
+  uint32_t              range_;
+  uint8_t               cache_;
+  uint64_t              cacheSize_;
+  std::vector<uint8_t>& data_;
+};
+
+class PCCRangeDecoder {
+ public:
+  PCCRangeDecoder( const uint8_t* data, const size_t size ) :
+      code_( 0 ),
+      range_( 0xFFFFFFFF ),
+      data_( data ),
+      end_( data + size ) {
+    for ( size_t i = 0; i < 5; i++ ) { code_ = ( code_ << 8 ) | nextByte(); }
+  }
+
+  inline bool code( uint16_t& probability, const bool ) {
+    const uint32_t bound = ( range_ >> probabilityBits ) * probability;
+    bool           bit   = code_ >= bound;
+    if ( bit ) {
+      code_ -= bound;
+      range_ -= bound;
+      probability -= probability >> adaptationShift;
+    } else {
+      range_ = bound;
+      probability += ( ( 1 << probabilityBits ) - probability ) >> adaptationShift;
+    }
+    while ( range_ < rangeTop ) {
+      range_ <<= 8;
+      code_ = ( code_ << 8 ) | nextByte();
+    }
+    return bit;
+  }
+  template <typename P>
+  inline void reconstruct( P& sample, const int32_t value ) {
+    sample = static_cast<P>( value );
+  }
+
+ private:
+  inline uint8_t nextByte() { return data_ < end_ ? *data_++ : 0; }
+
+  uint32_t       code_;
+  uint32_t       range_;
+  const uint8_t* data_;
+  const uint8_t* end_;
+};
+
+// the residuals are binarized as a zero flag, a sign and the exponential Golomb code of the magnitude, the contexts
+// of the first bits depend on the activity of the causal neighbourhood
+struct PCCResidualContexts {
+  PCCResidualContexts() {
+    zero_.fill( probabilityHalf );
+    sign_.fill( probabilityHalf );
+    for ( auto& length : length_ ) { length.fill( probabilityHalf ); }
+    for ( auto& bits : bits_ ) { bits.fill( probabilityHalf ); }
+  }
+  std::array<uint16_t, activityCount>                        zero_;
+  std::array<uint16_t, activityCount>                        sign_;
+  std::array<std::array<uint16_t, maxLength>, activityCount> length_;
+  std::array<std::array<uint16_t, maxLength>, maxLength>     bits_;
+};
+
+template <class Coder>
+inline int32_t codeResidual( Coder& coder, PCCResidualContexts& contexts, const size_t activity, int32_t residual ) {
+  if ( !coder.code( contexts.zero_[activity], residual != 0 ) ) { return 0; }
+  const bool     negative  = coder.code( contexts.sign_[activity], residual < 0 );
+  const uint32_t magnitude = static_cast<uint32_t>( std::abs( residual ) );
+  const uint32_t length    = magnitude == 0 ? 0 : floorLog2( magnitude );
+  uint32_t       count     = 0;
+  while ( count < maxLength - 1 && coder.code( contexts.length_[activity][count], count < length ) ) { count++; }
+  uint32_t value = 1;
+  for ( uint32_t bit = count; bit-- > 0; ) {
+    const bool next = coder.code( contexts.bits_[count][bit], ( ( magnitude >> bit ) & 1 ) != 0 );
+    value           = ( value << 1 ) | static_cast<uint32_t>( next );
+  }
+  return negative ? -static_cast<int32_t>( value ) : static_cast<int32_t>( value );
+}
+
+// median edge detector prediction from the samples of the tile only, so that the tiles are independent
+template <class Coder, typename P>
+void codeTile( Coder&       coder,
+               P*           plane,
+               const size_t stride,
+               const size_t x0,
+               const size_t y0,
+               const size_t width,
+               const size_t height ) {
+  PCCResidualContexts contexts;
+  for ( size_t y = y0; y < y0 + height; y++ ) {
+    P* current = plane + y * stride;
+    P* above   = y > y0 ? current - stride : current;
+    for ( size_t x = x0; x < x0 + width; x++ ) {
+      int32_t a = 0, b = 0, c = 0, d = 0;
+      if ( y == y0 ) {
+        a = x > x0 ? current[x - 1] : 0;
+        b = c = d = a;
+      } else {
+        b = above[x];
+        a = x > x0 ? current[x - 1] : b;
+        c = x > x0 ? above[x - 1] : b;
+        d = x + 1 < x0 + width ? above[x + 1] : b;
+      }
+      const int32_t minimum    = ( std::min )( a, b );
+      const int32_t maximum    = ( std::max )( a, b );
+      const int32_t prediction = c >= maximum ? minimum : c <= minimum ? maximum : a + b - c;
+      const size_t  activity   = ( std::min )(
+          static_cast<size_t>( floorLog2( std::abs( a - c ) + std::abs( b - c ) + std::abs( d - b ) + 1 ) ),
+          activityCount - 1 );
+      const int32_t residual =
+          codeResidual( coder, contexts, activity, static_cast<int32_t>( current[x] ) - prediction );
+      coder.reconstruct( current[x], prediction + residual );
+    }
+  }
+}
+
+struct PCCLosslessTile {
+  size_t frame_;
+  size_t channel_;
+  size_t x0_;
+  size_t y0_;
+  size_t width_;
+  size_t height_;
+  size_t stride_;
+};
+
+size_t getTileCount( const size_t         frameCount,
+                     const size_t         width,
+                     const size_t         height,
+                     const PCCCOLORFORMAT format,
+                     const size_t         tileSize ) {
+  size_t tileCount = 0;
+  for ( size_t c = 0; c < 3; c++ ) {
+    const size_t planeWidth  = c > 0 && format == PCCCOLORFORMAT::YUV420 ? width / 2 : width;
+    const size_t planeHeight = c > 0 && format == PCCCOLORFORMAT::YUV420 ? height / 2 : height;
+    tileCount += ( ( planeWidth + tileSize - 1 ) / tileSize ) * ( ( planeHeight + tileSize - 1 ) / tileSize );
+  }
+  return frameCount * tileCount;
+}
+
+std::vector<PCCLosslessTile> getTiles( const size_t         frameCount,
+                                       const size_t         width,
+                                       const size_t         height,
+                                       const PCCCOLORFORMAT format,
+                                       const size_t         tileSize ) {
+  std::vector<PCCLosslessTile> tiles;
+  for ( size_t f = 0; f < frameCount; f++ ) {
+    for ( size_t c = 0; c < 3; c++ ) {
+      const size_t planeWidth  = c > 0 && format == PCCCOLORFORMAT::YUV420 ? width / 2 : width;
+      const size_t planeHeight = c > 0 && format == PCCCOLORFORMAT::YUV420 ? height / 2 : height;
+      for ( size_t y0 = 0; y0 < planeHeight; y0 += tileSize ) {
+        for ( size_t x0 = 0; x0 < planeWidth; x0 += tileSize ) {
+          tiles.push_back( {f, c, x0, y0, ( std::min )( tileSize, planeWidth - x0 ),
+                            ( std::min )( tileSize, planeHeight - y0 ), planeWidth} );
+        }
+      }
+    }
+  }
+  return tiles;
+}
+
+void writeUInt32( std::vector<uint8_t>& bitstream, const size_t value ) {
+  for ( int shift = 24; shift >= 0; shift -= 8 ) { bitstream.push_back( static_cast<uint8_t>( value >> shift ) ); }
+}
+
+uint32_t readUInt32( const uint8_t* bitstream ) {
+  return ( uint32_t( bitstream[0] ) << 24 ) | ( uint32_t( bitstream[1] ) << 16 ) | ( uint32_t( bitstream[2] ) << 8 ) |
+         uint32_t( bitstream[3] );
+}
+
+}  // namespace
+
+// The bitstream is made of the frame count, width, height and color format, followed by the size of each tile and
+// by the tiles, in frame, channel and raster order.
+template <typename T>
+void PCCLosslessVideoCodec<T>::encode( const PCCVideo<T, 3>& video, std::vector<uint8_t>& bitstream ) {
+  const size_t         frameCount = video.getFrameCount();
+  const size_t         width      = video.getWidth();
+  const size_t         height     = video.getHeight();
+  const PCCCOLORFORMAT format     = video.getColorFormat();
+  const auto           tiles      = getTiles( frameCount, width, height, format, tileSize_ );
+
+  std::vector<std::vector<uint8_t>> payloads( tiles.size() );
+  tbb::task_arena                   limited( nbThread_ > 0 ? static_cast<int>( nbThread_ )
+                                                         : static_cast<int>( tbb::task_arena::automatic ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), tiles.size(), [&]( const size_t i ) {
+      const auto&     tile = tiles[i];
+      PCCRangeEncoder encoder( payloads[i] );
+      codeTile( encoder, video.getFrame( tile.frame_ ).getChannel( tile.channel_ ).data(), tile.stride_, tile.x0_,
+                tile.y0_, tile.width_, tile.height_ );
+      encoder.finish();
+    } );
+  } );
+
+  bitstream.clear();
+  writeUInt32( bitstream, frameCount );
+  writeUInt32( bitstream, width );
+  writeUInt32( bitstream, height );
+  writeUInt32( bitstream, static_cast<size_t>( format ) );
+  for ( const auto& payload : payloads ) { writeUInt32( bitstream, payload.size() ); }
+  for ( const auto& payload : payloads ) { bitstream.insert( bitstream.end(), payload.begin(), payload.end() ); }
+}
+
+template <typename T>
+bool PCCLosslessVideoCodec<T>::decode( const uint8_t* bitstream, const size_t size, PCCVideo<T, 3>& video ) {
+  if ( size < 16 ) { return false; }
+  const size_t   frameCount = readUInt32( bitstream );
+  const size_t   width      = readUInt32( bitstream + 4 );
+  const size_t   height     = readUInt32( bitstream + 8 );
+  const uint32_t formatId   = readUInt32( bitstream + 12 );
+  if ( formatId != PCCCOLORFORMAT::RGB444 && formatId != PCCCOLORFORMAT::YUV444 &&
+       formatId != PCCCOLORFORMAT::YUV420 ) {
+    return false;
+  }
+  // the frame sizes are coded on 16 bits in the parameter sets
+  const size_t maxSize = ( std::numeric_limits<uint16_t>::max )();
+  if ( width == 0 || height == 0 || width > maxSize || height > maxSize ) { return false; }
+  const auto format = static_cast<PCCCOLORFORMAT>( formatId );
+  // each tile has its size in the header, which bounds the frame count before the frames are allocated
+  if ( getTileCount( frameCount, width, height, format, tileSize_ ) > ( size - 16 ) / 4 ) { return false; }
+  const auto tiles = getTiles( frameCount, width, height, format, tileSize_ );
+  std::vector<size_t> offsets( tiles.size() + 1, 16 + 4 * tiles.size() );
+  for ( size_t i = 0; i < tiles.size(); i++ ) { offsets[i + 1] = offsets[i] + readUInt32( bitstream + 16 + 4 * i ); }
+  if ( offsets.back() > size ) { return false; }
+
+  video.clear();
+  video.resize( frameCount );
+  for ( auto& frame : video.getFrames() ) { frame.resize( width, height, format ); }
+  tbb::task_arena limited( nbThread_ > 0 ? static_cast<int>( nbThread_ )
+                                         : static_cast<int>( tbb::task_arena::automatic ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), tiles.size(), [&]( const size_t i ) {
+      const auto&     tile = tiles[i];
+      PCCRangeDecoder decoder( bitstream + offsets[i], offsets[i + 1] - offsets[i] );
+      codeTile( decoder, video.getFrame( tile.frame_ ).getChannel( tile.channel_ ).data(), tile.stride_, tile.x0_,
+                tile.y0_, tile.width_, tile.height_ );
+    } );
+  } );
+  return true;
+}
+
+template class pcc::PCCLosslessVideoCodec<uint8_t>;
+template class pcc::PCCLosslessVideoCodec<uint16_t>;
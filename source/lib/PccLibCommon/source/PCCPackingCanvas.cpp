@@ -0,0 +1,159 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCPackingCanvas.h"
+
+using namespace pcc;
+
+void PCCPackingFootprint::initialize( size_t width, size_t height, size_t offset ) {
+  valid_  = true;
+  empty_  = width == 0 || height == 0;
+  offset_ = offset;
+  width_  = empty_ ? 0 : width + 2 * offset;
+  height_ = empty_ ? 0 : height + 2 * offset;
+  stride_ = ( width_ + 63 ) / 64;
+  bits_.assign( stride_ * height_, 0 );
+  firstSet_.assign( height_, width_ );
+}
+
+void PCCPackingFootprint::set( size_t x, size_t y ) {
+  for ( size_t y0 = y; y0 <= y + 2 * offset_; y0++ ) {
+    uint64_t* row = bits_.data() + y0 * stride_;
+    for ( size_t x0 = x; x0 <= x + 2 * offset_; x0++ ) { row[x0 >> 6] |= uint64_t( 1 ) << ( x0 & 63 ); }
+    firstSet_[y0] = ( std::min )( firstSet_[y0], x );
+  }
+}
+
+PCCPackingCanvas::PCCPackingCanvas() : width_( 0 ), height_( 0 ), stride_( 1 ) {}
+
+PCCPackingCanvas::PCCPackingCanvas( size_t width, size_t height ) : width_( 0 ), height_( 0 ), stride_( 1 ) {
+  resize( width, height );
+}
+
+PCCPackingCanvas::~PCCPackingCanvas() {
+  bits_.clear();
+  firstFree_.clear();
+}
+
+void PCCPackingCanvas::resize( size_t width, size_t height ) {
+  const size_t stride = ( width + 63 ) / 64 + 1;
+  if ( stride == stride_ ) {
+    bits_.resize( stride * height, 0 );
+  } else {
+    std::vector<uint64_t> bits( stride * height, 0 );
+    const size_t          copyStride = ( std::min )( stride, stride_ ) - 1;
+    for ( size_t y = 0; y < ( std::min )( height, height_ ); y++ ) {
+      std::copy( bits_.begin() + y * stride_, bits_.begin() + y * stride_ + copyStride, bits.begin() + y * stride );
+    }
+    bits_.swap( bits );
+  }
+  // blocks beyond the new width are cleared to keep the padding word empty.
+  if ( width < width_ ) {
+    for ( size_t y = 0; y < height; y++ ) {
+      uint64_t* row = bits_.data() + y * stride;
+      for ( size_t x = width; x < width_ && x < ( stride - 1 ) * 64; x++ ) {
+        row[x >> 6] &= ~( uint64_t( 1 ) << ( x & 63 ) );
+      }
+    }
+  }
+  stride_ = stride;
+  width_  = width;
+  height_ = height;
+  firstFree_.resize( height_, 0 );
+  for ( size_t y = 0; y < height_; y++ ) {
+    firstFree_[y] = ( std::min )( firstFree_[y], width_ );
+    updateFirstFree( y );
+  }
+}
+
+void PCCPackingCanvas::updateFirstFree( size_t y ) {
+  size_t& x = firstFree_[y];
+  while ( x < width_ && isOccupied( x, y ) ) { x++; }
+}
+
+void PCCPackingCanvas::setOccupied( size_t x, size_t y ) {
+  assert( x < width_ && y < height_ );
+  bits_[y * stride_ + ( x >> 6 )] |= uint64_t( 1 ) << ( x & 63 );
+  if ( x == firstFree_[y] ) { updateFirstFree( y ); }
+}
+
+bool PCCPackingCanvas::checkFit( const PCCPackingFootprint& footprint,
+                                 size_t                     u,
+                                 size_t                     v,
+                                 const Tile&                tile ) const {
+  if ( !footprint.isValid() ) { return false; }
+  if ( footprint.isEmpty() ) { return true; }
+  const size_t offset = footprint.getOffset();
+  if ( u < offset || v < offset ) { return false; }
+  const size_t x0 = u - offset;
+  const size_t y0 = v - offset;
+  if ( x0 + footprint.getWidth() > width_ || y0 + footprint.getHeight() > height_ ) { return false; }
+  if ( tile.minU != -1 ) {
+    if ( x0 < size_t( tile.minU ) || y0 < size_t( tile.minV ) ) { return false; }
+    if ( x0 + footprint.getWidth() - 1 > size_t( tile.maxU ) ) { return false; }
+    if ( y0 + footprint.getHeight() - 1 > size_t( tile.maxV ) ) { return false; }
+  }
+  const size_t word  = x0 >> 6;
+  const size_t shift = x0 & 63;
+  for ( size_t y = 0; y < footprint.getHeight(); y++ ) {
+    if ( footprint.getFirstSet( y ) == footprint.getWidth() ) { continue; }
+    const uint64_t* row  = bits_.data() + ( y0 + y ) * stride_ + word;
+    const uint64_t* mask = footprint.getRow( y );
+    for ( size_t k = 0; k < footprint.getStride(); k++ ) {
+      uint64_t blocks = row[k] >> shift;
+      if ( shift != 0 ) { blocks |= row[k + 1] << ( 64 - shift ); }
+      if ( ( blocks & mask[k] ) != 0 ) { return false; }
+    }
+  }
+  return true;
+}
+
+size_t PCCPackingCanvas::getFirstCandidate( const PCCPackingFootprint& footprint, size_t v ) const {
+  const size_t offset = footprint.getOffset();
+  if ( !footprint.isValid() || footprint.isEmpty() || v < offset ) { return 0; }
+  const size_t y0    = v - offset;
+  size_t       first = 0;
+  for ( size_t y = 0; y < footprint.getHeight() && y0 + y < height_; y++ ) {
+    const size_t firstSet = footprint.getFirstSet( y );
+    if ( firstSet < footprint.getWidth() && firstFree_[y0 + y] > firstSet ) {
+      first = ( std::max )( first, firstFree_[y0 + y] - firstSet );
+    }
+  }
+  return first + offset;
+}
+
+size_t PCCPackingCanvas::getFirstCandidate( const std::vector<PCCPackingFootprint>& footprints, size_t v ) const {
+  size_t first = ( std::numeric_limits<size_t>::max )();
+  for ( const auto& footprint : footprints ) { first = ( std::min )( first, getFirstCandidate( footprint, v ) ); }
+  return footprints.empty() ? 0 : first;
+}
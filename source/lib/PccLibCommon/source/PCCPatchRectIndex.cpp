@@ -0,0 +1,132 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCPatch.h"
+#include "PCCPatchRectIndex.h"
+
+using namespace pcc;
+
+static std::tuple<size_t, size_t, size_t> getBucketKey( const PCCPatch& patch ) {
+  return std::make_tuple( patch.getViewId(), patch.getLodScaleX(), patch.getLodScaleY() );
+}
+
+static bool isEmpty( const PCCPatch& patch ) { return patch.getSizeU() == 0 || patch.getSizeV() == 0; }
+
+PCCPatchRectIndex::PCCPatchRectIndex( const std::vector<PCCPatch>& patches ) : patches_( patches ) {
+  // buckets and bounding boxes of the rectangles, the empty ones can't overlap others
+  std::vector<int> patchBuckets( patches.size() );
+  for ( size_t i = 0; i < patches.size(); i++ ) {
+    const auto& patch  = patches[i];
+    const auto  result = bucketIndices_.insert( std::make_pair( getBucketKey( patch ), int( buckets_.size() ) ) );
+    if ( result.second ) {
+      Bucket bucket{};
+      bucket.minU_ = ( std::numeric_limits<int64_t>::max )();
+      bucket.minV_ = ( std::numeric_limits<int64_t>::max )();
+      bucket.maxU_ = ( std::numeric_limits<int64_t>::min )();
+      bucket.maxV_ = ( std::numeric_limits<int64_t>::min )();
+      buckets_.push_back( bucket );
+    }
+    patchBuckets[i] = result.first->second;
+    auto& bucket    = buckets_[patchBuckets[i]];
+    bucket.size_++;
+    if ( isEmpty( patch ) ) { continue; }
+    bucket.minU_ = ( std::min )( bucket.minU_, int64_t( patch.getU1() ) );
+    bucket.minV_ = ( std::min )( bucket.minV_, int64_t( patch.getV1() ) );
+    bucket.maxU_ = ( std::max )( bucket.maxU_, int64_t( patch.getU1() + patch.getSizeU() ) );
+    bucket.maxV_ = ( std::max )( bucket.maxV_, int64_t( patch.getV1() + patch.getSizeV() ) );
+  }
+  // square cells with about one cell per patch
+  for ( auto& bucket : buckets_ ) {
+    if ( bucket.maxU_ <= bucket.minU_ ) {
+      bucket.cellSize_   = 1;
+      bucket.cellCountU_ = 0;
+      bucket.cellCountV_ = 0;
+      continue;
+    }
+    const int64_t width  = bucket.maxU_ - bucket.minU_;
+    const int64_t height = bucket.maxV_ - bucket.minV_;
+    bucket.cellSize_ =
+        ( std::max )( int64_t( 1 ), int64_t( std::ceil( std::sqrt( double( width ) * height / bucket.size_ ) ) ) );
+    bucket.cellCountU_ = ( width + bucket.cellSize_ - 1 ) / bucket.cellSize_;
+    bucket.cellCountV_ = ( height + bucket.cellSize_ - 1 ) / bucket.cellSize_;
+    bucket.cells_.resize( bucket.cellCountU_ * bucket.cellCountV_ );
+  }
+  // the patches are added in increasing order to the cells they cover
+  for ( size_t i = 0; i < patches.size(); i++ ) {
+    const auto& patch = patches[i];
+    if ( isEmpty( patch ) ) { continue; }
+    auto&         bucket = buckets_[patchBuckets[i]];
+    const int64_t u0     = ( int64_t( patch.getU1() ) - bucket.minU_ ) / bucket.cellSize_;
+    const int64_t v0     = ( int64_t( patch.getV1() ) - bucket.minV_ ) / bucket.cellSize_;
+    const int64_t u1     = ( int64_t( patch.getU1() + patch.getSizeU() ) - 1 - bucket.minU_ ) / bucket.cellSize_;
+    const int64_t v1     = ( int64_t( patch.getV1() + patch.getSizeV() ) - 1 - bucket.minV_ ) / bucket.cellSize_;
+    for ( int64_t v = v0; v <= v1; v++ ) {
+      for ( int64_t u = u0; u <= u1; u++ ) { bucket.cells_[v * bucket.cellCountU_ + u].push_back( i ); }
+    }
+  }
+}
+
+int PCCPatchRectIndex::getBucket( const PCCPatch& patch ) const {
+  const auto it = bucketIndices_.find( getBucketKey( patch ) );
+  return it == bucketIndices_.end() ? -1 : it->second;
+}
+
+void PCCPatchRectIndex::getCandidates( int bucketIndex, const PCCPatch& patch, std::vector<size_t>& candidates ) const {
+  candidates.clear();
+  const auto&   bucket = buckets_[bucketIndex];
+  const int64_t minU   = patch.getU1();
+  const int64_t minV   = patch.getV1();
+  const int64_t maxU   = patch.getU1() + patch.getSizeU();
+  const int64_t maxV   = patch.getV1() + patch.getSizeV();
+  if ( isEmpty( patch ) || maxU <= bucket.minU_ || bucket.maxU_ <= minU || maxV <= bucket.minV_ ||
+       bucket.maxV_ <= minV ) {
+    return;
+  }
+  const int64_t u0 = ( ( std::max )( minU, bucket.minU_ ) - bucket.minU_ ) / bucket.cellSize_;
+  const int64_t v0 = ( ( std::max )( minV, bucket.minV_ ) - bucket.minV_ ) / bucket.cellSize_;
+  const int64_t u1 = ( ( std::min )( maxU, bucket.maxU_ ) - 1 - bucket.minU_ ) / bucket.cellSize_;
+  const int64_t v1 = ( ( std::min )( maxV, bucket.maxV_ ) - 1 - bucket.minV_ ) / bucket.cellSize_;
+  for ( int64_t v = v0; v <= v1; v++ ) {
+    for ( int64_t u = u0; u <= u1; u++ ) {
+      for ( const auto index : bucket.cells_[v * bucket.cellCountU_ + u] ) {
+        const auto& other = patches_[index];
+        if ( int64_t( other.getU1() ) < maxU && minU < int64_t( other.getU1() + other.getSizeU() ) &&
+             int64_t( other.getV1() ) < maxV && minV < int64_t( other.getV1() + other.getSizeV() ) ) {
+          candidates.push_back( index );
+        }
+      }
+    }
+  }
+  std::sort( candidates.begin(), candidates.end() );
+  candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+}
@@ -36,40 +36,101 @@
 #include "PCCMath.h"
 #include "KDTreeVectorOfVectorsAdaptor.h"
 #include "PCCKdTree.h"
+#include "PCCSystem.h"
+#include "tbb/tbb.h"
 #include <numeric>
 
 using namespace pcc;
 
+// Sorts the point indices on the point positions, in (x, y, z) lexicographic order: stable parallel LSD radix sort
+// of the 48-bit keys made of the three 16-bit coordinates, one pass per coordinate. The indices of the points at the
+// same position stay in increasing order.
+static void sortPositions( const std::vector<PCCPoint3D>& positions, std::vector<uint32_t>& order ) {
+  const size_t pointCount  = positions.size();
+  const size_t bucketCount = size_t( 1 ) << 16;
+  const size_t blockCount  = ( std::max )( size_t( 1 ), ( std::min )( pointCount / bucketCount, size_t( 32 ) ) );
+  const size_t blockSize   = ( pointCount + blockCount - 1 ) / blockCount;
+  std::vector<uint32_t> histograms( blockCount * bucketCount );
+  std::vector<uint32_t> sorted( pointCount );
+  order.resize( pointCount );
+  std::iota( order.begin(), order.end(), 0 );
+  for ( int c = 2; c >= 0; --c ) {
+    // signed coordinates are ordered as their biased unsigned values.
+    auto digit = [&]( const uint32_t index ) { return static_cast<uint16_t>( positions[index][c] ) ^ 0x8000U; };
+    tbb::parallel_for( size_t( 0 ), blockCount, [&]( const size_t block ) {
+      uint32_t* histogram = histograms.data() + block * bucketCount;
+      std::fill( histogram, histogram + bucketCount, 0 );
+      const size_t end = ( std::min )( pointCount, ( block + 1 ) * blockSize );
+      for ( size_t k = block * blockSize; k < end; ++k ) { ++histogram[digit( order[k] )]; }
+    } );
+    bool   sameDigit = false;
+    size_t offset    = 0;
+    for ( size_t d = 0; d < bucketCount; ++d ) {
+      const size_t start = offset;
+      for ( size_t block = 0; block < blockCount; ++block ) {
+        const uint32_t count                     = histograms[block * bucketCount + d];
+        histograms[block * bucketCount + d] = static_cast<uint32_t>( offset );
+        offset += count;
+      }
+      sameDigit |= offset - start == pointCount;
+    }
+    if ( sameDigit ) { continue; }
+    tbb::parallel_for( size_t( 0 ), blockCount, [&]( const size_t block ) {
+      uint32_t*    histogram = histograms.data() + block * bucketCount;
+      const size_t end       = ( std::min )( pointCount, ( block + 1 ) * blockSize );
+      for ( size_t k = block * blockSize; k < end; ++k ) { sorted[histogram[digit( order[k] )]++] = order[k]; }
+    } );
+    order.swap( sorted );
+  }
+}
+
+// Calls process( first, last ) on each run [first; last) of the sorted indices sharing the same position.
+template <typename F>
+static void forEachPosition( const std::vector<PCCPoint3D>& positions, const std::vector<uint32_t>& order, F process ) {
+  for ( size_t first = 0, last = 0; first < order.size(); first = last ) {
+    const auto& position = positions[order[first]];
+    for ( last = first + 1; last < order.size() && positions[order[last]] == position; ++last ) {}
+    process( first, last );
+  }
+}
+
+// Integer average of the colors of the points indexed by [first; last).
+template <typename Iterator>
+static PCCColor3B averageColor( const std::vector<PCCColor3B>& colors, Iterator first, Iterator last ) {
+  const size_t count = std::distance( first, last );
+  size_t       r     = 0;
+  size_t       g     = 0;
+  size_t       b     = 0;
+  for ( auto it = first; it != last; ++it ) {
+    r += colors[*it][0];
+    g += colors[*it][1];
+    b += colors[*it][2];
+  }
+  PCCColor3B average;
+  average[0] = r / count;
+  average[1] = g / count;
+  average[2] = b / count;
+  return average;
+}
+
 void PCCPointSet3::removeDuplicate() {
   PCCPointSet3 newPointcloud;
   if ( withColors_ ) { newPointcloud.hasColors(); }
   if ( withReflectances_ ) { newPointcloud.addReflectances(); }
-  std::map<float, std::map<float, std::map<float, size_t>>> eMapA;
-  std::map<float, std::map<float, std::map<float, size_t>>> eMapB;
-  if ( withColors_ ) {
-    for ( size_t i = 0; i < positions_.size(); ++i ) {
-      float x = positions_[i][0];
-      float y = positions_[i][1];
-      float z = positions_[i][2];
-      if ( eMapA.find( x ) != eMapA.end() && eMapA[x].find( y ) != eMapA[x].end() &&
-           eMapA[x][y].find( z ) != eMapA[x][y].end() ) {
-      } else {
-        eMapA[x][y][z] = i;
-        newPointcloud.addPoint( positions_[i], colors_[i] );
-      }
-    }
-  } else {
-    for ( size_t i = 0; i < positions_.size(); ++i ) {
-      float x = positions_[i][0];
-      float y = positions_[i][1];
-      float z = positions_[i][2];
-      if ( eMapA.find( x ) != eMapA.end() && eMapA[x].find( y ) != eMapA[x].end() &&
-           eMapA[x][y].find( z ) != eMapA[x][y].end() ) {
-      } else {
-        eMapA[x][y][z] = i;
-        newPointcloud.addPoint( positions_[i] );
-      }
-    }
+  // the first point of each position is kept, in the point order.
+  std::vector<uint32_t> order;
+  std::vector<bool>     keep( positions_.size(), false );
+  sortPositions( positions_, order );
+  forEachPosition( positions_, order, [&]( size_t first, size_t ) { keep[order[first]] = true; } );
+  size_t count = 0;
+  for ( size_t i = 0; i < positions_.size(); ++i ) { count += keep[i] ? 1 : 0; }
+  if ( withColors_ && count > 0 ) { newPointcloud.addColors(); }
+  newPointcloud.resize( count );
+  for ( size_t i = 0, index = 0; i < positions_.size(); ++i ) {
+    if ( !keep[i] ) { continue; }
+    newPointcloud.positions_[index] = positions_[i];
+    if ( withColors_ ) { newPointcloud.colors_[index] = colors_[i]; }
+    index++;
   }
   positions_.swap( newPointcloud.positions_ );
   colors_.swap( newPointcloud.colors_ );
@@ -109,16 +170,15 @@ void PCCPointSet3::distance( const PCCPointSet3& pointcloud,
   distY = 0.F;
   distU = 0.F;
   distV = 0.F;
-  PCCKdTree   kdtree( pointcloud );
-  PCCNNResult result;
-
+  PCCKdTree    kdtree( pointcloud );
+  PCCNNResults results;
+  kdtree.search( positions_.data(), positions_.size(), 1, results );
   for ( size_t i = 0; i < positions_.size(); ++i ) {
-    kdtree.search( positions_[i], 1, result );
-    distP += result.dist( 0 );
+    distP += results.dist( i )[0];
     float yuvA[3];
     float yuvB[3];
     convertRGBtoYUV_BT709( colors_[i], yuvA );
-    convertRGBtoYUV_BT709( pointcloud.colors_[result.indices( 0 )], yuvB );
+    convertRGBtoYUV_BT709( pointcloud.colors_[results.indices( i )[0]], yuvB );
     distY += pow( yuvA[0] - yuvB[0], 2.F );
     distU += pow( yuvA[1] - yuvB[1], 2.F );
     distV += pow( yuvA[2] - yuvB[2], 2.F );
@@ -131,13 +191,14 @@ void PCCPointSet3::distance( const PCCPointSet3& pointcloud,
 }
 
 void PCCPointSet3::distance( const PCCPointSet3& pointcloud, float& distP ) const {
+  distance( PCCKdTree( pointcloud ), distP );
+}
+
+void PCCPointSet3::distance( const PCCKdTree& kdtree, float& distP ) const {
   distP = 0.F;
-  PCCKdTree   kdtree( pointcloud );
-  PCCNNResult result;
-  for ( const auto& position : positions_ ) {
-    kdtree.search( position, 1, result );
-    distP += result.dist( 0 );
-  }
+  PCCNNResults results;
+  kdtree.search( positions_.data(), positions_.size(), 1, results );
+  for ( size_t i = 0; i < positions_.size(); ++i ) { distP += results.dist( i )[0]; }
   distP /= static_cast<float>( positions_.size() );
 }
 
@@ -174,48 +235,25 @@ void PCCPointSet3::removeDuplicate( PCCPointSet3& newPointcloud, size_t dropDupl
     std::cerr << "Normaled objects can't be modified or reordered \n" << std::endl;
     exit( -1 );
   }
-  std::map<float, std::map<float, std::map<float, std::vector<size_t>>>> map;
-  for ( size_t i = 0; i < positions_.size(); ++i ) {
-    float x = positions_[i][0];
-    float y = positions_[i][1];
-    float z = positions_[i][2];
-    map[x][y][z].push_back( i );
-  }
-  if ( withColors_ ) {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          if ( listIndex.size() == 1 || dropDuplicates == 1 ) {
-            newPointcloud.addPoint( positions_[listIndex[0]], colors_[listIndex[0]] );
-          } else {
-            PCCColor3B average;
-            size_t     r = 0;
-            size_t     g = 0;
-            size_t     b = 0;
-            for ( auto& index : listIndex ) {
-              r += colors_[index][0];
-              g += colors_[index][1];
-              b += colors_[index][2];
-            }
-            average[0] = r / listIndex.size();
-            average[1] = g / listIndex.size();
-            average[2] = b / listIndex.size();
-            newPointcloud.addPoint( positions_[listIndex[0]], average );
-          }
-        }
-      }
-    }
-  } else {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          newPointcloud.addPoint( positions_[listIndex[0]] );
-        }
+  std::vector<uint32_t> order;
+  sortPositions( positions_, order );
+  size_t count = 0;
+  forEachPosition( positions_, order, [&]( size_t, size_t ) { count++; } );
+  const size_t start = newPointcloud.getPointCount();
+  if ( withColors_ && count > 0 ) { newPointcloud.addColors(); }
+  newPointcloud.resize( start + count );
+  size_t index = start;
+  forEachPosition( positions_, order, [&]( size_t first, size_t last ) {
+    newPointcloud.positions_[index] = positions_[order[first]];
+    if ( withColors_ ) {
+      if ( last - first == 1 || dropDuplicates == 1 ) {
+        newPointcloud.colors_[index] = colors_[order[first]];
+      } else {
+        newPointcloud.colors_[index] = averageColor( colors_, order.begin() + first, order.begin() + last );
       }
     }
-  }
+    index++;
+  } );
 }
 
 using UInt = unsigned int;
@@ -260,53 +298,39 @@ void PCCPointSet3::sortColor( std::vector<size_t>& list ) {
 }
 
 void PCCPointSet3::reorder( PCCPointSet3& newPointcloud, bool dropDuplicates ) {
-  std::map<float, std::map<float, std::map<float, std::vector<size_t>>>> map;
-  size_t                                                                 duplicate = 0;
-  for ( size_t i = 0; i < positions_.size(); ++i ) {
-    float x = positions_[i][0];
-    float y = positions_[i][1];
-    float z = positions_[i][2];
-    if ( map.find( x ) != map.end() && map[x].find( y ) != map[x].end() && map[x][y].find( z ) != map[x][y].end() ) {
-      duplicate++;
-    }
-    map[x][y][z].push_back( i );
+  std::vector<uint32_t> order;
+  sortPositions( positions_, order );
+  const bool mergeDuplicates = withColors_ && dropDuplicates;
+  size_t     count           = order.size();
+  if ( mergeDuplicates ) {
+    count = 0;
+    forEachPosition( positions_, order, [&]( size_t, size_t ) { count++; } );
   }
-  if ( withColors_ ) {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          if ( listIndex.size() > 1 ) { sortColor( listIndex ); }
-          if ( dropDuplicates ) {
-            PCCColor3B average;
-            size_t     r = 0;
-            size_t     g = 0;
-            size_t     b = 0;
-            for ( auto& index : listIndex ) {
-              r += colors_[index][0];
-              g += colors_[index][1];
-              b += colors_[index][2];
-            }
-            average[0] = r / listIndex.size();
-            average[1] = g / listIndex.size();
-            average[2] = b / listIndex.size();
-            newPointcloud.addPoint( positions_[listIndex[0]], average );
-          } else {
-            for ( auto& index : listIndex ) { newPointcloud.addPoint( positions_[index], colors_[index] ); }
-          }
-        }
-      }
+  const size_t start = newPointcloud.getPointCount();
+  if ( withColors_ && count > 0 ) { newPointcloud.addColors(); }
+  newPointcloud.resize( start + count );
+  size_t              index = start;
+  std::vector<size_t> listIndex;
+  forEachPosition( positions_, order, [&]( size_t first, size_t last ) {
+    if ( !withColors_ ) {
+      for ( size_t k = first; k < last; ++k ) { newPointcloud.positions_[index++] = positions_[order[k]]; }
+      return;
     }
-  } else {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          for ( auto& index : listIndex ) { newPointcloud.addPoint( positions_[index] ); }
-        }
+    // the points at the same position are ordered on their colors.
+    listIndex.assign( order.begin() + first, order.begin() + last );
+    if ( listIndex.size() > 1 ) { sortColor( listIndex ); }
+    if ( mergeDuplicates ) {
+      newPointcloud.positions_[index] = positions_[listIndex[0]];
+      newPointcloud.colors_[index]    = averageColor( colors_, listIndex.begin(), listIndex.end() );
+      index++;
+    } else {
+      for ( auto& k : listIndex ) {
+        newPointcloud.positions_[index] = positions_[k];
+        newPointcloud.colors_[index]    = colors_[k];
+        index++;
       }
     }
-  }
+  } );
 }
 
 void PCCPointSet3::reorder() {
@@ -441,51 +465,150 @@ bool PCCPointSet3::write( const std::string& fileName, const bool asAscii ) {
   fout.close();
   return true;
 }
-bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
-  std::ifstream ifs( fileName, std::ifstream::in );
-  if ( !ifs.is_open() ) { return false; }
-  enum AttributeType {
-    ATTRIBUTE_TYPE_FLOAT64 = 0,
-    ATTRIBUTE_TYPE_FLOAT32 = 1,
-    ATTRIBUTE_TYPE_UINT64  = 2,
-    ATTRIBUTE_TYPE_UINT32  = 3,
-    ATTRIBUTE_TYPE_UINT16  = 4,
-    ATTRIBUTE_TYPE_UINT8   = 5,
-    ATTRIBUTE_TYPE_INT64   = 6,
-    ATTRIBUTE_TYPE_INT32   = 7,
-    ATTRIBUTE_TYPE_INT16   = 8,
-    ATTRIBUTE_TYPE_INT8    = 9,
-  };
-  struct AttributeInfo {
-    std::string   name;
-    AttributeType type;
-    size_t        byteCount;
-  };
+// Vertex property of a PLY file: the binary payload is decoded one property at a time, with a strided loop over the
+// memory mapped vertices.
+enum PLYPropertyType {
+  PLY_PROPERTY_TYPE_FLOAT64 = 0,
+  PLY_PROPERTY_TYPE_FLOAT32 = 1,
+  PLY_PROPERTY_TYPE_UINT64  = 2,
+  PLY_PROPERTY_TYPE_UINT32  = 3,
+  PLY_PROPERTY_TYPE_UINT16  = 4,
+  PLY_PROPERTY_TYPE_UINT8   = 5,
+  PLY_PROPERTY_TYPE_INT64   = 6,
+  PLY_PROPERTY_TYPE_INT32   = 7,
+  PLY_PROPERTY_TYPE_INT16   = 8,
+  PLY_PROPERTY_TYPE_INT8    = 9,
+  PLY_PROPERTY_TYPE_UNKNOWN = 10
+};
+struct PLYProperty {
+  std::string     name;
+  PLYPropertyType type;
+  size_t          byteCount;
+  size_t          offset;
+};
+
+template <typename T, typename F>
+static void decodePLYProperty( const char* data, const size_t stride, const size_t count, F& store ) {
+  for ( size_t i = 0; i < count; ++i, data += stride ) {
+    T value;
+    memcpy( &value, data, sizeof( T ) );
+    store( i, value );
+  }
+}
+
+template <typename F>
+static void decodePLYProperty( const PLYProperty& property,
+                               const char*        data,
+                               const size_t       stride,
+                               const size_t       count,
+                               F                  store ) {
+  data += property.offset;
+  switch ( property.type ) {
+    case PLY_PROPERTY_TYPE_FLOAT64: decodePLYProperty<double>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_FLOAT32: decodePLYProperty<float>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_UINT64: decodePLYProperty<uint64_t>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_UINT32: decodePLYProperty<uint32_t>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_UINT16: decodePLYProperty<uint16_t>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_UINT8: decodePLYProperty<uint8_t>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_INT64: decodePLYProperty<int64_t>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_INT32: decodePLYProperty<int32_t>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_INT16: decodePLYProperty<int16_t>( data, stride, count, store ); break;
+    case PLY_PROPERTY_TYPE_INT8: decodePLYProperty<int8_t>( data, stride, count, store ); break;
+    default: break;
+  }
+}
 
-  std::vector<AttributeInfo> attributesInfo;
-  attributesInfo.reserve( 16 );
-  const size_t             MAX_BUFFER_SIZE = 4096;
-  char                     tmp[MAX_BUFFER_SIZE];
+static inline bool isPLYSeparator( const char c ) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Parses the ASCII number starting at str without allocation. Decimal values with at most 15 significant digits and
+// a power of ten exponent in [-22;22] are exactly represented by the mantissa and the power of ten, the result of
+// the single multiplication or division is then correctly rounded. The other values fall back to strtod().
+static const char* parsePLYValue( const char* str, const char* end, double& value ) {
+  static const double powersOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  const char* cur      = str;
+  const bool  negative = cur < end && *cur == '-';
+  if ( cur < end && ( *cur == '-' || *cur == '+' ) ) { ++cur; }
+  uint64_t mantissa  = 0;
+  int      digits    = 0;
+  int      exponent  = 0;
+  bool     hasDigits = false;
+  for ( ; cur < end && *cur >= '0' && *cur <= '9'; ++cur ) {
+    mantissa  = mantissa * 10 + ( *cur - '0' );
+    digits    = mantissa != 0 ? digits + 1 : 0;
+    hasDigits = true;
+  }
+  if ( cur < end && *cur == '.' ) {
+    for ( ++cur; cur < end && *cur >= '0' && *cur <= '9'; ++cur ) {
+      mantissa  = mantissa * 10 + ( *cur - '0' );
+      digits    = mantissa != 0 ? digits + 1 : 0;
+      hasDigits = true;
+      exponent--;
+    }
+  }
+  bool fastPath = hasDigits && digits <= 15;
+  if ( fastPath && cur < end && ( *cur == 'e' || *cur == 'E' ) ) {
+    const char* exp         = cur + 1;
+    const bool  negativeExp = exp < end && *exp == '-';
+    if ( exp < end && ( *exp == '-' || *exp == '+' ) ) { ++exp; }
+    int e = 0;
+    for ( ; exp < end && *exp >= '0' && *exp <= '9' && e < 1000; ++exp ) { e = e * 10 + ( *exp - '0' ); }
+    fastPath = exp != cur + 1 && ( exp < end ? *exp < '0' || *exp > '9' : true );
+    exponent += negativeExp ? -e : e;
+    cur = exp;
+  }
+  if ( fastPath && exponent >= -22 && exponent <= 22 ) {
+    value = exponent < 0 ? static_cast<double>( mantissa ) / powersOf10[-exponent]
+                         : static_cast<double>( mantissa ) * powersOf10[exponent];
+    if ( negative ) { value = -value; }
+    return cur;
+  }
+  char   buffer[128];
+  size_t length = 0;
+  for ( cur = str; cur < end && !isPLYSeparator( *cur ) && *cur != '\n' && length + 1 < sizeof( buffer ); ++cur ) {
+    buffer[length++] = *cur;
+  }
+  buffer[length] = '\0';
+  char* parsed   = nullptr;
+  value          = strtod( buffer, &parsed );
+  return parsed == buffer ? nullptr : str + ( parsed - buffer );
+}
+
+bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
+  PCCMemoryMappedFile file;
+  if ( !file.open( fileName ) ) { return false; }
+  const char*              cur = file.data();
+  const char*              end = file.data() + file.size();
   const char*              sep = " \t\r";
   std::vector<std::string> tokens;
+  std::string              line;
+
+  auto getLine = [&]() {
+    const char* eol = static_cast<const char*>( memchr( cur, '\n', end - cur ) );
+    if ( eol == nullptr ) { return false; }
+    line.assign( cur, eol );
+    cur = eol + 1;
+    getTokens( line.c_str(), sep, tokens );
+    return true;
+  };
 
-  ifs.getline( tmp, MAX_BUFFER_SIZE );
-  getTokens( tmp, sep, tokens );
-  if ( tokens.empty() || tokens[0] != "ply" ) {
+  std::vector<PLYProperty> properties;
+  properties.reserve( 16 );
+  if ( !getLine() || tokens.empty() || tokens[0] != "ply" ) {
     std::cout << "Error: corrupted file!" << std::endl;
     return false;
   }
   bool   isAscii          = false;
   double version          = 1.0;
   size_t pointCount       = 0;
+  size_t stride           = 0;
   bool   isVertexProperty = true;
   while ( true ) {
-    if ( ifs.eof() ) {
+    if ( !getLine() ) {
       std::cout << "Error: corrupted header!" << std::endl;
       return false;
     }
-    ifs.getline( tmp, MAX_BUFFER_SIZE );
-    getTokens( tmp, sep, tokens );
     if ( tokens.empty() || tokens[0] == "comment" ) { continue; }
     if ( tokens[0] == "format" ) {
       if ( tokens.size() != 3 ) {
@@ -509,43 +632,45 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
         std::cout << "Error: corrupted property info!" << std::endl;
         return false;
       }
-      const std::string& propertyType   = tokens[1];
-      const std::string& propertyName   = tokens[2];
-      const size_t       attributeIndex = attributesInfo.size();
-      attributesInfo.resize( attributeIndex + 1 );
-      AttributeInfo& attributeInfo = attributesInfo[attributeIndex];
-      attributeInfo.name           = propertyName;
-      if ( propertyType == "float64" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_FLOAT64;
-        attributeInfo.byteCount = 8;
+      const std::string& propertyType = tokens[1];
+      PLYProperty        property;
+      property.name      = tokens[2];
+      property.type      = PLY_PROPERTY_TYPE_UNKNOWN;
+      property.byteCount = 0;
+      property.offset    = stride;
+      if ( propertyType == "float64" || propertyType == "double" ) {
+        property.type      = PLY_PROPERTY_TYPE_FLOAT64;
+        property.byteCount = 8;
       } else if ( propertyType == "float" || propertyType == "float32" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_FLOAT32;
-        attributeInfo.byteCount = 4;
+        property.type      = PLY_PROPERTY_TYPE_FLOAT32;
+        property.byteCount = 4;
       } else if ( propertyType == "uint64" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT64;
-        attributeInfo.byteCount = 8;
-      } else if ( propertyType == "uint32" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT32;
-        attributeInfo.byteCount = 4;
-      } else if ( propertyType == "uint16" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT16;
-        attributeInfo.byteCount = 2;
+        property.type      = PLY_PROPERTY_TYPE_UINT64;
+        property.byteCount = 8;
+      } else if ( propertyType == "uint32" || propertyType == "uint" ) {
+        property.type      = PLY_PROPERTY_TYPE_UINT32;
+        property.byteCount = 4;
+      } else if ( propertyType == "uint16" || propertyType == "ushort" ) {
+        property.type      = PLY_PROPERTY_TYPE_UINT16;
+        property.byteCount = 2;
       } else if ( propertyType == "uchar" || propertyType == "uint8" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT8;
-        attributeInfo.byteCount = 1;
+        property.type      = PLY_PROPERTY_TYPE_UINT8;
+        property.byteCount = 1;
       } else if ( propertyType == "int64" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT64;
-        attributeInfo.byteCount = 8;
-      } else if ( propertyType == "int32" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT32;
-        attributeInfo.byteCount = 4;
-      } else if ( propertyType == "int16" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT16;
-        attributeInfo.byteCount = 2;
+        property.type      = PLY_PROPERTY_TYPE_INT64;
+        property.byteCount = 8;
+      } else if ( propertyType == "int32" || propertyType == "int" ) {
+        property.type      = PLY_PROPERTY_TYPE_INT32;
+        property.byteCount = 4;
+      } else if ( propertyType == "int16" || propertyType == "short" ) {
+        property.type      = PLY_PROPERTY_TYPE_INT16;
+        property.byteCount = 2;
       } else if ( propertyType == "char" || propertyType == "int8" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT8;
-        attributeInfo.byteCount = 1;
+        property.type      = PLY_PROPERTY_TYPE_INT8;
+        property.byteCount = 1;
       }
+      stride += property.byteCount;
+      properties.push_back( property );
     } else if ( tokens[0] == "end_header" ) {
       break;
     }
@@ -565,29 +690,31 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
   size_t       indexNX          = PCC_UNDEFINED_INDEX;
   size_t       indexNY          = PCC_UNDEFINED_INDEX;
   size_t       indexNZ          = PCC_UNDEFINED_INDEX;
-  const size_t attributeCount   = attributesInfo.size();
+  const size_t attributeCount   = properties.size();
   for ( size_t a = 0; a < attributeCount; ++a ) {
-    const auto& attributeInfo = attributesInfo[a];
-    if ( attributeInfo.name == "x" && ( attributeInfo.byteCount == 8 || attributeInfo.byteCount == 4 ) ) {
+    const auto& property = properties[a];
+    const bool  isFloat  = property.type == PLY_PROPERTY_TYPE_FLOAT64 || property.type == PLY_PROPERTY_TYPE_FLOAT32;
+    if ( property.type == PLY_PROPERTY_TYPE_UNKNOWN ) {
+      continue;
+    } else if ( property.name == "x" ) {
       indexX = a;
-    } else if ( attributeInfo.name == "y" && ( attributeInfo.byteCount == 8 || attributeInfo.byteCount == 4 ) ) {
+    } else if ( property.name == "y" ) {
       indexY = a;
-    } else if ( attributeInfo.name == "z" && ( attributeInfo.byteCount == 8 || attributeInfo.byteCount == 4 ) ) {
+    } else if ( property.name == "z" ) {
       indexZ = a;
-    } else if ( attributeInfo.name == "red" && attributeInfo.byteCount == 1 ) {
+    } else if ( property.name == "red" && property.byteCount == 1 ) {
       indexR = a;
-    } else if ( attributeInfo.name == "green" && attributeInfo.byteCount == 1 ) {
+    } else if ( property.name == "green" && property.byteCount == 1 ) {
       indexG = a;
-    } else if ( attributeInfo.name == "blue" && attributeInfo.byteCount == 1 ) {
+    } else if ( property.name == "blue" && property.byteCount == 1 ) {
       indexB = a;
-    } else if ( attributeInfo.name == "nx" && attributeInfo.byteCount == 4 && readNormals ) {
+    } else if ( property.name == "nx" && isFloat && readNormals ) {
       indexNX = a;
-    } else if ( attributeInfo.name == "ny" && attributeInfo.byteCount == 4 && readNormals ) {
+    } else if ( property.name == "ny" && isFloat && readNormals ) {
       indexNY = a;
-    } else if ( attributeInfo.name == "nz" && attributeInfo.byteCount == 4 && readNormals ) {
+    } else if ( property.name == "nz" && isFloat && readNormals ) {
       indexNZ = a;
-    } else if ( ( attributeInfo.name == "reflectance" || attributeInfo.name == "refc" ) &&
-                attributeInfo.byteCount <= 2 ) {
+    } else if ( ( property.name == "reflectance" || property.name == "refc" ) && property.byteCount <= 2 ) {
       indexReflectance = a;
     }
   }
@@ -600,121 +727,69 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
   withNormals_ = indexNX != PCC_UNDEFINED_INDEX && indexNY != PCC_UNDEFINED_INDEX && indexNZ != PCC_UNDEFINED_INDEX;
   resize( pointCount );
   if ( isAscii ) {
-    size_t pointCounter = 0;
-    while ( !ifs.eof() && pointCounter < pointCount ) {
-      ifs.getline( tmp, MAX_BUFFER_SIZE );
-      getTokens( tmp, sep, tokens );
-      if ( tokens.empty() ) { continue; }
-      if ( tokens.size() < attributeCount ) { return false; }
+    std::vector<double> values( attributeCount );
+    size_t              pointCounter = 0;
+    while ( cur < end && pointCounter < pointCount ) {
+      size_t valueCount = 0;
+      while ( cur < end && *cur != '\n' ) {
+        if ( isPLYSeparator( *cur ) ) {
+          ++cur;
+          continue;
+        }
+        double      value = 0.;
+        const char* next  = parsePLYValue( cur, end, value );
+        if ( valueCount < attributeCount ) { values[valueCount] = next == nullptr ? 0. : value; }
+        valueCount++;
+        for ( cur = next == nullptr ? cur : next; cur < end && !isPLYSeparator( *cur ) && *cur != '\n'; ++cur ) {}
+      }
+      if ( cur < end ) { ++cur; }
+      if ( valueCount == 0 ) { continue; }
+      if ( valueCount < attributeCount ) { return false; }
       auto& position = positions_[pointCounter];
-      position[0]    = atof( tokens[indexX].c_str() );
-      position[1]    = atof( tokens[indexY].c_str() );
-      position[2]    = atof( tokens[indexZ].c_str() );
+      position[0]    = static_cast<int16_t>( values[indexX] );
+      position[1]    = static_cast<int16_t>( values[indexY] );
+      position[2]    = static_cast<int16_t>( values[indexZ] );
       if ( hasColors() ) {
         auto& color = colors_[pointCounter];
-        color[0]    = atoi( tokens[indexR].c_str() );
-        color[1]    = atoi( tokens[indexG].c_str() );
-        color[2]    = atoi( tokens[indexB].c_str() );
+        color[0]    = static_cast<uint8_t>( static_cast<int>( values[indexR] ) );
+        color[1]    = static_cast<uint8_t>( static_cast<int>( values[indexG] ) );
+        color[2]    = static_cast<uint8_t>( static_cast<int>( values[indexB] ) );
+      }
+      if ( hasReflectances() ) {
+        reflectances_[pointCounter] = static_cast<uint16_t>( static_cast<int>( values[indexReflectance] ) );
+      }
+      if ( hasNormals() ) {
+        auto& normal = normals_[pointCounter];
+        normal[0]    = values[indexNX];
+        normal[1]    = values[indexNY];
+        normal[2]    = values[indexNZ];
       }
-      if ( hasReflectances() ) { reflectances_[pointCounter] = uint16_t( atoi( tokens[indexReflectance].c_str() ) ); }
       ++pointCounter;
     }
   } else {
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, MAX_BUFFER_SIZE );
-    char* str       = strstr( tmp, "end_header" );
-    str             = strstr( str, "\n" );
-    int headerCount = str - tmp + 1;
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, headerCount );
-    for ( size_t pointCounter = 0; pointCounter < pointCount && !ifs.eof(); ++pointCounter ) {
-      auto& position = positions_[pointCounter];
-      for ( size_t a = 0; a < attributeCount && !ifs.eof(); ++a ) {
-        const auto& attributeInfo = attributesInfo[a];
-        if ( a == indexX ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( float ) );
-            position[0] = x;
-          } else {
-            double x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( double ) );
-            position[0] = x;
-          }
-        } else if ( a == indexY ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( float ) );
-            position[1] = y;
-          } else {
-            double y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( double ) );
-            position[1] = y;
-          }
-        } else if ( a == indexZ ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( float ) );
-            position[2] = z;
-          } else {
-            double z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( double ) );
-            position[2] = z;
-          }
-        } else if ( a == indexR && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[0] ), sizeof( uint8_t ) );
-        } else if ( a == indexG && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[1] ), sizeof( uint8_t ) );
-        } else if ( a == indexB && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[2] ), sizeof( uint8_t ) );
-        } else if ( a == indexNX ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( float ) );
-            normals_[pointCounter][0] = nx;
-          } else {
-            double nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( double ) );
-            normals_[pointCounter][0] = nx;
-          }
-        } else if ( a == indexNY ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( float ) );
-            normals_[pointCounter][1] = ny;
-          } else {
-            double ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( double ) );
-            normals_[pointCounter][1] = ny;
-          }
-        } else if ( a == indexNZ ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( float ) );
-            normals_[pointCounter][2] = nz;
-          } else {
-            double nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( double ) );
-            normals_[pointCounter][2] = nz;
-          }
-        } else if ( a == indexReflectance && attributeInfo.byteCount <= 2 ) {
-          if ( indexReflectance == 1 ) {
-            uint8_t reflectance;
-            ifs.read( reinterpret_cast<char*>( &reflectance ), sizeof( uint8_t ) );
-            reflectances_[pointCounter] = reflectance;
-          } else {
-            auto& reflectance = reflectances_[pointCounter];
-            ifs.read( reinterpret_cast<char*>( reflectance ), sizeof( uint16_t ) );
-          }
-        } else {
-          char buffer[128];
-          ifs.read( buffer, attributeInfo.byteCount );
-        }
+    // the vertices are the first element of the payload; a truncated file only fills its complete vertices.
+    const size_t count = stride == 0 ? 0 : ( std::min )( pointCount, static_cast<size_t>( end - cur ) / stride );
+    for ( size_t c = 0; c < 3; ++c ) {
+      const size_t index = c == 0 ? indexX : c == 1 ? indexY : indexZ;
+      decodePLYProperty( properties[index], cur, stride, count,
+                         [&]( size_t i, auto value ) { positions_[i][c] = static_cast<int16_t>( value ); } );
+    }
+    if ( hasColors() ) {
+      for ( size_t c = 0; c < 3; ++c ) {
+        const size_t index = c == 0 ? indexR : c == 1 ? indexG : indexB;
+        decodePLYProperty( properties[index], cur, stride, count,
+                           [&]( size_t i, auto value ) { colors_[i][c] = static_cast<uint8_t>( value ); } );
+      }
+    }
+    if ( hasReflectances() ) {
+      decodePLYProperty( properties[indexReflectance], cur, stride, count,
+                         [&]( size_t i, auto value ) { reflectances_[i] = static_cast<uint16_t>( value ); } );
+    }
+    if ( hasNormals() ) {
+      for ( size_t c = 0; c < 3; ++c ) {
+        const size_t index = c == 0 ? indexNX : c == 1 ? indexNY : indexNZ;
+        decodePLYProperty( properties[index], cur, stride, count,
+                           [&]( size_t i, auto value ) { normals_[i][c] = static_cast<double>( value ); } );
       }
     }
   }
@@ -769,6 +844,37 @@ void PCCPointSet3::convertYUVToRGB() {  // BT709
   }
 }
 
+// Gathers for each target point the contributions make( index, targetIndex, dist ) of the source points having it
+// among their numNeighbors nearest neighbors, within maxDist2 and accepted by keep( index, targetIndex ). The source
+// points are searched in parallel blocks merged in block order, so each list is in the source point order.
+template <typename T, typename K, typename M>
+static void gatherBackwardNeighbors( const PCCPointSet3&          source,
+                                     const PCCKdTree&             kdtreeTarget,
+                                     const size_t                 numNeighbors,
+                                     const double                 maxDist2,
+                                     std::vector<std::vector<T>>& lists,
+                                     K                            keep,
+                                     M                            make ) {
+  const size_t                                   blockSize  = 4096;
+  const size_t                                   pointCount = source.getPointCount();
+  std::vector<std::vector<std::pair<size_t, T>>> blocks( ( pointCount + blockSize - 1 ) / blockSize );
+  tbb::parallel_for( size_t( 0 ), blocks.size(), [&]( const size_t block ) {
+    PCCNNResult result;
+    for ( size_t index = block * blockSize; index < ( std::min )( pointCount, ( block + 1 ) * blockSize ); ++index ) {
+      kdtreeTarget.search( source[index], numNeighbors, result );
+      for ( size_t i = 0; i < result.count(); ++i ) {
+        const size_t targetIndex = result.indices( i );
+        if ( result.dist( i ) <= maxDist2 && keep( index, targetIndex ) ) {
+          blocks[block].emplace_back( targetIndex, make( index, targetIndex, result.dist( i ) ) );
+        }
+      }
+    }
+  } );
+  for ( auto& block : blocks ) {
+    for ( auto& contribution : block ) { lists[contribution.first].push_back( contribution.second ); }
+  }
+}
+
 bool PCCPointSet3::transferColors( PCCPointSet3& target,
                                    const int32_t searchRange,
                                    const bool    losslessTexture,
@@ -806,8 +912,9 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::enumerable_thread_specific<PCCNNResult> results;
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    auto& result = results.local();
     kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
     // keep the points that satisfy geometry dist threshold
     while ( true ) {
@@ -895,7 +1002,7 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -910,24 +1017,19 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   };
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   refinedColorsDists2.resize( pointCountTarget );
-  // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.count(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-      }
-    }
-  }
+  // populate refinedColorsDists2 with the points that satisfy geometry dist threshold
+  gatherBackwardNeighbors( source, kdtreeTarget, numNeighborsColorTransferBwd, maxGeometryDist2Bwd, refinedColorsDists2,
+                           []( size_t, size_t ) { return true; },
+                           [&]( size_t index, size_t, double dist ) {
+                             return DistColor{dist, source.getColor( index )};
+                           } );
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  } );
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
     auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
                                                                  // derived in backward
@@ -1091,7 +1193,7 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
         target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1127,28 +1229,24 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
   maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
   maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
-  PCCPointSet3 partSource;
+  PCCPointSet3                     partSource;
+  std::vector<std::vector<size_t>> partSourceIndices( filterType == 1 ? pointCountTarget : 0 );
   partSource.addColors();
   // ==========================================================================================
   //                                     Forward direction
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::enumerable_thread_specific<PCCNNResult>              results;
+  tbb::enumerable_thread_specific<std::vector<PCCVector3D>> colorBuffers;
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    auto& result = results.local();
+    auto& colors = colorBuffers.local();
     PCCColor16bit colorT16bit = target.getColor16bit( index );
     for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
     if ( target.getBoundaryPointType( index ) == 3 ) {
       kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      if ( filterType == 1 ) {
-        for ( size_t rI = 0; rI < result.count(); rI++ ) {
-          auto indexInSource = result.indices( rI );
-          auto partIndex2    = partSource.addPoint( source[indexInSource] );
-          partSource.setColor( partIndex2, source.getColor( indexInSource ) );
-          partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
-          partSource.setParentPointIndex( partIndex2, indexInSource );
-        }
-      }
+      if ( filterType == 1 ) { partSourceIndices[index].assign( result.indices(), result.indices() + result.count() ); }
       // keep the points that satisfy geometry dist threshold
       while ( true ) {
         if ( result.count() == 1 ) { break; }
@@ -1172,8 +1270,6 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
             isDone                = true;
           }
           if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
             colors.resize( nNN );
             for ( int i = 0; i < nNN; ++i ) {
               for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
@@ -1238,6 +1334,15 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
         }
       }
     }
+  } );
+  // the neighbors of the boundary points are added to partSource in the target point order.
+  for ( const auto& indices : partSourceIndices ) {
+    for ( auto indexInSource : indices ) {
+      auto partIndex2 = partSource.addPoint( source[indexInSource] );
+      partSource.setColor( partIndex2, source.getColor( indexInSource ) );
+      partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
+      partSource.setParentPointIndex( partIndex2, indexInSource );
+    }
   }
   // ==========================================================================================
   //                                  Backward direction
@@ -1257,50 +1362,43 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   if ( filterType == 1 ) {
     refinedColorsDists2.resize( pointCountTarget );
-    // populate refinedColorsDists2
-    auto sampleSetPointCount = partSource.getPointCount();
-    for ( size_t index = 0; index < sampleSetPointCount; ++index ) {
-      const PCCColor16bit color = partSource.getColor16bit( index );
-      kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 )
-            refinedColorsDists2[result.indices( i )].push_back( DistColor{
-                result.dist( i ), color, target[result.indices( i )], partSource.getParentPointIndex( index ), index} );
-        }
-      }
-    }
+    // populate refinedColorsDists2 with the points that satisfy geometry dist threshold and have a close color
+    gatherBackwardNeighbors(
+        partSource, kdtreeTarget, numNeighborsColorTransferBwd, maxGeometryDist2Bwd, refinedColorsDists2,
+        [&]( size_t index, size_t targetIndex ) {
+          const PCCColor16bit color = partSource.getColor16bit( index );
+          return std::abs( color[0] - target.getColor16bit()[targetIndex][0] ) < 40 &&
+                 std::abs( color[1] - target.getColor16bit()[targetIndex][1] ) < 40 &&
+                 std::abs( color[2] - target.getColor16bit()[targetIndex][2] ) < 40;
+        },
+        [&]( size_t index, size_t targetIndex, double dist ) {
+          return DistColor{dist, partSource.getColor16bit( index ), target[targetIndex],
+                           partSource.getParentPointIndex( index ), index};
+        } );
 
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
+    tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
       std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                  []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    } );
   } else {
-    // populate refinedColorsDists2
+    // populate refinedColorsDists2 with the points that satisfy geometry dist threshold
     refinedColorsDists2.resize( pointCountTarget );
-    for ( size_t index = 0; index < pointCountSource; ++index ) {
-      const PCCColor16bit color = source.getColor16bit( index );
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-        }
-      }
-    }
+    gatherBackwardNeighbors( source, kdtreeTarget, numNeighborsColorTransferBwd, maxGeometryDist2Bwd,
+                             refinedColorsDists2, []( size_t, size_t ) { return true; },
+                             [&]( size_t index, size_t, double dist ) {
+                               // the point and the indices, only set by the boundary filter, are value-initialized
+                               return DistColor{dist, source.getColor16bit( index )};
+                             } );
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
+    tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
       std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                  []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    } );
   }
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) return;
     const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
     auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
                                                                     // derived in backward
@@ -1464,7 +1562,7 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
         target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1505,8 +1603,9 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::enumerable_thread_specific<PCCNNResult> results;
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    auto& result = results.local();
     kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
     // keep the points that satisfy geometry dist threshold
     while ( true ) {
@@ -1596,7 +1695,7 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -1611,24 +1710,19 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   };
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   refinedColorsDists2.resize( pointCountTarget );
-  // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor16bit color = source.getColor16bit( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.count(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-      }
-    }
-  }
+  // populate refinedColorsDists2 with the points that satisfy geometry dist threshold
+  gatherBackwardNeighbors( source, kdtreeTarget, numNeighborsColorTransferBwd, maxGeometryDist2Bwd, refinedColorsDists2,
+                           []( size_t, size_t ) { return true; },
+                           [&]( size_t index, size_t, double dist ) {
+                             return DistColor{dist, source.getColor16bit( index )};
+                           } );
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  } );
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
     auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
                                                                     // derived in backward
@@ -1792,7 +1886,7 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
         target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
@@ -1811,21 +1905,20 @@ bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
   std::vector<std::vector<PCCColor3B>> refinedColors2;
   refinedColors1.resize( pointCountTarget );
   refinedColors2.resize( pointCountTarget );
-  const size_t num_results = 1;
-  PCCNNResult  result;
+  const size_t                                 num_results = 1;
+  tbb::enumerable_thread_specific<PCCNNResult> results;
   //  Find THE closest point in reconstruction to each source point
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    auto& result = results.local();
     kdtreeSource.search( target[index], num_results, result );
     refinedColors1[index] = source.getColor( result.indices( 0 ) );
-  }
+  } );
   //  Find points in source that are closest to point in reconstruction
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], num_results, result );
-    refinedColors2[result.indices( 0 )].push_back( color );
-  }
+  gatherBackwardNeighbors( source, kdtreeTarget, num_results, ( std::numeric_limits<double>::max )(), refinedColors2,
+                           []( size_t, size_t ) { return true; },
+                           [&]( size_t index, size_t, double ) { return source.getColor( index ); } );
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     const PCCColor3B               color1  = refinedColors1[index];
     const std::vector<PCCColor3B>& colors2 = refinedColors2[index];
     if ( colors2.empty() || losslessTexture ) {
@@ -1867,7 +1960,7 @@ bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
         target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1886,18 +1979,17 @@ bool PCCPointSet3::transferColorSimple( PCCPointSet3& target, const double bestC
   std::vector<std::vector<PCCColor3B>> refinedColors2;
   refinedColors1.resize( pointCountTarget );
   refinedColors2.resize( pointCountTarget );
-  const size_t num_results = 1;
-  PCCNNResult  result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  const size_t                                 num_results = 1;
+  tbb::enumerable_thread_specific<PCCNNResult> results;
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    auto& result = results.local();
     kdtreeSource.search( target[index], num_results, result );
     refinedColors1[index] = source.getColor( result.indices( 0 ) );
-  }
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], num_results, result );
-    refinedColors2[result.indices( 0 )].push_back( color );
-  }
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  } );
+  gatherBackwardNeighbors( source, kdtreeTarget, num_results, ( std::numeric_limits<double>::max )(), refinedColors2,
+                           []( size_t, size_t ) { return true; },
+                           [&]( size_t index, size_t, double ) { return source.getColor( index ); } );
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     const PCCColor3B              color1  = refinedColors1[index];
     const std::vector<PCCColor3B> colors2 = refinedColors2[index];
     if ( colors2.empty() ) {
@@ -1944,7 +2036,7 @@ bool PCCPointSet3::transferColorSimple( PCCPointSet3& target, const double bestC
       }
       target.setColor( index, PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
     }
-  }
+  } );
   return true;
 }
 
@@ -1954,10 +2046,11 @@ bool PCCPointSet3::transferColorWeight( PCCPointSet3& target, const double bestC
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
   target.addColors16bit();
-  PCCKdTree    kdtreeSource( source );
-  PCCNNResult  result;
-  const size_t num_results = 5;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  PCCKdTree                                    kdtreeSource( source );
+  tbb::enumerable_thread_specific<PCCNNResult> results;
+  const size_t                                 num_results = 5;
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    auto& result = results.local();
     kdtreeSource.search( target[index], num_results, result );
     double color16bit[3] = {0., 0., 0.};
     double sum           = 0;
@@ -1983,7 +2076,7 @@ bool PCCPointSet3::transferColorWeight( PCCPointSet3& target, const double bestC
     }
     target.setColor16bit(
         index, PCCColor16bit( uint16_t( color16bit[0] ), uint16_t( color16bit[1] ), uint16_t( color16bit[2] ) ) );
-  }
+  } );
   return true;
 }
 
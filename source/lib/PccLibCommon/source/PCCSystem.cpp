@@ -34,6 +34,11 @@
 #if _WIN32
 #define _UNICODE
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #include <chrono>
@@ -105,3 +110,64 @@ int pcc::system( const char* command ) noexcept {
 #endif
 
 //===========================================================================
+
+bool pcc::PCCMemoryMappedFile::open( const std::string& fileName ) {
+  close();
+#if _WIN32
+  HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+  if ( file == INVALID_HANDLE_VALUE ) { return false; }
+  LARGE_INTEGER fileSize;
+  if ( GetFileSizeEx( file, &fileSize ) == 0 || fileSize.QuadPart == 0 ) {
+    CloseHandle( file );
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+  if ( mapping == nullptr ) {
+    CloseHandle( file );
+    return false;
+  }
+  void* data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+  if ( data == nullptr ) {
+    CloseHandle( mapping );
+    CloseHandle( file );
+    return false;
+  }
+  file_    = file;
+  mapping_ = mapping;
+  data_    = static_cast<const char*>( data );
+  size_    = static_cast<size_t>( fileSize.QuadPart );
+#else
+  int fd = ::open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 ) { return false; }
+  struct stat fileStat;
+  if ( fstat( fd, &fileStat ) != 0 || fileStat.st_size <= 0 ) {
+    ::close( fd );
+    return false;
+  }
+  void* data = mmap( nullptr, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+  if ( data == MAP_FAILED ) { return false; }
+  madvise( data, static_cast<size_t>( fileStat.st_size ), MADV_SEQUENTIAL );
+  data_ = static_cast<const char*>( data );
+  size_ = static_cast<size_t>( fileStat.st_size );
+#endif
+  return true;
+}
+
+void pcc::PCCMemoryMappedFile::close() {
+  if ( data_ == nullptr ) { return; }
+#if _WIN32
+  UnmapViewOfFile( data_ );
+  CloseHandle( mapping_ );
+  CloseHandle( file_ );
+  file_    = nullptr;
+  mapping_ = nullptr;
+#else
+  munmap( const_cast<char*>( data_ ), size_ );
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+//===========================================================================
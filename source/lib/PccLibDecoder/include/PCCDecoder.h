@@ -38,6 +38,7 @@
 #include "PCCCodec.h"
 #include "PCCMath.h"
 #include "PCCPatch.h"
+#include <functional>
 
 namespace pcc {
 
@@ -62,6 +63,12 @@ class PCCDecoder : public PCCCodec {
   int decode( PCCContext& context, PCCGroupOfFrames& reconstruct, int32_t atlasIndex );
 
   void setParameters( const PCCDecoderParameters& params );
+
+  // Called by decode() with the index in the group of frames of each reconstructed point cloud, in the frame order,
+  // as soon as the frame and all the frames before it are finished.
+  void setReconstructionCallback( const std::function<void( size_t, PCCPointSet3& )>& callback ) {
+    reconstructionCallback_ = callback;
+  }
   void setPostProcessingSeiParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context );
   void setGeneratePointCloudParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context );
   void createPatchFrameDataStructure( PCCContext& context );
@@ -74,7 +81,8 @@ class PCCDecoder : public PCCCodec {
                                         PointLocalReconstructionData& plrd,
                                         size_t                        occupancyPackingBlockSize );
 
-  PCCDecoderParameters params_;
+  PCCDecoderParameters                         params_;
+  std::function<void( size_t, PCCPointSet3& )> reconstructionCallback_;
 };
 };  // namespace pcc
 
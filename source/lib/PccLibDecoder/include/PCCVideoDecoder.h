@@ -46,6 +46,7 @@
 #else
 #include "PCCHMAppVideoDecoder.h"
 #endif
+#include "PCCLosslessVideoDecoder.h"
 #include "PCCInternalColorConverter.h"
 #ifdef USE_HDRTOOLS
 #include "PCCHDRToolsLibColorConverter.h"
@@ -60,6 +61,8 @@ class PCCVideoDecoder {
   PCCVideoDecoder();
   ~PCCVideoDecoder();
 
+  void setNbThread( size_t nbThread ) { nbThread_ = nbThread; }
+
   template <typename T>
   bool decompress( PCCVideo<T, 3>&    video,
                    const std::string& path,
@@ -83,12 +86,17 @@ class PCCVideoDecoder {
 
     // Decode video
     std::shared_ptr<PCCVirtualVideoDecoder<T>> decoder;
+    if ( contexts.getVideoCodecId( bitstream.type() ) == CODEC_LOSSLESS ) {
+      decoder = std::make_shared<PCCLosslessVideoDecoder<T>>( nbThread_ );
+    } else {
 #ifdef USE_HM_VIDEO_CODEC
-    decoder = std::make_shared<PCCHMLibVideoDecoder<T>>();
+      decoder = std::make_shared<PCCHMLibVideoDecoder<T>>();
 #else
-    decoder = std::make_shared<PCCHMAppVideoDecoder<T>>();
+      decoder = std::make_shared<PCCHMAppVideoDecoder<T>>();
 #endif
+    }
     decoder->decode( bitstream, bitDepth == 8 ? 8 : 10, use444CodecIo, video, decoderPath, fileName, frameCount );
+    if ( video.getFrameCount() == 0 ) { return false; }
     width  = video.getWidth();
     height = video.getHeight();
     const std::string yuvRecFileName =
@@ -134,8 +142,7 @@ class PCCVideoDecoder {
           auto& destImage = video.getFrame( frNum );
           destImage.resize( width, height, PCCCOLORFORMAT::YUV444 );
           // iterate the patch information and perform chroma down-sampling on each patch individually
-          std::vector<PCCPatch> patches      = context.getPatches();
-          std::vector<size_t>   blockToPatch = context.getBlockToPatch();
+          std::vector<PCCPatch> patches = context.getPatches();
           for ( int patchIdx = 0; patchIdx <= patches.size(); patchIdx++ ) {
             size_t occupancyResolution;
             size_t patch_left;
@@ -319,9 +326,9 @@ class PCCVideoDecoder {
             // patch_height, true, true );
             PCCVideo<T, 3> tmpVideo;
             tmpVideo.resize( 1 );
-            tmpVideo[0] = tmpImage;
+            tmpVideo[0] = std::move( tmpImage );
             converter->convert( configInverseColorSpace, tmpVideo, colorSpaceConversionPath, fileName + "_tmp" );
-            tmpImage = tmpVideo[0];
+            tmpImage = std::move( tmpVideo[0] );
             // substitute the pixels in the output image for compression
             for ( size_t i = 0; i < patch_height; i++ ) {
               for ( size_t j = 0; j < patch_width; j++ ) {
@@ -345,6 +352,9 @@ class PCCVideoDecoder {
     }
     return true;
   }
+
+ private:
+  size_t nbThread_ = 0;
 };
 
 };  // namespace pcc
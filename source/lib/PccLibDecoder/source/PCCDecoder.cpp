@@ -40,6 +40,8 @@
 #include "PCCVideoDecoder.h"
 #include "PCCGroupOfFrames.h"
 #include <tbb/tbb.h>
+#include <atomic>
+#include <mutex>
 #include "PCCDecoder.h"
 
 using namespace pcc;
@@ -89,156 +91,202 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
   bool isAttributes444          = plt.getProfileCodecGroupIdc() == CODEC_GROUP_HEVC444;
   bool isAuxiliaryAttributes444 = plt.getProfileCodecGroupIdc() == CODEC_GROUP_HEVC444;
 
-  videoDecoder.decompress( context.getVideoOccupancyMap(), path.str(), context.size(), videoBitstreamOM,
-                           params_.videoDecoderOccupancyMapPath_, context, decodedBitDepthOM,
-                           params_.keepIntermediateFiles_, isOCM444, false, "", "" );
-  // converting the decoded bitdepth to the nominal bitdepth
-  context.getVideoOccupancyMap().convertBitdepth( decodedBitDepthOM, oi.getOccupancyNominal2DBitdepthMinus1() + 1,
-                                                  oi.getOccupancyMSBAlignFlag() );
-
+  // The sub-streams are decoded concurrently within the nbThread_ budget: each decompress() call creates its own
+  // video decoder and color converter. The reconstruction only waits for the geometry tasks, the attribute tasks
+  // are waited for before the first color reconstruction. A sub-stream that can't be decoded fails the decoding.
+  tbb::task_arena   limited( static_cast<int>( params_.nbThread_ ) );
+  tbb::task_group   geometryTasks;
+  tbb::task_group   attributeTasks;
+  std::atomic<bool> decodingFailed( false );
+  videoDecoder.setNbThread( params_.nbThread_ );
   if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
     context.getVideoGeometryMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );
-    size_t totalGeoSize = 0;
-    for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
-      // Decompress D[mapIndex]
-      int decodedBitDepth = gi.getGeometryNominal2dBitdepthMinus1() + 1;  // this should be extracted from the bitstream
-      auto  geometryIndex = static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex );
-      auto& videoBitstream = context.getVideoBitstream( geometryIndex );
-      videoDecoder.decompress( context.getVideoGeometryMultiple()[mapIndex], path.str(), context.size(), videoBitstream,
-                               params_.videoDecoderPath_, context, decodedBitDepth, params_.keepIntermediateFiles_,
-                               isGeometry444 );
-      context.getVideoGeometryMultiple()[mapIndex].convertBitdepth(
-          decodedBitDepth, gi.getGeometryNominal2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
-      std::cout << "geometry D" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
-      totalGeoSize += videoBitstream.size();
+    if ( ai.getAttributeCount() > 0 ) {
+      context.getVideoTextureMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );  // this allocation is
+                                                                                            // considering only one
+                                                                                            // attribute, with a
+                                                                                            // single partition, but
+                                                                                            // multiple streams
     }
-    std::cout << "total geometry video ->" << totalGeoSize << " B" << std::endl;
-  } else {
-    int   decodedBitDepthGeo = gi.getGeometryNominal2dBitdepthMinus1() + 1;
-    auto& videoBitstream     = context.getVideoBitstream( VIDEO_GEOMETRY );
-    videoDecoder.decompress( context.getVideoGeometryMultiple()[0], path.str(), context.size() * mapCount,
-                             videoBitstream, params_.videoDecoderPath_, context, decodedBitDepthGeo,
-                             params_.keepIntermediateFiles_, isGeometry444 );
-    context.getVideoGeometryMultiple()[0].convertBitdepth(
-        decodedBitDepthGeo, gi.getGeometryNominal2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
-    std::cout << "geometry video ->" << videoBitstream.size() << " B" << std::endl;
-  }
-
-  if ( asps.getRawPatchEnabledFlag() && sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-    int   decodedBitDepthMP = gi.getGeometryNominal2dBitdepthMinus1() + 1;
-    auto& videoBitstreamMP  = context.getVideoBitstream( VIDEO_GEOMETRY_RAW );
-    videoDecoder.decompress( context.getVideoRawPointsGeometry(), path.str(), context.size(), videoBitstreamMP,
-                             params_.videoDecoderPath_, context, decodedBitDepthMP, params_.keepIntermediateFiles_,
-                             isAuxiliarygeometry444 );
-    context.getVideoRawPointsGeometry().convertBitdepth( decodedBitDepthMP, gi.getGeometryNominal2dBitdepthMinus1() + 1,
-                                                         gi.getGeometryMSBAlignFlag() );
-    // generateRawPointsGeometryfromVideo( context, reconstructs );
-    std::cout << " raw points geometry -> " << videoBitstreamMP.size() << " B " << endl;
   }
+  limited.execute( [&] {
+    geometryTasks.run( [&] {
+      if ( !videoDecoder.decompress( context.getVideoOccupancyMap(), path.str(), context.size(), videoBitstreamOM,
+                                     params_.videoDecoderOccupancyMapPath_, context, decodedBitDepthOM,
+                                     params_.keepIntermediateFiles_, isOCM444, false, "", "" ) ) {
+        decodingFailed = true;
+      }
+      // converting the decoded bitdepth to the nominal bitdepth
+      context.getVideoOccupancyMap().convertBitdepth( decodedBitDepthOM, oi.getOccupancyNominal2DBitdepthMinus1() + 1,
+                                                      oi.getOccupancyMSBAlignFlag() );
+    } );
 
-  if ( ai.getAttributeCount() > 0 ) {
-    for ( int attrIndex = 0; attrIndex < sps.getAttributeInformation( atlasIndex ).getAttributeCount();
-          attrIndex++ ) {  // right now we only have one attribute, this should be
-                           // generalized
-      int decodedBitdepthAttribute   = ai.getAttributeNominal2dBitdepthMinus1( attrIndex ) + 1;
-      int decodedBitdepthAttributeMP = ai.getAttributeNominal2dBitdepthMinus1( attrIndex ) + 1;
-      for ( int attrPartitionIndex = 0;
-            attrPartitionIndex <
-            sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
-            attrPartitionIndex++ ) {  // right now we have only one partition,
-                                      // this should be generalized
-        if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
-          int sizeTextureVideo = 0;
-          context.getVideoTextureMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );  // this allocation is
-                                                                                                // considering only one
-                                                                                                // attribute, with a
-                                                                                                // single partition, but
-                                                                                                // multiple streams
-          for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
-            // decompress T[mapIndex]
-            auto textureIndex =
-                static_cast<PCCVideoType>( VIDEO_TEXTURE_T0 + attrPartitionIndex + MAX_NUM_ATTR_PARTITIONS * mapIndex );
-            auto& videoBitstream = context.getVideoBitstream( textureIndex );
-            videoDecoder.decompress( context.getVideoTextureMultiple()[mapIndex], path.str(), context.size(),
-                                     videoBitstream, params_.videoDecoderPath_, context,
-                                     ai.getAttributeNominal2dBitdepthMinus1( 0 ) + 1, params_.keepIntermediateFiles_,
-                                     isAttributes444, params_.patchColorSubsampling_,
-                                     params_.inverseColorSpaceConversionConfig_, params_.colorSpaceConversionPath_ );
-            /*context.getVideoTextureMultiple()[mapIndex].convertBitdepth(
-              decodedBitdepthAttribute,
-              ai.getAttributeNominal2dBitdepthMinus1(attrIndex) + 1,
-              ai.getAttributeMSBAlignFlag(attrIndex));*/
-            std::cout << "texture T" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
-            sizeTextureVideo += videoBitstream.size();
+    if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
+      for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
+        geometryTasks.run( [&, mapIndex] {
+          // Decompress D[mapIndex]
+          int decodedBitDepth = gi.getGeometryNominal2dBitdepthMinus1() + 1;  // this should be extracted from the
+                                                                              // bitstream
+          auto  geometryIndex  = static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex );
+          auto& videoBitstream = context.getVideoBitstream( geometryIndex );
+          if ( !videoDecoder.decompress( context.getVideoGeometryMultiple()[mapIndex], path.str(), context.size(),
+                                         videoBitstream, params_.videoDecoderPath_, context, decodedBitDepth,
+                                         params_.keepIntermediateFiles_, isGeometry444 ) ) {
+            decodingFailed = true;
           }
-          std::cout << "texture    video ->" << sizeTextureVideo << " B" << std::endl;
-        } else {
-          auto  textureIndex   = static_cast<PCCVideoType>( VIDEO_TEXTURE + attrPartitionIndex );
-          auto& videoBitstream = context.getVideoBitstream( textureIndex );
-          printf( "call videoDecoder.decompress()::context.getVideoTexture() \n" );
-          videoDecoder.decompress( context.getVideoTextureMultiple()[0],  // video,
-                                   path.str(),                            // path,
-                                   context.size() * mapCount,             // frameCount,
-                                   videoBitstream,                        // bitstream,
-                                   params_.videoDecoderPath_,             // decoderPath,
-                                   context,                               // contexts,
-                                   decodedBitdepthAttribute,              // bitDepth,
-                                   params_.keepIntermediateFiles_,        // keepIntermediateFiles
-                                   isAttributes444,
-                                   params_.patchColorSubsampling_,  // patchColorSubsampling
-                                   params_.inverseColorSpaceConversionConfig_, params_.colorSpaceConversionPath_ );
-
-          /*context.getVideoTexture().convertBitdepth(
-              decodedBitdepthAttribute,
-             ai.getAttributeNominal2dBitdepthMinus1(attrIndex) + 1,
-             ai.getAttributeMSBAlignFlag(attrIndex));*/
-          std::cout << "texture video  ->" << videoBitstream.size() << " B" << std::endl;
+          context.getVideoGeometryMultiple()[mapIndex].convertBitdepth(
+              decodedBitDepth, gi.getGeometryNominal2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
+          std::cout << "geometry D" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
+        } );
+      }
+    } else {
+      geometryTasks.run( [&] {
+        int   decodedBitDepthGeo = gi.getGeometryNominal2dBitdepthMinus1() + 1;
+        auto& videoBitstream     = context.getVideoBitstream( VIDEO_GEOMETRY );
+        if ( !videoDecoder.decompress( context.getVideoGeometryMultiple()[0], path.str(), context.size() * mapCount,
+                                       videoBitstream, params_.videoDecoderPath_, context, decodedBitDepthGeo,
+                                       params_.keepIntermediateFiles_, isGeometry444 ) ) {
+          decodingFailed = true;
         }
-        if ( asps.getRawPatchEnabledFlag() && sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-          auto  textureIndex     = static_cast<PCCVideoType>( VIDEO_TEXTURE_RAW + attrPartitionIndex );
-          auto& videoBitstreamMP = context.getVideoBitstream( textureIndex );
-          videoDecoder.decompress( context.getVideoRawPointsTexture(), path.str(), context.size(), videoBitstreamMP,
-                                   params_.videoDecoderPath_, context, decodedBitdepthAttributeMP,
-                                   params_.keepIntermediateFiles_, isAuxiliaryAttributes444, false,
-                                   params_.inverseColorSpaceConversionConfig_, params_.colorSpaceConversionPath_ );
+        context.getVideoGeometryMultiple()[0].convertBitdepth(
+            decodedBitDepthGeo, gi.getGeometryNominal2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
+        std::cout << "geometry video ->" << videoBitstream.size() << " B" << std::endl;
+      } );
+    }
 
-          /* context.getVideoRawPointsTexture().convertBitdepth(
-             decodedBitdepthAttributeMP,
-                                                      ai.getAttributeNominal2dBitdepthMinus1(
-             0 ) + 1,
-                                                      ai.getAttributeMSBAlignFlag(
-             0 ) );*/
+    if ( asps.getRawPatchEnabledFlag() && sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
+      geometryTasks.run( [&] {
+        int   decodedBitDepthMP = gi.getGeometryNominal2dBitdepthMinus1() + 1;
+        auto& videoBitstreamMP  = context.getVideoBitstream( VIDEO_GEOMETRY_RAW );
+        if ( !videoDecoder.decompress( context.getVideoRawPointsGeometry(), path.str(), context.size(),
+                                       videoBitstreamMP, params_.videoDecoderPath_, context, decodedBitDepthMP,
+                                       params_.keepIntermediateFiles_, isAuxiliarygeometry444 ) ) {
+          decodingFailed = true;
+        }
+        context.getVideoRawPointsGeometry().convertBitdepth(
+            decodedBitDepthMP, gi.getGeometryNominal2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
+        std::cout << " raw points geometry -> " << videoBitstreamMP.size() << " B " << endl;
+      } );
+    }
 
-          // generateRawPointsTexturefromVideo( context, reconstructs );
-          std::cout << " raw points texture -> " << videoBitstreamMP.size() << " B" << endl;
+    if ( ai.getAttributeCount() > 0 ) {
+      // the attributes and partitions written in the same video are decoded by the same task, in order.
+      if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
+        for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
+          attributeTasks.run( [&, mapIndex] {
+            for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
+              for ( int attrPartitionIndex = 0;
+                    attrPartitionIndex < ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+                    attrPartitionIndex++ ) {
+                // decompress T[mapIndex]
+                auto  textureIndex   = static_cast<PCCVideoType>( VIDEO_TEXTURE_T0 + attrPartitionIndex +
+                                                               MAX_NUM_ATTR_PARTITIONS * mapIndex );
+                auto& videoBitstream = context.getVideoBitstream( textureIndex );
+                if ( !videoDecoder.decompress( context.getVideoTextureMultiple()[mapIndex], path.str(),
+                                               context.size(), videoBitstream, params_.videoDecoderPath_, context,
+                                               ai.getAttributeNominal2dBitdepthMinus1( 0 ) + 1,
+                                               params_.keepIntermediateFiles_, isAttributes444,
+                                               params_.patchColorSubsampling_,
+                                               params_.inverseColorSpaceConversionConfig_,
+                                               params_.colorSpaceConversionPath_ ) ) {
+                  decodingFailed = true;
+                }
+                std::cout << "texture T" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
+              }
+            }
+          } );
         }
+      } else {
+        attributeTasks.run( [&] {
+          for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
+            int decodedBitdepthAttribute = ai.getAttributeNominal2dBitdepthMinus1( attrIndex ) + 1;
+            for ( int attrPartitionIndex = 0;
+                  attrPartitionIndex < ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+                  attrPartitionIndex++ ) {
+              auto  textureIndex   = static_cast<PCCVideoType>( VIDEO_TEXTURE + attrPartitionIndex );
+              auto& videoBitstream = context.getVideoBitstream( textureIndex );
+              printf( "call videoDecoder.decompress()::context.getVideoTexture() \n" );
+              if ( !videoDecoder.decompress( context.getVideoTextureMultiple()[0],  // video,
+                                             path.str(),                            // path,
+                                             context.size() * mapCount,             // frameCount,
+                                             videoBitstream,                        // bitstream,
+                                             params_.videoDecoderPath_,             // decoderPath,
+                                             context,                               // contexts,
+                                             decodedBitdepthAttribute,              // bitDepth,
+                                             params_.keepIntermediateFiles_,        // keepIntermediateFiles
+                                             isAttributes444,
+                                             params_.patchColorSubsampling_,  // patchColorSubsampling
+                                             params_.inverseColorSpaceConversionConfig_,
+                                             params_.colorSpaceConversionPath_ ) ) {
+                decodingFailed = true;
+              }
+              std::cout << "texture video  ->" << videoBitstream.size() << " B" << std::endl;
+            }
+          }
+        } );
+      }
+      if ( asps.getRawPatchEnabledFlag() && sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
+        attributeTasks.run( [&] {
+          for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
+            int decodedBitdepthAttributeMP = ai.getAttributeNominal2dBitdepthMinus1( attrIndex ) + 1;
+            for ( int attrPartitionIndex = 0;
+                  attrPartitionIndex < ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+                  attrPartitionIndex++ ) {
+              auto  textureIndex     = static_cast<PCCVideoType>( VIDEO_TEXTURE_RAW + attrPartitionIndex );
+              auto& videoBitstreamMP = context.getVideoBitstream( textureIndex );
+              if ( !videoDecoder.decompress( context.getVideoRawPointsTexture(), path.str(), context.size(),
+                                             videoBitstreamMP, params_.videoDecoderPath_, context,
+                                             decodedBitdepthAttributeMP, params_.keepIntermediateFiles_,
+                                             isAuxiliaryAttributes444, false,
+                                             params_.inverseColorSpaceConversionConfig_,
+                                             params_.colorSpaceConversionPath_ ) ) {
+                decodingFailed = true;
+              }
+              std::cout << " raw points texture -> " << videoBitstreamMP.size() << " B" << endl;
+            }
+          }
+        } );
       }
     }
-  }
+  } );
 
-  // All video have been decoded, start reconsctruction processes
+  // The geometry videos are needed by all the reconstruction processes.
+  limited.execute( [&] { geometryTasks.wait(); } );
+  if ( decodingFailed ) {
+    limited.execute( [&] { attributeTasks.wait(); } );
+    return -1;
+  }
+  if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
+    size_t totalGeoSize = 0;
+    for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
+      totalGeoSize += context.getVideoBitstream( static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex ) ).size();
+    }
+    std::cout << "total geometry video ->" << totalGeoSize << " B" << std::endl;
+  }
   if ( asps.getRawPatchEnabledFlag() && sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
     printf( "generateRawPointsGeometryfromVideo \n" );
     fflush( stdout );
     generateRawPointsGeometryfromVideo( context );
   }
 
-  if ( ai.getAttributeCount() > 0 ) {
-    for ( int attrIndex = 0; attrIndex < sps.getAttributeInformation( atlasIndex ).getAttributeCount();
-          attrIndex++ ) {  // right now we only have one attribute, this should be generalized
-      for ( int attrPartitionIndex = 0;
-            attrPartitionIndex <
-            sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
-            attrPartitionIndex++ ) {  // right now we have only one partition,
-                                      // this should be generalized
-        if ( asps.getRawPatchEnabledFlag() && sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-          printf( "generateRawPointsTexturefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
-                  attrPartitionIndex );
-          fflush( stdout );
-          generateRawPointsTexturefromVideo( context );
-        }
-      }
+  // the raw points textures are read from the video by the attribute reconstruction of each frame, once the
+  // geometry of the frame, which sets its number of EOM points, is reconstructed.
+  const bool rawPointsTexture = ai.getAttributeCount() > 0 && asps.getRawPatchEnabledFlag() &&
+                                sps.getAuxiliaryVideoPresentFlag( atlasIndex );
+  bool attributesDecoded = false;
+  auto waitAttributes    = [&]() {
+    if ( attributesDecoded ) { return; }
+    limited.execute( [&] { attributeTasks.wait(); } );
+    attributesDecoded = true;
+    if ( rawPointsTexture ) {
+      context.setRawAttWidth( context.getVideoRawPointsTexture().getWidth() );
+      context.setRawAttHeight( context.getVideoRawPointsTexture().getHeight() );
     }
+  };
+  // the patch color subsampling reads the block to patch map that is written by the reconstruction.
+  if ( params_.patchColorSubsampling_ ) {
+    waitAttributes();
+    if ( decodingFailed ) { return -1; }
   }
 
   reconstructs.setFrameCount( context.size() );
@@ -267,10 +315,19 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
     }
   }
 
-  for ( auto& frame : context.getFrames() ) {
-    auto&                 reconstruct = reconstructs[frame.getIndex()];
-    std::vector<uint32_t> partition;
+  // The reconstruction of a frame only depends on its own frame context and on the decoded videos: the frames are
+  // reconstructed concurrently, the geometry while the attribute videos are still being decoded, and each frame is
+  // coloured, post-processed and handed to the callback as soon as its geometry and the attribute videos are ready.
+  // The callback is called in the frame order.
+  const size_t                       frameCount = context.size();
+  std::vector<std::vector<uint32_t>> partitions( frameCount );
+  std::vector<bool>                  reconstructed( frameCount, false );
+  size_t                             nextFrameToDeliver = 0;
+  std::mutex                         deliveryMutex;
 
+  auto reconstructGeometry = [&]( PCCFrameContext& frame ) {
+    auto& reconstruct = reconstructs[frame.getIndex()];
+    auto& partition   = partitions[frame.getIndex()];
     // Decode point cloud
     if ( !ppSEIParams.pbfEnableFlag_ ) {
       generateOccupancyMap( frame, context.getVideoOccupancyMap().getFrame( frame.getIndex() ),
@@ -284,6 +341,15 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
     // context.getOccupancyPackingBlockSize() );
     generatePointCloud( reconstruct, context, frame, gpcParams, partition, true );
     printf( "generatePointCloud done \n" );
+  };
+  auto reconstructAttributes = [&]( PCCFrameContext& frame ) {
+    auto& reconstruct = reconstructs[frame.getIndex()];
+    auto& partition   = partitions[frame.getIndex()];
+    if ( rawPointsTexture ) {
+      generateRawPointsTexturefromVideo( context, frame, frame.getIndex() );
+      std::cout << "generate raw points (Texture) : frame " << frame.getIndex()
+                << ", # of raw points Texture : " << frame.getRawPointsPatch( 0 ).size() << std::endl;
+    }
     printf( "start colorPointCloud loop attIdx = [0;%hhu ] \n", ai.getAttributeCount() );
     fflush( stdout );
     for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
@@ -336,12 +402,72 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
       TRACE_CODEC( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
       reconstruct.copyRGB16ToRGB8();
     }
+    std::vector<uint32_t>().swap( partition );
+  };
+  auto deliver = [&]( size_t frameIndex ) {
+    if ( !reconstructionCallback_ ) { return; }
+    std::lock_guard<std::mutex> lock( deliveryMutex );
+    reconstructed[frameIndex] = true;
+    while ( nextFrameToDeliver < frameCount && reconstructed[nextFrameToDeliver] ) {
+      reconstructionCallback_( nextFrameToDeliver, reconstructs[nextFrameToDeliver] );
+      nextFrameToDeliver++;
+    }
+  };
+#ifdef CODEC_TRACE
+  // the trace file is written frame after frame.
+  for ( auto& frame : context.getFrames() ) {
+    reconstructGeometry( frame );
+    waitAttributes();
+    if ( decodingFailed ) { break; }
+    reconstructAttributes( frame );
+    deliver( frame.getIndex() );
+  }
+#else
+  // a frame task goes on with the attributes of its frame if the attribute videos are decoded, otherwise the frame is
+  // resumed by a new task when they are.
+  tbb::task_group   frameTasks;
+  std::vector<bool> geometryDone( frameCount, false );
+  bool              attributesReady = attributesDecoded;
+  std::mutex        frameMutex;
+  auto              finishFrame = [&]( const size_t i ) {
+    reconstructAttributes( context[i] );
+    deliver( context[i].getIndex() );
+  };
+  limited.execute( [&] {
+    for ( size_t i = 0; i < frameCount; i++ ) {
+      frameTasks.run( [&, i] {
+        reconstructGeometry( context[i] );
+        {
+          std::lock_guard<std::mutex> lock( frameMutex );
+          geometryDone[i] = true;
+          if ( !attributesReady ) { return; }
+        }
+        finishFrame( i );
+      } );
+    }
+  } );
+  waitAttributes();
+  std::vector<size_t> pendingFrames;
+  if ( !decodingFailed ) {
+    std::lock_guard<std::mutex> lock( frameMutex );
+    attributesReady = true;
+    for ( size_t i = 0; i < frameCount; i++ ) {
+      if ( geometryDone[i] ) { pendingFrames.push_back( i ); }
+    }
   }
+  limited.execute( [&] {
+    for ( auto i : pendingFrames ) {
+      frameTasks.run( [&, i] { finishFrame( i ); } );
+    }
+    frameTasks.wait();
+  } );
+#endif
+  waitAttributes();
 #ifdef CODEC_TRACE
   setTrace( false );
   closeTrace();
 #endif
-  return 0;
+  return decodingFailed ? -1 : 0;
 }
 
 void PCCDecoder::setPointLocalReconstruction( PCCContext& context ) {
@@ -37,6 +37,7 @@
 #include "PCCEncoderParameters.h"
 #include "PCCCodec.h"
 #include "PCCKdTree.h"
+#include "PCCPackingCanvas.h"
 #include <map>
 
 namespace pcc {
@@ -64,43 +65,6 @@ struct PCCPatchSegmenter3Parameters;
 class PCCPatch;
 struct PCCBistreamPosition;
 
-struct SparseMatrixCoefficient {
-  int32_t _index;
-  double  _value;
-};
-
-struct SparseMatrixRow {
-  SparseMatrixRow() { _coefficientCount = 0; }
-  void addCofficient( const int32_t j, const double value ) {
-    assert( _coefficientCount < 5 );
-    auto& coeff  = _coefficients[_coefficientCount++];
-    coeff._index = j;
-    coeff._value = value;
-  }
-  int32_t                 _coefficientCount;
-  SparseMatrixCoefficient _coefficients[5];
-};
-
-struct SparseMatrix {
-  const SparseMatrixRow& getRow( const int32_t i ) const {
-    assert( i < _rows.size() );
-    return _rows[i];
-  }
-  SparseMatrixRow& getRow( const int32_t i ) {
-    assert( i < _rows.size() );
-    return _rows[i];
-  }
-  void                         resize( const int32_t rowCount ) { _rows.resize( rowCount ); }
-  std::vector<SparseMatrixRow> _rows;
-};
-struct PaddingContext {
-  std::vector<int32_t> _mapping;
-  std::vector<int32_t> _invMapping;
-  SparseMatrix         _A;
-  std::vector<double>  _b[3];
-  std::vector<double>  _x, _p, _r, _q;
-};
-
 typedef std::map<size_t, PCCPatch> unionPatch;  // unionPatch ------
                                                 // [TrackIndex, UnionPatch];
 typedef std::pair<size_t, size_t> SubContext;   // SubContext ------ [start,
@@ -128,10 +92,10 @@ class PCCEncoder : public PCCCodec {
 
   //**occupancy map**//
   bool generateOccupancyMapVideo( const PCCGroupOfFrames& sources, PCCContext& context );
-  bool generateOccupancyMapVideo( const size_t           imageWidth,
-                                  const size_t           imageHeight,
-                                  std::vector<uint32_t>& occupancyMap,
-                                  PCCImageOccupancyMap&  videoFrameOccupancyMap );
+  bool generateOccupancyMapVideo( const size_t          imageWidth,
+                                  const size_t          imageHeight,
+                                  std::vector<uint8_t>& occupancyMap,
+                                  PCCImageOccupancyMap& videoFrameOccupancyMap );
   bool generateOccupancyMap( PCCContext& context );
   void modifyOccupancyMapEOM( PCCFrameContext& frame );
   void generateOccupancyMap( PCCFrameContext& frameContext );
@@ -139,11 +103,11 @@ class PCCEncoder : public PCCCodec {
 
   void preFilterOccupancyMap( PCCImageOccupancyMap& image, size_t kwidth, size_t kheight );
   bool modifyOccupancyMap( const PCCGroupOfFrames& sources, PCCContext& context );
-  bool modifyOccupancyMap( const size_t           imageWidth,
-                           const size_t           imageHeight,
-                           std::vector<uint32_t>& occupancyMap,
-                           PCCImageOccupancyMap&  videoFrameOccupancyMap,
-                           std::ofstream&         ofile );
+  bool modifyOccupancyMap( const size_t          imageWidth,
+                           const size_t          imageHeight,
+                           std::vector<uint8_t>& occupancyMap,
+                           PCCImageOccupancyMap& videoFrameOccupancyMap,
+                           std::ofstream&        ofile );
   //**auxPatches**//
   void markRawPatchLocationOccupancyMapVideo( PCCContext& context );
   void markRawPatchLocation( PCCFrameContext& contextFrame, PCCImageOccupancyMap& occupancyMap );
@@ -188,6 +152,14 @@ class PCCEncoder : public PCCCodec {
                               PCCFrameContext&                    prevFrame,
                               size_t                              frameIndex,
                               float&                              distanceSrcRec );
+  bool generatePatches( const PCCPointSet3&                 source,
+                        PCCFrameContext&                    frameContext,
+                        const PCCPatchSegmenter3Parameters& segmenterParams,
+                        PCCVideoGeometry&                   videoGeometry,
+                        PCCFrameContext&                    prevFrame,
+                        size_t                              frameIndex,
+                        float&                              distanceSrcRec );
+  void packPatches( PCCFrameContext& frameContext, PCCFrameContext& prevFrame, size_t frameIndex );
 
   bool generateTextureVideo( const PCCPointSet3& reconstruct,
                              PCCContext&         context,
@@ -216,26 +188,28 @@ class PCCEncoder : public PCCCodec {
   template <typename T>
   int mean4w( T p1, unsigned char w1, T p2, unsigned char w2, T p3, unsigned char w3, T p4, unsigned char w4 );
   template <typename T>
-  void pushPullMip( const PCCImage<T, 3>&        image,
-                    PCCImage<T, 3>&              mip,
-                    const std::vector<uint32_t>& occupancyMap,
-                    std::vector<uint32_t>&       mipOccupancyMap );
+  void pushPullMip( const PCCImage<T, 3>&       image,
+                    PCCImage<T, 3>&             mip,
+                    const std::vector<uint8_t>& occupancyMap,
+                    std::vector<uint8_t>&       mipOccupancyMap );
   template <typename T>
-  void pushPullFill( PCCImage<T, 3>&              image,
-                     const PCCImage<T, 3>&        mip,
-                     const std::vector<uint32_t>& occupancyMap,
-                     int                          numIters );
+  void pushPullFill( PCCImage<T, 3>&             image,
+                     const PCCImage<T, 3>&       mip,
+                     const std::vector<uint8_t>& occupancyMap,
+                     int                         numIters );
   template <typename T>
   void dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image );
   template <typename T>
   void dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image );
   template <typename T>
-  void CreateCoarseLayer( PCCImage<T, 3>&        image,
-                          PCCImage<T, 3>&        mip,
-                          std::vector<uint32_t>& occupancyMap,
-                          std::vector<uint32_t>& mipOccupancyMap );
+  void CreateCoarseLayer( const PCCImage<T, 3>&       image,
+                          PCCImage<T, 3>&             mip,
+                          const std::vector<uint8_t>& occupancyMap,
+                          std::vector<uint8_t>&       mipOccupancyMap );
   template <typename T>
-  void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes );
+  void regionFill( PCCImage<T, 3>&             image,
+                   const std::vector<uint8_t>& occupancyMap,
+                   const PCCImage<T, 3>&       imageLowRes );
 
   //**placing patches**//
   void   packFlexible( PCCFrameContext& frame,
@@ -244,14 +218,14 @@ class PCCEncoder : public PCCCodec {
                        bool             enablePointCloudPartitioning = false );
   void   packTetris( PCCFrameContext& frame, int safeguard = 0 );
   void   packRawPointsPatch( PCCFrameContext&   frame,
-                             std::vector<bool>& occupancyMap,
+                             PCCPackingCanvas&  occupancyMap,
                              size_t&            width,
                              size_t&            height,
                              size_t             occupancySizeU,
                              size_t             occupancySizeV,
                              size_t             maxOccupancyRow );
   void   packEOMTexturePointsPatch( PCCFrameContext&   frame,
-                                    std::vector<bool>& occupancyMap,
+                                    PCCPackingCanvas&  occupancyMap,
                                     size_t&            width,
                                     size_t&            height,
                                     size_t             occupancySizeU,
@@ -323,7 +297,7 @@ class PCCEncoder : public PCCCodec {
                                                            size_t&            occupancySizeU,
                                                            size_t&            occupancySizeV,
                                                            const size_t       safeguard,
-                                                           std::vector<bool>& occupancyMap,
+                                                           PCCPackingCanvas&  occupancyMap,
                                                            size_t&            heightGPA,
                                                            size_t&            widthGPA,
                                                            size_t&            maxOccupancyRow );
@@ -336,7 +310,7 @@ class PCCEncoder : public PCCCodec {
                                                  size_t&                      occupancySizeU,
                                                  size_t&                      occupancySizeV,
                                                  const size_t                 safeguard,
-                                                 std::vector<bool>&           occupancyMap,
+                                                 PCCPackingCanvas&            occupancyMap,
                                                  size_t&                      heightGPA,
                                                  size_t&                      widthGPA,
                                                  size_t&                      maxOccupancyRow );
@@ -373,7 +347,11 @@ class PCCEncoder : public PCCCodec {
 
   //**print out**//
   static void printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV );
-  static void printMapTetris( std::vector<bool> img, const size_t sizeU, const size_t sizeV, std::vector<int> horizon );
+  static void printMap( const PCCPackingCanvas& img, const size_t sizeU, const size_t sizeV );
+  static void printMapTetris( const PCCPackingCanvas& img,
+                              const size_t            sizeU,
+                              const size_t            sizeV,
+                              std::vector<int>        horizon );
 
   PCCEncoderParameters params_;
 };
@@ -62,6 +62,7 @@ class PCCEncoderParameters {
   std::string       colorSpaceConversionConfig_;
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
+  size_t            nbFrameParallelSegmentation_;
   size_t            frameCount_;
   size_t            groupOfFramesSize_;
   std::string       uncompressedDataPath_;
@@ -76,6 +77,7 @@ class PCCEncoderParameters {
 
   // segmentation
   size_t nnNormalEstimation_;
+  bool   fastNormalEstimation_;
   bool   gridBasedRefineSegmentation_;
   size_t maxNNCountRefineSegmentation_;
   size_t iterationCountRefineSegmentation_;
@@ -100,6 +102,7 @@ class PCCEncoderParameters {
   size_t      occupancyPrecision_;
   std::string occupancyMapVideoEncoderConfig_;
   size_t      occupancyMapQP_;
+  size_t      occupancyMapCodecId_;
   size_t      EOMFixBitCount_;
   bool        occupancyMapRefinement_;
 
@@ -158,6 +161,8 @@ class PCCEncoderParameters {
   bool        useRawPointsSeparateVideo_;
   std::string geometryMPConfig_;
   std::string textureMPConfig_;
+  size_t      geometryMPCodecId_;
+  size_t      textureMPCodecId_;
 
   // scale and bias
   float             modelScale_;
@@ -210,6 +215,7 @@ class PCCEncoderParameters {
   // Flexible Patch Packing
   size_t packingStrategy_;
   size_t textureBGFill_;
+  double textureBGFillTolerance_;
   size_t safeGuardDistance_;
   bool   useEightOrientations_;
 
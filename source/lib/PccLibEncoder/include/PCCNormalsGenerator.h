@@ -57,6 +57,7 @@ struct PCCNormalsGenerator3Parameters {
   bool                           storeEigenvalues_;
   bool                           storeNumberOfNearestNeighborsInNormalEstimation_;
   bool                           storeCentroids_;
+  bool                           fastNormalEstimation_;
 };
 
 class PCCNormalsGenerator3 {
@@ -104,19 +105,22 @@ class PCCNormalsGenerator3 {
                       const PCCKdTree&                      kdtree,
                       const PCCNormalsGenerator3Parameters& params,
                       PCCNNResult&                          nNResult );
+  void computeNormalFast( const size_t                          index,
+                          const PCCPointSet3&                   pointCloud,
+                          const PCCNormalsGenerator3Parameters& params,
+                          const size_t*                         neighbors,
+                          const size_t                          neighborCount );
   void computeNormals( const PCCPointSet3&                   pointCloud,
                        const PCCKdTree&                      kdtree,
                        const PCCNormalsGenerator3Parameters& params );
   void orientNormals( const PCCPointSet3&                   pointCloud,
                       const PCCKdTree&                      kdtree,
                       const PCCNormalsGenerator3Parameters& params );
-  void addNeighbors( const uint32_t      current,
-                     const PCCPointSet3& pointCloud,
-                     const PCCKdTree&    kdtree,
-                     PCCNNQuery3&        nNQuery,
-                     PCCNNResult&        nNResult,
-                     PCCVector3D&        accumulatedNormals,
-                     size_t&             numberOfNormals );
+  void addNeighbors( const uint32_t  current,
+                     const uint32_t* neighbors,
+                     const size_t    neighborCount,
+                     PCCVector3D&    accumulatedNormals,
+                     size_t&         numberOfNormals );
   void smoothNormals( const PCCPointSet3&                   pointCloud,
                       const PCCKdTree&                      kdtree,
                       const PCCNormalsGenerator3Parameters& params );
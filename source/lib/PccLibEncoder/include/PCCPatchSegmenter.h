@@ -45,6 +45,7 @@ class PCCPatch;
 
 struct PCCPatchSegmenter3Parameters {
   size_t           nnNormalEstimation_;
+  bool             fastNormalEstimation_;
   bool             gridBasedRefineSegmentation_;
   size_t           maxNNCountRefineSegmentation_;
   size_t           iterationCountRefineSegmentation_;
@@ -92,6 +93,38 @@ struct PCCPatchSegmenter3Parameters {
   int              numCutsAlong3rdLongestAxis_;
 };
 
+// Adjacency lists of the points of a point cloud, stored as compressed sparse rows: the neighbors of the point i are
+// the 32-bit indices [ offsets[i]; offsets[i+1] ) of a single array, and their squared distances, when they are
+// computed, are stored at the same positions of a float array.
+class PCCAdjacencyGraph {
+ public:
+  class Neighbors {
+   public:
+    Neighbors( const uint32_t* begin, const uint32_t* end ) : begin_( begin ), end_( end ) {}
+    const uint32_t* begin() const { return begin_; }
+    const uint32_t* end() const { return end_; }
+    size_t          size() const { return end_ - begin_; }
+    uint32_t        operator[]( const size_t index ) const { return begin_[index]; }
+
+   private:
+    const uint32_t* begin_;
+    const uint32_t* end_;
+  };
+  size_t    size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  Neighbors operator[]( const size_t index ) const {
+    return Neighbors( indices_.data() + offsets_[index], indices_.data() + offsets_[index + 1] );
+  }
+  const float*           getDists( const size_t index ) const { return dists_.data() + offsets_[index]; }
+  std::vector<size_t>&   getOffsets() { return offsets_; }
+  std::vector<uint32_t>& getIndices() { return indices_; }
+  std::vector<float>&    getDists() { return dists_; }
+
+ private:
+  std::vector<size_t>   offsets_;
+  std::vector<uint32_t> indices_;
+  std::vector<float>    dists_;
+};
+
 class PCCPatchSegmenter3 {
  public:
   PCCPatchSegmenter3( void ) : nbThread_( 0 ) {}
@@ -118,22 +151,21 @@ class PCCPatchSegmenter3 {
                             const PCCVector3D*          orientations,
                             const size_t                orientationCount,
                             std::vector<size_t>&        partition );
-  void computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                             const PCCKdTree&                  kdtree,
-                             std::vector<std::vector<size_t>>& adj,
-                             const size_t                      maxNNCount );
-
-  void computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                 const PCCKdTree&                  kdtree,
-                                 std::vector<std::vector<size_t>>& adj,
-                                 std::vector<std::vector<double>>& adjDist,
-                                 const size_t                      maxNNCount );
-
-  void computeAdjacencyInfoInRadius( const PCCPointSet3&               pointCloud,
-                                     const PCCKdTree&                  kdtree,
-                                     std::vector<std::vector<size_t>>& adj,
-                                     const size_t                      maxNNCount,
-                                     const size_t                      radius );
+  void computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                             const PCCKdTree&    kdtree,
+                             PCCAdjacencyGraph&  adj,
+                             const size_t        maxNNCount );
+
+  void computeAdjacencyInfoDist( const PCCPointSet3& pointCloud,
+                                 const PCCKdTree&    kdtree,
+                                 PCCAdjacencyGraph&  adj,
+                                 const size_t        maxNNCount );
+
+  void computeAdjacencyInfoInRadius( const PCCPointSet3& pointCloud,
+                                     const PCCKdTree&    kdtree,
+                                     PCCAdjacencyGraph&  adj,
+                                     const size_t        maxNNCount,
+                                     const size_t        radius );
 
   bool colorSimilarity( PCCColor3B& colorD1candidate, PCCColor3B& colorD0, uint8_t threshold ) {
     bool bSimilarity = ( std::abs( colorD0[0] - colorD1candidate[0] ) < threshold ) &&
@@ -281,7 +313,7 @@ class PCCPatchSegmenter3 {
                                           const double                      minGradient,
                                           const size_t                      minNumHighGradientPoints,
                                           std::vector<size_t>&              partition,
-                                          std::vector<std::vector<size_t>>& adj,
+                                          const PCCAdjacencyGraph&          adj,
                                           std::vector<std::vector<size_t>>& connectedComponents );
   static void determinePatchOrientation( const size_t         additionalProjectionAxis,
                                          const bool           absoluteD1,
@@ -306,7 +338,7 @@ class PCCPatchSegmenter3 {
                                  const double                      minGradient,
                                  const size_t                      minNumHighGradientPoints,
                                  PCCPatch&                         patch,
-                                 std::vector<std::vector<size_t>>& adj,
+                                 const PCCAdjacencyGraph&          adj,
                                  std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                  std::vector<bool>&                isRemoved );
 
@@ -44,6 +44,7 @@
 #else
 #include "PCCHMAppVideoEncoder.h"
 #endif
+#include "PCCLosslessVideoEncoder.h"
 
 #include "PCCInternalColorConverter.h"
 #ifdef USE_HDRTOOLS
@@ -60,6 +61,7 @@ class PCCVideoEncoder {
  public:
   PCCVideoEncoder();
   ~PCCVideoEncoder();
+  void setNbThread( size_t nbThread ) { nbThread_ = nbThread; }
   template <typename T>
   bool compress( PCCVideo<T, 3>&    video,
                  const std::string& path,
@@ -105,11 +107,15 @@ class PCCVideoEncoder {
     const bool        yuvVideo          = colorSpaceConversionConfig.empty() || use444CodecIo;
 
     std::shared_ptr<PCCVirtualVideoEncoder<T>> encoder;
+    if ( contexts.getVideoCodecId( bitstream.type() ) == CODEC_LOSSLESS ) {
+      encoder = std::make_shared<PCCLosslessVideoEncoder<T>>( nbThread_ );
+    } else {
 #ifdef USE_HM_VIDEO_CODEC
-    encoder = std::make_shared<PCCHMLibVideoEncoder<T>>();
+      encoder = std::make_shared<PCCHMLibVideoEncoder<T>>();
 #else
-    encoder = std::make_shared<PCCHMAppVideoEncoder<T>>();
+      encoder = std::make_shared<PCCHMAppVideoEncoder<T>>();
 #endif
+    }
     std::shared_ptr<PCCVirtualColorConverter<T>> converter;
     std::string                                  configInverseColorSpace, configColorSpace;
     if ( colorSpaceConversionPath.empty() ) {
@@ -150,8 +156,7 @@ class PCCVideoEncoder {
 
           // iterate the patch information and perform chroma down-sampling on
           // each patch individually
-          std::vector<PCCPatch> patches      = context.getPatches();
-          std::vector<size_t>   blockToPatch = context.getBlockToPatch();
+          std::vector<PCCPatch> patches = context.getPatches();
           for ( int patchIdx = 0; patchIdx <= patches.size(); patchIdx++ ) {
             size_t occupancyResolution;
             size_t patch_left;
@@ -353,7 +358,7 @@ class PCCVideoEncoder {
         }
         // saving the video
         video444.convertYUV444ToYUV420();
-        video = video444;
+        video = std::move( video444 );
       } else {
         converter->convert( configColorSpace, video, colorSpaceConversionPath, fileName + "_rec" );
       }
@@ -410,7 +415,7 @@ class PCCVideoEncoder {
         videoRec.convertYUV420ToYUV444();
         videoRec.setDeprecatedColorFormat( 1 );
       }
-      video = videoRec;
+      video = std::move( videoRec );
     } else {
       if ( keepIntermediateFiles ) { videoRec.write( recYuvFileName, nbyte ); }
       converter->convert( configInverseColorSpace, videoRec, video, colorSpaceConversionPath, fileName + "_rec" );
@@ -421,6 +426,7 @@ class PCCVideoEncoder {
   }
 
  private:
+  size_t nbThread_ = 0;
 };
 
 };  // namespace pcc
@@ -37,12 +37,14 @@
 #include "PCCFrameContext.h"
 #include "PCCPatch.h"
 #include "PCCPatchSegmenter.h"
+#include "PCCPatchRectIndex.h"
 #include "PCCVideoEncoder.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCPointSet.h"
 #include "PCCEncoderParameters.h"
 #include "PCCKdTree.h"
 #include <tbb/tbb.h>
+#include <numeric>
 #include "PCCChrono.h"
 #include "PCCEncoder.h"
 
@@ -107,11 +109,21 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 
   PCCVideoEncoder videoEncoder;
   const size_t    pointCount = sources[0].getPointCount();
+  videoEncoder.setNbThread( params_.nbThread_ );
 
   // GENERATE GEOMETRY VIDEO
   generateGeometryVideo( sources, context );
 
   params_.initializeContext( context );
+  if ( params_.occupancyMapCodecId_ == CODEC_LOSSLESS || params_.geometryMPCodecId_ == CODEC_LOSSLESS ||
+       params_.textureMPCodecId_ == CODEC_LOSSLESS ) {
+    // the video codec ids are bound to the built-in lossless codec by the component codec mapping SEI
+    auto& sei = static_cast<SEIComponentCodecMapping&>( context.addSeiPrefix( COMPONENT_CODEC_MAPPING, true ) );
+    sei.setCodecMappingsCountMinus1( 0 );
+    sei.allocate();
+    sei.setCodecId( 0, CODEC_LOSSLESS );
+    sei.setCodec4cc( CODEC_LOSSLESS, LOSSLESS_CODEC_4CC );
+  }
   auto&             sps  = context.getVps();
   auto&             ai   = sps.getAttributeInformation( atlasIndex );
   auto&             asps = context.getAtlasSequenceParameterSet( atlasIndex );
@@ -575,18 +587,28 @@ void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size
   std::cout << std::endl;
 }
 
-void PCCEncoder::printMapTetris( std::vector<bool> img,
-                                 const size_t      sizeU,
-                                 const size_t      sizeV,
-                                 std::vector<int>  horizon ) {
+void PCCEncoder::printMap( const PCCPackingCanvas& img, const size_t sizeU, const size_t sizeV ) {
+  std::cout << std::endl;
+  std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
+  for ( size_t v = 0; v < sizeV; ++v ) {
+    for ( size_t u = 0; u < sizeU; ++u ) { std::cout << ( img.isOccupied( u, v ) ? 'X' : '.' ); }
+    std::cout << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+void PCCEncoder::printMapTetris( const PCCPackingCanvas& img,
+                                 const size_t            sizeU,
+                                 const size_t            sizeV,
+                                 std::vector<int>        horizon ) {
   std::cout << std::endl;
   std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( int v = 0; v < sizeV; ++v ) {
     for ( int u = 0; u < sizeU; ++u ) {
       if ( v == horizon[u] ) {
-        std::cout << ( img[v * sizeU + u] ? 'U' : 'O' );
+        std::cout << ( img.isOccupied( u, v ) ? 'U' : 'O' );
       } else {
-        std::cout << ( img[v * sizeU + u] ? 'X' : '.' );
+        std::cout << ( img.isOccupied( u, v ) ? 'X' : '.' );
       }
     }
     std::cout << std::endl;
@@ -645,10 +667,10 @@ bool PCCEncoder::generateOccupancyMapVideo( const PCCGroupOfFrames& sources, PCC
   return ret;
 }
 
-bool PCCEncoder::generateOccupancyMapVideo( const size_t           imageWidth,
-                                            const size_t           imageHeight,
-                                            std::vector<uint32_t>& occupancyMap,
-                                            PCCImageOccupancyMap&  videoFrameOccupancyMap ) {
+bool PCCEncoder::generateOccupancyMapVideo( const size_t          imageWidth,
+                                            const size_t          imageHeight,
+                                            std::vector<uint8_t>& occupancyMap,
+                                            PCCImageOccupancyMap& videoFrameOccupancyMap ) {
   const size_t   blockSize0  = params_.occupancyResolution_ / params_.occupancyPrecision_;
   const size_t   pointCount0 = blockSize0 * blockSize0;
   vector<bool>   block0;
@@ -730,17 +752,17 @@ bool PCCEncoder::modifyOccupancyMap( const PCCGroupOfFrames& sources, PCCContext
   return ret;
 }
 
-bool PCCEncoder::modifyOccupancyMap( const size_t           imageWidth,
-                                     const size_t           imageHeight,
-                                     std::vector<uint32_t>& occupancyMap,
-                                     PCCImageOccupancyMap&  videoFrameOccupancyMap,
-                                     std::ofstream&         ofile ) {
+bool PCCEncoder::modifyOccupancyMap( const size_t          imageWidth,
+                                     const size_t          imageHeight,
+                                     std::vector<uint8_t>& occupancyMap,
+                                     PCCImageOccupancyMap& videoFrameOccupancyMap,
+                                     std::ofstream&        ofile ) {
   const size_t numSubBlksV = imageHeight / params_.occupancyPrecision_;
   const size_t numSubBlksH = imageWidth / params_.occupancyPrecision_;
 
   // const size_t threshold = OM_OFFSET / 2;
 
-  std::vector<uint32_t> newOccupancyMap;
+  std::vector<uint8_t> newOccupancyMap;
   newOccupancyMap.resize( imageWidth * imageHeight );
   char tmpC;
 
@@ -1074,6 +1096,11 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
   return sumMaxIOU;
 }
 
+static size_t getPackingOrientation( int packingStrategy, size_t sizeU0, size_t sizeV0, size_t orientationIdx ) {
+  if ( packingStrategy == 0 ) { return PATCH_ORIENTATION_DEFAULT; }
+  return sizeU0 > sizeV0 ? orientation_horizontal[orientationIdx] : orientation_vertical[orientationIdx];
+}
+
 void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
                                                  PCCFrameContext& prevFrame,
                                                  int              packingStrategy,
@@ -1099,16 +1126,25 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
   matchedPatches.clear();
   float  thresholdIOU    = 0.2F;
   size_t bestRefFrameIdx = 0;
+  // the patches that can match a previous patch are the ones of the same bucket that overlap it.
+  PCCPatchRectIndex   rectIndex( patches );
+  std::vector<size_t> unmatchedCounts( rectIndex.getBucketCount() );
+  std::vector<size_t> candidates;
+  for ( const auto& cpatch : patches ) {
+    if ( cpatch.getBestMatchIdx() == InvalidPatchIndex ) { unmatchedCounts[rectIndex.getBucket( cpatch )]++; }
+  }
   // main loop.
   for ( auto& patch : prevPatches ) {
     id++;
-    float maxIou  = 0.0F;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == InvalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
-        patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
+    float     maxIou  = 0.0F;
+    int       bestIdx = -1;
+    const int bucket  = rectIndex.getBucket( patch );
+    if ( bucket >= 0 && unmatchedCounts[bucket] > 0 ) {
+      patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
+      rectIndex.getCandidates( bucket, patch, candidates );
+      for ( const auto cId : candidates ) {
+        auto& cpatch = patches[cId];
+        if ( cpatch.getBestMatchIdx() != InvalidPatchIndex ) { continue; }
         Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
         Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
         float iou   = computeIOU( rect, crect );
@@ -1116,8 +1152,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
           maxIou  = iou;
           bestIdx = cId;
         }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
+      }
     }
 
     if ( maxIou > thresholdIOU ) {
@@ -1126,6 +1161,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
       patches[bestIdx].setPatchType( static_cast<uint8_t>( P_INTER ) );
       patches[bestIdx].setRefAtlasFrameIndex( bestRefFrameIdx );
       matchedPatches.push_back( patches[bestIdx] );
+      unmatchedCounts[bucket]--;
     }
   }
 
@@ -1169,8 +1205,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
   size_t maxOccupancyRow{0};
 
   int               numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
   if ( !params_.enablePointCloudPartitioning_ ) {
     for ( auto& patch : patches ) {
       assert( patch.getSizeU0() <= occupancySizeU );
@@ -1183,7 +1218,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
           // try to place on the same position as the matched patch
           patch.getU0() = prevPatches[patch.getBestMatchIdx()].getU0();
           patch.getV0() = prevPatches[patch.getBestMatchIdx()].getV0();
-          if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_ ) ) {
+          if ( patch.checkFitPatchCanvas( occupancyMap, params_.lowDelayEncoding_ ) ) {
             locationFound = true;
             if ( printDetailedInfo ) {
               std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
@@ -1193,12 +1228,13 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
           }
           // if the patch couldn't fit, try to fit the patch in the top left
           // position
+          PCCPackingFootprint footprint;
+          patch.getPackingFootprint( footprint, patch.getPatchOrientation(), params_.lowDelayEncoding_, safeguard );
           for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-            for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
+            for ( int u = occupancyMap.getFirstCandidate( footprint, v ); u <= occupancySizeU && !locationFound; ++u ) {
               patch.getU0() = u;
               patch.getV0() = v;
-              if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                              safeguard ) ) {
+              if ( occupancyMap.checkFit( footprint, u, v ) ) {
                 locationFound = true;
                 if ( printDetailedInfo ) {
                   std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
@@ -1209,8 +1245,16 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
           }
         } else {
           // best effort
+          std::vector<PCCPackingFootprint> footprints( numOrientations );
+          for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+            patch.getPackingFootprint(
+                footprints[orientationIdx],
+                getPackingOrientation( packingStrategy, patch.getSizeU0(), patch.getSizeV0(), orientationIdx ),
+                params_.lowDelayEncoding_, safeguard );
+          }
           for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-            for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+            for ( size_t u = occupancyMap.getFirstCandidate( footprints, v ); u < occupancySizeU && !locationFound;
+                  ++u ) {
               patch.getU0() = u;
               patch.getV0() = v;
               for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
@@ -1223,8 +1267,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
                     patch.getPatchOrientation() = orientation_vertical[orientationIdx];
                   }
                 }
-                if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                                safeguard ) ) {
+                if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
                   locationFound = true;
                   if ( printDetailedInfo ) {
                     std::cout << "Orientation " << patch.getPatchOrientation() << " selected for unmatched patch "
@@ -1237,16 +1280,14 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
         }
         if ( !locationFound ) {
           occupancySizeV *= 2;
-          occupancyMap.resize( occupancySizeU * occupancySizeV );
+          occupancyMap.resize( occupancySizeU, occupancySizeV );
         }
       }
       for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-          if ( params_.lowDelayEncoding_ ) {
-            occupancyMap[coord] = true;
-          } else {
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( params_.lowDelayEncoding_ || occupancy[v0 * patch.getSizeU0() + u0] ) {
+            occupancyMap.setOccupied( coord );
           }
         }
       }
@@ -1313,8 +1354,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
               tile.minV = ( tileIndex / numTilesHor ) * tileHeight;
               tile.maxV = tile.minV + tileHeight - 1;
 
-              if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                              safeguard, tile ) ) {
+              if ( patch.checkFitPatchCanvas( occupancyMap, params_.lowDelayEncoding_, safeguard, tile ) ) {
                 locationFound = true;
                 std::cout << "ROI-" << roiIndex + 1 << " patch-" << patch.getIndex() << " fitted in tile-"
                           << tileIndex + 1 << "/" << numTilesAvailable << "-----[" << tile.minU << "," << tile.maxU
@@ -1331,6 +1371,8 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
             }
             // if the patch couldn't fit, try to fit the patch in the top left
             // position
+            PCCPackingFootprint footprint;
+            patch.getPackingFootprint( footprint, patch.getPatchOrientation(), params_.lowDelayEncoding_, safeguard );
             numTilesAvailable = ceil( double( occupancySizeV ) / double( tileHeight ) ) * numTilesHor;
             for ( int tileIndex = lastOccupiedTileIndexByPrevROI + 1; tileIndex < numTilesAvailable && !locationFound;
                   ++tileIndex ) {
@@ -1340,7 +1382,8 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
               tile.minV = ( tileIndex / numTilesHor ) * tileHeight;
               tile.maxV = tile.minV + tileHeight - 1;
               for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-                for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
+                for ( int u = occupancyMap.getFirstCandidate( footprint, v ); u <= occupancySizeU && !locationFound;
+                      ++u ) {
                   patch.getU0()        = u;
                   patch.getV0()        = v;
                   bool tileIsAvailable = true;
@@ -1354,8 +1397,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
                     }
                   }
                   if ( tileIsAvailable ) {
-                    if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard, tile ) ) {
+                    if ( occupancyMap.checkFit( footprint, u, v, tile ) ) {
                       locationFound = true;
                       if ( tileIndex > lastOccupiedTileIndex ) { lastOccupiedTileIndex = tileIndex; }
                       std::cout << "ROI-" << roiIndex + 1 << " patch-" << patch.getIndex() << " fitted in tile-"
@@ -1375,6 +1417,13 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
             }
           } else {
             // best effort
+            std::vector<PCCPackingFootprint> footprints( numOrientations );
+            for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+              patch.getPackingFootprint(
+                  footprints[orientationIdx],
+                  getPackingOrientation( packingStrategy, patch.getSizeU0(), patch.getSizeV0(), orientationIdx ),
+                  params_.lowDelayEncoding_, safeguard );
+            }
             numTilesAvailable = ceil( double( occupancySizeV ) / double( tileHeight ) ) * numTilesHor;
             for ( int tileIndex = lastOccupiedTileIndexByPrevROI + 1; tileIndex < numTilesAvailable && !locationFound;
                   ++tileIndex ) {
@@ -1384,7 +1433,8 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
               tile.minV = ( tileIndex / numTilesHor ) * tileHeight;
               tile.maxV = tile.minV + tileHeight - 1;
               for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-                for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+                for ( size_t u = occupancyMap.getFirstCandidate( footprints, v ); u < occupancySizeU && !locationFound;
+                      ++u ) {
                   patch.getU0()        = u;
                   patch.getV0()        = v;
                   bool tileIsAvailable = true;
@@ -1409,8 +1459,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
                           patch.getPatchOrientation() = orientation_vertical[orientationIdx];
                         }
                       }
-                      if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                      params_.lowDelayEncoding_, safeguard, tile ) ) {
+                      if ( occupancyMap.checkFit( footprints[orientationIdx], u, v, tile ) ) {
                         locationFound = true;
                         if ( tileIndex > lastOccupiedTileIndex ) { lastOccupiedTileIndex = tileIndex; }
                         std::cout << "ROI-" << roiIndex + 1 << " patch-" << patch.getIndex() << " fitted in tile-"
@@ -1430,13 +1479,13 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& frame,
           }
           if ( !locationFound ) {
             occupancySizeV *= 2;
-            occupancyMap.resize( occupancySizeU * occupancySizeV );
+            occupancyMap.resize( occupancySizeU, occupancySizeV );
           }
         }  // while loop
         for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
           for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
             int coord           = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+            if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.setOccupied( coord ); }
           }
         }
         if ( !( patch.isPatchDimensionSwitched() ) ) {
@@ -1481,18 +1530,23 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
   vector<PCCPatch> tmpPatches;
   matchedPatches.clear();
   float thresholdIOU = 0.2F;
+  // the patches that can match a previous patch are the ones of the same bucket that overlap it.
+  PCCPatchRectIndex   rectIndex( patches );
+  std::vector<size_t> candidates;
 
   // main loop.
   for ( auto& patch : prevPatches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     id++;
-    float maxIou  = 0.0;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == -1 ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
+    float     maxIou  = 0.0;
+    int       bestIdx = -1;
+    const int bucket  = rectIndex.getBucket( patch );
+    if ( bucket >= 0 ) {
+      rectIndex.getCandidates( bucket, patch, candidates );
+      for ( const auto cId : candidates ) {
+        auto& cpatch = patches[cId];
+        if ( cpatch.getBestMatchIdx() != -1 ) { continue; }
         Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
         Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
         float iou   = computeIOU( rect, crect );
@@ -1500,8 +1554,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
           maxIou  = iou;
           bestIdx = cId;
         }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
+      }
     }
 
     if ( maxIou > thresholdIOU ) {
@@ -1542,8 +1595,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
 
@@ -1568,6 +1620,8 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
         patch.getPatchOrientation() = prevPatches[patch.getBestMatchIdx()].getPatchOrientation();
         best_orientation            = patch.getPatchOrientation();
         // spiral search to find the closest available position
+        PCCPackingFootprint footprint;
+        patch.getPackingFootprint( footprint, patch.getPatchOrientation(), params_.lowDelayEncoding_, safeguard );
         int x   = 0;
         int y   = 0;
         int end = ( std::max )( occupancySizeU, occupancySizeV ) * ( std::max )( occupancySizeU, occupancySizeV ) * 4;
@@ -1579,8 +1633,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
           if ( xp >= 0 && xp < occupancySizeU && yp >= 0 && yp < occupancySizeV ) {
             patch.getU0() = xp;
             patch.getV0() = yp;
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
+            if ( occupancyMap.checkFit( footprint, xp, yp ) ) {
               locationFound = true;
               best_u        = xp;
               best_v        = yp;
@@ -1602,6 +1655,11 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
             PATCH_ORIENTATION_MIRROR,  PATCH_ORIENTATION_MROT180, PATCH_ORIENTATION_ROT270,
             PATCH_ORIENTATION_MROT90,  PATCH_ORIENTATION_ROT90};  // favoring vertical orientation
         int numOrientations = params_.useEightOrientations_ ? 8 : 2;
+        std::vector<PCCPackingFootprint> footprints( numOrientations );
+        for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+          patch.getPackingFootprint( footprints[orientationIdx], orientation_values[orientationIdx],
+                                     params_.lowDelayEncoding_, safeguard );
+        }
         // tetris packing
         for ( size_t u = 0; u < occupancySizeU; ++u ) {
           for ( size_t v = 0; v < occupancySizeV; ++v ) {
@@ -1617,8 +1675,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
                 }
                 continue;
               }
-              if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                              safeguard ) ) {
+              if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
                 // now calculate the wasted space
                 int wasted_space =
                     patch.calculate_wasted_space( horizon, top_horizon, bottom_horizon, right_horizon, left_horizon );
@@ -1636,7 +1693,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       } else {
         // select the best position and orientation
         patch.getU0()               = best_u;
@@ -1659,10 +1716,8 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame, PCCFrameC
     for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-        if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+        if ( params_.lowDelayEncoding_ || occupancy[v0 * patch.getSizeU0() + u0] ) {
+          occupancyMap.setOccupied( coord );
         }
       }
     }
@@ -1717,15 +1772,20 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& frame, PCCF
   int              id = 0;
   matchedPatches.clear();
   float thresholdIOU = 0.2F;
+  // the patches that can match a previous patch are the ones of the same bucket that overlap it.
+  PCCPatchRectIndex   rectIndex( patches );
+  std::vector<size_t> candidates;
   // main loop.
   for ( auto& patch : prevPatches ) {
     id++;
-    float maxIou  = 0.0F;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == InvalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
+    float     maxIou  = 0.0F;
+    int       bestIdx = -1;
+    const int bucket  = rectIndex.getBucket( patch );
+    if ( bucket >= 0 ) {
+      rectIndex.getCandidates( bucket, patch, candidates );
+      for ( const auto cId : candidates ) {
+        auto& cpatch = patches[cId];
+        if ( cpatch.getBestMatchIdx() != InvalidPatchIndex ) { continue; }
         Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
         Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
         float iou   = computeIOU( rect, crect );
@@ -1733,8 +1793,7 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& frame, PCCF
           maxIou  = iou;
           bestIdx = cId;
         }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
+      }
     }
     if ( maxIou > thresholdIOU ) {
       // checking the size of the matched patches
@@ -2060,8 +2119,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context ) {
       }
       numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-      std::vector<bool> occupancyMap;
-      occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+      PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
       int indNextMatchedPatch = 0;
       // patch loop
       for ( int patchIdx = 0; patchIdx < patchMatrixSortedIndexes[frameIdx].size(); patchIdx++ ) {
@@ -2110,8 +2168,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context ) {
                   previousGlobalElem.getV0() +
                   ( curGlobalElem.getU1() - previousGlobalElem.getU1() ) / curPatchElem.elem->getOccupancyResolution();
             }
-            if ( curGlobalElem.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_ ) ) {
+            if ( curGlobalElem.checkFitPatchCanvas( occupancyMap, params_.lowDelayEncoding_ ) ) {
               locationFound = true;
               if ( params_.packingStrategy_ == 2 ) {
                 // saving the best position for tetris packing
@@ -2186,8 +2243,20 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context ) {
               curGlobalElem.getPatchOrientation() = patchMatrix[frameIdx - 1][matchedIdx].elem->getPatchOrientation();
             }
             // best effort
+            std::vector<PCCPackingFootprint> footprints( numOrientations );
+            for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+              size_t orientation = curGlobalElem.getPatchOrientation();
+              if ( curPatchElem.elem->getBestMatchIdx() == InvalidPatchIndex ) {
+                orientation = curGlobalElem.getSizeU0() > curGlobalElem.getSizeV0()
+                                  ? orientation_horizontal[orientationIdx]
+                                  : orientation_vertical[orientationIdx];
+              }
+              curGlobalElem.getPackingFootprint( footprints[orientationIdx], orientation, params_.lowDelayEncoding_,
+                                                 0 );
+            }
             for ( size_t v = 0; v < occupancySizeV && ( ( params_.packingStrategy_ == 2 ) || !locationFound ); ++v ) {
-              for ( size_t u = 0; u < occupancySizeU && ( ( params_.packingStrategy_ == 2 ) || !locationFound ); ++u ) {
+              for ( size_t u = occupancyMap.getFirstCandidate( footprints, v );
+                    u < occupancySizeU && ( ( params_.packingStrategy_ == 2 ) || !locationFound ); ++u ) {
                 curGlobalElem.getU0() = u;
                 curGlobalElem.getV0() = v;
                 for ( size_t orientationIdx = 0;
@@ -2206,8 +2275,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context ) {
                       continue;
                     }
                   }
-                  if ( curGlobalElem.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                          params_.lowDelayEncoding_ ) ) {
+                  if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
                     if ( params_.packingStrategy_ == 2 ) {
                       // now calculate the wasted space
                       int wasted_space = curGlobalElem.calculate_wasted_space( horizon, top_horizon, bottom_horizon,
@@ -2283,7 +2351,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context ) {
           }
           if ( !locationFound ) {
             occupancySizeV *= 2;
-            occupancyMap.resize( occupancySizeU * occupancySizeV );
+            occupancyMap.resize( occupancySizeU, occupancySizeV );
             if ( printDetailedInfo ) {
               std::cout << "Increasing the canvas size (" << occupancySizeU << "," << occupancySizeV << ")"
                         << std::endl;
@@ -2347,10 +2415,8 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context ) {
         for ( size_t v0 = 0; v0 < curGlobalElem.getSizeV0(); ++v0 ) {
           for ( size_t u0 = 0; u0 < curGlobalElem.getSizeU0(); ++u0 ) {
             int coord = curGlobalElem.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-            if ( params_.lowDelayEncoding_ ) {
-              occupancyMap[coord] = true;
-            } else {
-              occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curGlobalElem.getSizeU0() + u0];
+            if ( params_.lowDelayEncoding_ || occupancy[v0 * curGlobalElem.getSizeU0() + u0] ) {
+              occupancyMap.setOccupied( coord );
             }
           }
         }
@@ -2434,18 +2500,25 @@ void PCCEncoder::packFlexible( PCCFrameContext& frame,
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  int               numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
+  int              numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   if ( !params_.enablePointCloudPartitioning_ ) {
     for ( auto& patch : patches ) {
       assert( patch.getSizeU0() <= occupancySizeU );
       assert( patch.getSizeV0() <= occupancySizeV );
       bool  locationFound = false;
       auto& occupancy     = patch.getOccupancy();
+      std::vector<PCCPackingFootprint> footprints( numOrientations );
+      for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+        patch.getPackingFootprint(
+            footprints[orientationIdx],
+            getPackingOrientation( packingStrategy, patch.getSizeU0(), patch.getSizeV0(), orientationIdx ),
+            params_.lowDelayEncoding_, safeguard );
+      }
       while ( !locationFound ) {
         for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-          for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+          for ( size_t u = occupancyMap.getFirstCandidate( footprints, v ); u < occupancySizeU && !locationFound;
+                ++u ) {
             patch.getU0() = u;
             patch.getV0() = v;
             for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
@@ -2458,8 +2531,7 @@ void PCCEncoder::packFlexible( PCCFrameContext& frame,
                   patch.getPatchOrientation() = orientation_vertical[orientationIdx];
                 }
               }
-              if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                              safeguard ) ) {
+              if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
                 locationFound = true;
                 if ( printDetailedInfo ) {
                   std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch "
@@ -2471,16 +2543,14 @@ void PCCEncoder::packFlexible( PCCFrameContext& frame,
         }
         if ( !locationFound ) {
           occupancySizeV *= 2;
-          occupancyMap.resize( occupancySizeU * occupancySizeV );
+          occupancyMap.resize( occupancySizeU, occupancySizeV );
         }
       }
       for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-          if ( params_.lowDelayEncoding_ ) {
-            occupancyMap[coord] = true;
-          } else {
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( params_.lowDelayEncoding_ || occupancy[v0 * patch.getSizeU0() + u0] ) {
+            occupancyMap.setOccupied( coord );
           }
         }
       }
@@ -2521,6 +2591,13 @@ void PCCEncoder::packFlexible( PCCFrameContext& frame,
         assert( patch.getSizeV0() <= occupancySizeV );
         bool  locationFound = false;
         auto& occupancy     = patch.getOccupancy();
+        std::vector<PCCPackingFootprint> footprints( numOrientations );
+        for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+          patch.getPackingFootprint(
+              footprints[orientationIdx],
+              getPackingOrientation( packingStrategy, patch.getSizeU0(), patch.getSizeV0(), orientationIdx ),
+              params_.lowDelayEncoding_, safeguard );
+        }
         // fit patch in available tiles (i.e., tiles not occupied by previous
         // ROIs)
         while ( !locationFound ) {
@@ -2533,7 +2610,8 @@ void PCCEncoder::packFlexible( PCCFrameContext& frame,
             tile.minV = ( tileIndex / numTilesHor ) * tileHeight;
             tile.maxV = tile.minV + tileHeight - 1;
             for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-              for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+              for ( size_t u = occupancyMap.getFirstCandidate( footprints, v ); u < occupancySizeU && !locationFound;
+                    ++u ) {
                 patch.getU0()        = u;
                 patch.getV0()        = v;
                 bool tileIsAvailable = true;
@@ -2558,8 +2636,7 @@ void PCCEncoder::packFlexible( PCCFrameContext& frame,
                         patch.getPatchOrientation() = orientation_vertical[orientationIdx];
                       }
                     }
-                    if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard, tile ) ) {
+                    if ( occupancyMap.checkFit( footprints[orientationIdx], u, v, tile ) ) {
                       locationFound = true;
                       if ( tileIndex > lastOccupiedTileIndex ) { lastOccupiedTileIndex = tileIndex; }
                       std::cout << "ROI-" << roiIndex + 1 << " patch-" << patch.getIndex() << " fitted in tile-"
@@ -2577,13 +2654,13 @@ void PCCEncoder::packFlexible( PCCFrameContext& frame,
           }
           if ( !locationFound ) {
             occupancySizeV *= 2;
-            occupancyMap.resize( occupancySizeU * occupancySizeV );
+            occupancyMap.resize( occupancySizeU, occupancySizeV );
           }
         }  // while loop
         for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
           for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
             int coord           = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+            if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.setOccupied( coord ); }
           }
         }
 
@@ -2639,8 +2716,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, int safeguard ) {
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
   if ( printDetailedInfo ) {
@@ -2669,6 +2745,11 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, int safeguard ) {
         PATCH_ORIENTATION_MIRROR,  PATCH_ORIENTATION_MROT180, PATCH_ORIENTATION_ROT270,
         PATCH_ORIENTATION_MROT90,  PATCH_ORIENTATION_ROT90};  // favoring vertical orientation
     int numOrientations = params_.useEightOrientations_ ? 8 : 2;
+    std::vector<PCCPackingFootprint> footprints( numOrientations );
+    for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+      patch.getPackingFootprint( footprints[orientationIdx], orientation_values[orientationIdx],
+                                 params_.lowDelayEncoding_, safeguard );
+    }
     while ( !locationFound ) {
       int    best_wasted_space = ( std::numeric_limits<int>::max )();
       size_t best_u;
@@ -2691,8 +2772,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, int safeguard ) {
             if ( printDetailedInfo ) {
               std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ")" << std::endl;
             }
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
+            if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
               // now calculate the wasted space
               int wasted_space =
                   patch.calculate_wasted_space( horizon, top_horizon, bottom_horizon, right_horizon, left_horizon );
@@ -2710,7 +2790,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, int safeguard ) {
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
         if ( printDetailedInfo ) {
           std::cout << "Increasing frame size (" << occupancySizeU << "," << occupancySizeV << ")" << std::endl;
         }
@@ -2736,10 +2816,8 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, int safeguard ) {
     for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-        if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+        if ( params_.lowDelayEncoding_ || occupancy[v0 * patch.getSizeU0() + u0] ) {
+          occupancyMap.setOccupied( coord );
         }
       }
     }
@@ -2769,7 +2847,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, int safeguard ) {
 }
 
 void PCCEncoder::packEOMTexturePointsPatch( PCCFrameContext&   frame,
-                                            std::vector<bool>& occupancyMap,
+                                            PCCPackingCanvas&  occupancyMap,
                                             size_t&            width,
                                             size_t&            height,
                                             size_t             occupancySizeU,
@@ -2797,12 +2875,12 @@ void PCCEncoder::packEOMTexturePointsPatch( PCCFrameContext&   frame,
 #endif
     lastHeight += eomPatches[i].sizeV_ * params_.occupancyResolution_;
   }
-  occupancyMap.resize( occupancySizeU * occupancySizeV );
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   height = lastHeight;
 }
 
 void PCCEncoder::packRawPointsPatch( PCCFrameContext&   frame,
-                                     std::vector<bool>& occupancyMap,
+                                     PCCPackingCanvas&  occupancyMap,
                                      size_t&            width,
                                      size_t&            height,
                                      size_t             occupancySizeU,
@@ -2852,22 +2930,23 @@ void PCCEncoder::packRawPointsPatch( PCCFrameContext&   frame,
     }
 
     // now placing the raw points patch in the atlas
-    bool locationFound = false;
+    bool                locationFound = false;
+    PCCPackingFootprint footprint;
+    patch.getPackingFootprint( footprint, PATCH_ORIENTATION_DEFAULT, params_.lowDelayEncoding_, safeguard );
     while ( !locationFound ) {
       patch.getPatchOrientation() = PATCH_ORIENTATION_DEFAULT;  // only allowed orientation in anchor
       for ( int v = maxOccupancyRow; v <= occupancySizeV && !locationFound; ++v ) {
-        for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
+        for ( int u = occupancyMap.getFirstCandidate( footprint, v ); u <= occupancySizeU && !locationFound; ++u ) {
           patch.getU0() = u;
           patch.getV0() = v;
-          if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                          safeguard ) ) {
+          if ( occupancyMap.checkFit( footprint, u, v ) ) {
             locationFound = true;
           }
         }
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       }
     }
     rawPointsPatch.u0_ = patch.getU0();
@@ -2877,11 +2956,8 @@ void PCCEncoder::packRawPointsPatch( PCCFrameContext&   frame,
       const size_t v = rawPointsPatch.v0_ + v0;
       for ( size_t u0 = 0; u0 < rawPointsPatch.sizeU0_; ++u0 ) {
         const size_t u = rawPointsPatch.u0_ + u0;
-        if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[v * occupancySizeU + u] = true;
-        } else {
-          occupancyMap[v * occupancySizeU + u] =
-              occupancyMap[v * occupancySizeU + u] || rawPointsPatchOccupancy[v0 * rawPointsPatch.sizeU0_ + u0];
+        if ( params_.lowDelayEncoding_ || rawPointsPatchOccupancy[v0 * rawPointsPatch.sizeU0_ + u0] ) {
+          occupancyMap.setOccupied( u, v );
         }
       }
       height = ( std::max )( height, ( patch.getV0() + patch.getSizeV0() ) * params_.occupancyResolution_ );
@@ -3051,6 +3127,20 @@ bool PCCEncoder::generateGeometryVideo( const PCCPointSet3&                 sour
                                         PCCFrameContext&                    prevFrame,
                                         size_t                              frameIndex,
                                         float&                              distanceSrcRec ) {
+  if ( !generatePatches( source, frame, segmenterParams, videoGeometry, prevFrame, frameIndex, distanceSrcRec ) ) {
+    return false;
+  }
+  packPatches( frame, prevFrame, frameIndex );
+  return true;
+}
+
+bool PCCEncoder::generatePatches( const PCCPointSet3&                 source,
+                                  PCCFrameContext&                    frame,
+                                  const PCCPatchSegmenter3Parameters& segmenterParams,
+                                  PCCVideoGeometry&                   videoGeometry,
+                                  PCCFrameContext&                    prevFrame,
+                                  size_t                              frameIndex,
+                                  float&                              distanceSrcRec ) {
   if ( source.getPointCount() == 0u ) { return false; }
 
   if ( segmenterParams.additionalProjectionPlaneMode_ != 5 ) {
@@ -3082,6 +3172,10 @@ bool PCCEncoder::generateGeometryVideo( const PCCPointSet3&                 sour
   }
 
   if ( params_.enhancedOccupancyMapCode_ ) { generateEomPatch( source, frame ); }
+  return true;
+}
+
+void PCCEncoder::packPatches( PCCFrameContext& frame, PCCFrameContext& prevFrame, size_t frameIndex ) {
   if ( params_.packingStrategy_ == 0 || params_.packingStrategy_ == 1 ) {
     if ( ( frameIndex == 0 ) || ( !params_.constrainedPack_ ) )
       packFlexible( frame, params_.packingStrategy_, params_.safeGuardDistance_,
@@ -3107,20 +3201,18 @@ bool PCCEncoder::generateGeometryVideo( const PCCPointSet3&                 sour
       }
     }
   }
-
-  return true;
 }
 
 void PCCEncoder::geometryGroupDilation( PCCContext& context ) {
-  auto& videoGeometry         = context.getVideoGeometryMultiple()[0];
-  auto& videoGeometryMultiple = context.getVideoGeometryMultiple();
-  auto  videoOccupancyMap     = context.getVideoOccupancyMap();
-  auto& frames                = context.getFrames();
+  auto&       videoGeometry         = context.getVideoGeometryMultiple()[0];
+  auto&       videoGeometryMultiple = context.getVideoGeometryMultiple();
+  const auto& videoOccupancyMap     = context.getVideoOccupancyMap();
+  auto&       frames                = context.getFrames();
   for ( size_t f = 0; f < frames.size(); ++f ) {
-    auto& frame        = frames[f];
-    auto& width        = frame.getWidth();
-    auto& height       = frame.getHeight();
-    auto& occupancyMap = videoOccupancyMap.getFrame( f );
+    auto&       frame        = frames[f];
+    auto&       width        = frame.getWidth();
+    auto&       height       = frame.getHeight();
+    const auto& occupancyMap = videoOccupancyMap.getFrame( f );
     auto& frame1 = params_.multipleStreams_ ? videoGeometryMultiple[0].getFrame( f ) : videoGeometry.getFrame( 2 * f );
     auto& frame2 =
         params_.multipleStreams_ ? videoGeometryMultiple[1].getFrame( f ) : videoGeometry.getFrame( 2 * f + 1 );
@@ -3285,7 +3377,10 @@ void PCCEncoder::create3DMotionEstimationFiles( const PCCGroupOfFrames& sources,
     auto&        blockToPatch       = frame.getBlockToPatch();
     const size_t blockToPatchWidth  = frame.getWidth() / params_.occupancyResolution_;
     const size_t blockToPatchHeight = frame.getHeight() / params_.occupancyResolution_;
-    fwrite( &blockToPatch[0], sizeof( size_t ), blockToPatchHeight * blockToPatchWidth, blockToPatchFile );
+    // the file read by the video encoder keeps its size_t entries
+    const std::vector<size_t> blockToPatchFileData( blockToPatch.begin(),
+                                                    blockToPatch.begin() + blockToPatchHeight * blockToPatchWidth );
+    fwrite( blockToPatchFileData.data(), sizeof( size_t ), blockToPatchFileData.size(), blockToPatchFile );
     // fwrite( &occupancyMap[0], sizeof( uint32_t ), frame.getHeight() *
     // frame.getWidth(), occupancyFile );
     uint32_t zeroVal = 0;
@@ -3934,13 +4029,12 @@ void PCCEncoder::generateRawPointsGeometryImage( PCCContext&       context,
                                                  PCCImageGeometry& image ) {
   size_t width = context.getRawGeoWidth();
 
-  const int16_t     infiniteDepth = ( std::numeric_limits<int16_t>::max )();
-  std::vector<bool> pcmOccupancyMap;
-  size_t            pcmOccupancySizeU = width / params_.occupancyResolution_;
-  size_t            pcmOccupancySizeV = 1;
-  size_t            pcmHeight         = 0;
-  size_t            pcmWidth          = width;
-  pcmOccupancyMap.resize( pcmOccupancySizeU * pcmOccupancySizeV, false );
+  const int16_t    infiniteDepth     = ( std::numeric_limits<int16_t>::max )();
+  size_t           pcmOccupancySizeU = width / params_.occupancyResolution_;
+  size_t           pcmOccupancySizeV = 1;
+  size_t           pcmHeight         = 0;
+  size_t           pcmWidth          = width;
+  PCCPackingCanvas pcmOccupancyMap( pcmOccupancySizeU, pcmOccupancySizeV );
   packRawPointsPatch( frame, pcmOccupancyMap, pcmWidth, pcmHeight, pcmOccupancySizeU, pcmOccupancySizeV, 0 );
   image.resize( pcmWidth, pcmHeight, PCCCOLORFORMAT::YUV444 );
   image.set( 0 );
@@ -4098,6 +4192,7 @@ bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCCont
   auto&                        videoGeometry  = context.getVideoGeometryMultiple()[0];
   auto&                        frames         = context.getFrames();
   params.nnNormalEstimation_                  = params_.nnNormalEstimation_;
+  params.fastNormalEstimation_                = params_.fastNormalEstimation_;
   params.gridBasedRefineSegmentation_         = params_.gridBasedRefineSegmentation_;
   params.maxNNCountRefineSegmentation_        = params_.maxNNCountRefineSegmentation_;
   params.iterationCountRefineSegmentation_    = params_.iterationCountRefineSegmentation_;
@@ -4151,14 +4246,45 @@ bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCCont
     params.weightNormal_ = frames[0].getWeightNormal();
   }
   float sumDistanceSrcRec = 0;
-  for ( size_t i = 0; i < frames.size(); i++ ) {
-    size_t preIndex       = i > 0 ? ( i - 1 ) : 0;
-    float  distanceSrcRec = 0;
-    if ( !generateGeometryVideo( sources[i], frames[i], params, videoGeometry, frames[preIndex], i, distanceSrcRec ) ) {
-      res = false;
-      break;
+  if ( params_.nbFrameParallelSegmentation_ > 1 && params_.additionalProjectionPlaneMode_ != 5 ) {
+    // The patches of several frames are generated concurrently. Only the packing, that depends on the packing of
+    // the previous frame, is serialized and executed in the frame order.
+    std::vector<float>   distanceSrcRec( frames.size(), 0.F );
+    std::vector<uint8_t> generated( frames.size(), 0 );
+    tbb::flow::graph     graph;
+    tbb::flow::function_node<size_t, size_t> segmentation(
+        graph, params_.nbFrameParallelSegmentation_, [&]( const size_t i ) {
+          size_t preIndex = i > 0 ? ( i - 1 ) : 0;
+          generated[i]    = static_cast<uint8_t>(
+              generatePatches( sources[i], frames[i], params, videoGeometry, frames[preIndex], i, distanceSrcRec[i] ) );
+          return i;
+        } );
+    tbb::flow::sequencer_node<size_t> sequencer( graph, []( const size_t i ) { return i; } );
+    tbb::flow::function_node<size_t>  packing( graph, tbb::flow::serial, [&]( const size_t i ) {
+      if ( !res ) { return; }
+      if ( generated[i] == 0u ) {
+        res = false;
+        return;
+      }
+      size_t preIndex = i > 0 ? ( i - 1 ) : 0;
+      packPatches( frames[i], frames[preIndex], i );
+      sumDistanceSrcRec += distanceSrcRec[i];
+    } );
+    tbb::flow::make_edge( segmentation, sequencer );
+    tbb::flow::make_edge( sequencer, packing );
+    for ( size_t i = 0; i < frames.size(); i++ ) { segmentation.try_put( i ); }
+    graph.wait_for_all();
+  } else {
+    for ( size_t i = 0; i < frames.size(); i++ ) {
+      size_t preIndex       = i > 0 ? ( i - 1 ) : 0;
+      float  distanceSrcRec = 0;
+      if ( !generateGeometryVideo( sources[i], frames[i], params, videoGeometry, frames[preIndex], i,
+                                   distanceSrcRec ) ) {
+        res = false;
+        break;
+      }
+      sumDistanceSrcRec += distanceSrcRec;
     }
-    sumDistanceSrcRec += distanceSrcRec;
   }
   if ( params_.pointLocalReconstruction_ || params_.singleMapPixelInterleaving_ ) {
     const float distanceSrcRec = sumDistanceSrcRec / static_cast<float>( frames.size() );
@@ -4176,6 +4302,18 @@ bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCCont
   return res;
 }
 
+// Returns the larger of the mean squared distances from the source to the reconstruction and from the reconstruction
+// to the source, as PCCPointSet3::distanceGeo, with the kd-tree of the source built by the caller.
+static float pointLocalReconstructionDistance( const PCCPointSet3& source,
+                                               const PCCKdTree&    sourceKdtree,
+                                               const PCCPointSet3& reconstruct ) {
+  float distancePSrcRec = 0.F;
+  float distancePRecSrc = 0.F;
+  source.distance( PCCKdTree( reconstruct ), distancePSrcRec );
+  reconstruct.distance( sourceKdtree, distancePRecSrc );
+  return ( std::max )( distancePSrcRec, distancePRecSrc );
+}
+
 void PCCEncoder::pointLocalReconstructionSearch( PCCContext& context, const GeneratePointCloudParameters& params ) {
   auto& frames                = context.getFrames();
   auto& videoGeometryMultiple = context.getVideoGeometryMultiple();
@@ -4186,13 +4324,13 @@ void PCCEncoder::pointLocalReconstructionSearch( PCCContext&
                                                  PCCFrameContext&                     frame,
                                                  const std::vector<PCCVideoGeometry>& videoMultiple,
                                                  const GeneratePointCloudParameters&  params ) {
-  auto&                 patches         = frame.getPatches();
-  auto&                 blockToPatch    = frame.getBlockToPatch();
-  auto&                 occupancyMapOrg = frame.getOccupancyMap();
-  std::vector<uint32_t> occupancyMap;
+  auto&                patches         = frame.getPatches();
+  auto&                blockToPatch    = frame.getBlockToPatch();
+  auto&                occupancyMapOrg = frame.getOccupancyMap();
+  std::vector<uint8_t> occupancyMap;
   occupancyMap.resize( occupancyMapOrg.size(), 0 );
   for ( size_t i = 0; i < occupancyMapOrg.size(); i++ ) {
-    occupancyMap[i] = static_cast<unsigned int>( occupancyMapOrg[i] >= 1 );
+    occupancyMap[i] = static_cast<uint8_t>( occupancyMapOrg[i] >= 1 );
   }
   const size_t width              = frame.getWidth();
   const size_t height             = frame.getHeight();
@@ -4213,7 +4351,7 @@ void PCCEncoder::pointLocalReconstructionSearch( PCCContext&
           }
           for ( size_t v3 = 0; v3 < params_.occupancyPrecision_; ++v3 ) {
             for ( size_t u3 = 0; u3 < params_.occupancyPrecision_; ++u3 ) {
-              occupancyMap[( v2 + v3 ) * width + u2 + u3] = static_cast<unsigned int>( isFull );
+              occupancyMap[( v2 + v3 ) * width + u2 + u3] = static_cast<uint8_t>( isFull );
             }
           }
         }
@@ -4228,125 +4366,107 @@ void PCCEncoder::pointLocalReconstructionSearch( PCCContext&
     frameIndex = frame.getIndex() * ( params.mapCountMinus1_ + 1 );
     if ( videoMultiple[0].getFrameCount() < ( frameIndex + ( params.mapCountMinus1_ + 1 ) ) ) { return; }
   }
-  const size_t patchCount           = patches.size();
-  size_t       nbOfOptimizationMode = context.getPointLocalReconstructionModeNumber();
-  const size_t imageWidth           = videoMultiple[0].getWidth();
-  const size_t imageHeight          = videoMultiple[0].getHeight();
-  for ( size_t patchIndex = 0; patchIndex < patchCount; ++patchIndex ) {
-    const size_t  patchIndexPlusOne = patchIndex + 1;
-    auto&         patch             = patches[patchIndex];
-    const size_t& patchSize         = patch.getSizeU0() * patch.getSizeV0();
-    if ( patchSize == 1 || patchSize <= params_.patchSize_ ) {
-      patch.getPointLocalReconstructionLevel()     = 1;
-      auto&                     srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
-      std::vector<PCCPointSet3> reconstruct;
-      std::vector<float>        distance;
-      reconstruct.resize( nbOfOptimizationMode );
-      distance.resize( nbOfOptimizationMode );
-      size_t optimizationIndex    = 0;
-      size_t optimizationIndexMin = 0;
-      for ( size_t i = 0; i < nbOfOptimizationMode; i++ ) {
-        auto& mode = context.getPointLocalReconstructionMode( i );
-        for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
-          for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
-            const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
-            if ( blockToPatch[blockIndex] == patchIndexPlusOne ) {
-              for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
-                const size_t v = v0 * patch.getOccupancyResolution() + v1;
-                for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
-                  const size_t u = u0 * patch.getOccupancyResolution() + u1;
-                  size_t       x;
-                  size_t       y;
-                  const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
-                  if ( !occupancy ) { continue; }
-                  auto createdPoints = generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y,
-                                                       mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
-                  if ( !createdPoints.empty() ) {
-                    for ( const auto& createdPoint : createdPoints ) {
-                      reconstruct[optimizationIndex].addPoint( createdPoint );
-                    }
-                  }
-                }
+  const size_t                              patchCount  = patches.size();
+  const size_t                              imageWidth  = videoMultiple[0].getWidth();
+  const size_t                              imageHeight = videoMultiple[0].getHeight();
+  std::vector<PointLocalReconstructionMode> modes( context.getPointLocalReconstructionModeNumber() );
+  for ( size_t i = 0; i < modes.size(); i++ ) { modes[i] = context.getPointLocalReconstructionMode( i ); }
+
+  // adds to reconstruct the points generated with a mode by the occupied pixels of the block ( u0, v0 ) of a patch
+  auto generateBlockPoints = [&]( const size_t patchIndex, const size_t u0, const size_t v0,
+                                  const PointLocalReconstructionMode& mode, const bool inverseRotate,
+                                  PCCPointSet3& reconstruct ) {
+    auto& patch = patches[patchIndex];
+    for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
+      const size_t v = v0 * patch.getOccupancyResolution() + v1;
+      for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
+        const size_t u = u0 * patch.getOccupancyResolution() + u1;
+        size_t       x;
+        size_t       y;
+        const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
+        if ( !occupancy ) { continue; }
+        auto createdPoints = generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y,
+                                             mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
+        for ( const auto& createdPoint : createdPoints ) {
+          if ( !inverseRotate || patch.getAxisOfAdditionalPlane() == 0 ) {
+            reconstruct.addPoint( createdPoint );
+          } else {
+            PCCVector3D tmp;
+            PCCPatch::InverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
+                                                           createdPoint, tmp );
+            reconstruct.addPoint( tmp );
+          }
+        }
+      }
+    }
+  };
+
+  // The patches are searched in parallel, and the blocks of a large patch too. The kd-tree of the source points of a
+  // patch or a block is built once for all the modes.
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), patchCount, [&]( const size_t patchIndex ) {
+      const size_t patchIndexPlusOne  = patchIndex + 1;
+      auto&        patch              = patches[patchIndex];
+      const size_t patchSize          = patch.getSizeU0() * patch.getSizeV0();
+      const auto&  srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
+      if ( patchSize == 1 || patchSize <= params_.patchSize_ ) {
+        patch.getPointLocalReconstructionLevel() = 1;
+        const PCCKdTree srcKdtree( srcPointCloudPatch );
+        float           distanceMin = 0.F;
+        for ( size_t i = 0; i < modes.size(); i++ ) {
+          PCCPointSet3 reconstruct;
+          for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
+            for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+              const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
+              if ( blockToPatch[blockIndex] == patchIndexPlusOne ) {
+                generateBlockPoints( patchIndex, u0, v0, modes[i], false, reconstruct );
               }
             }
           }
+          const float distance = pointLocalReconstructionDistance( srcPointCloudPatch, srcKdtree, reconstruct );
+          if ( i == 0 || distanceMin > distance ) {
+            distanceMin                             = distance;
+            patch.getPointLocalReconstructionMode() = i;
+          }
         }
-        float distancePSrcRec;
-        float distancePRecSrc;
-        srcPointCloudPatch.distanceGeo( reconstruct[optimizationIndex], distancePSrcRec, distancePRecSrc );
-        distance[optimizationIndex] = ( std::max )( distancePSrcRec, distancePRecSrc );
-        if ( optimizationIndex == 0 || distance[optimizationIndexMin] > distance[optimizationIndex] ) {
-          optimizationIndexMin                    = optimizationIndex;
-          patch.getPointLocalReconstructionMode() = optimizationIndexMin;
+      } else {
+        patch.getPointLocalReconstructionLevel() = 0;
+        // the source points are bucketed by block once, in their order
+        const size_t              resolution = patch.getOccupancyResolution();
+        std::vector<PCCPointSet3> blockSrcPointClouds( patchSize );
+        for ( size_t i = 0; i < srcPointCloudPatch.getPointCount(); i++ ) {
+          const int64_t x = int64_t( srcPointCloudPatch[i][patch.getTangentAxis()] ) - int64_t( patch.getU1() );
+          const int64_t y = int64_t( srcPointCloudPatch[i][patch.getBitangentAxis()] ) - int64_t( patch.getV1() );
+          if ( x < 0 || y < 0 ) { continue; }
+          const size_t u0 = size_t( x ) / resolution;
+          const size_t v0 = size_t( y ) / resolution;
+          if ( u0 < patch.getSizeU0() && v0 < patch.getSizeV0() ) {
+            blockSrcPointClouds[v0 * patch.getSizeU0() + u0].addPoint( srcPointCloudPatch[i] );
+          }
         }
-        optimizationIndex++;
-      }
-    } else {
-      patch.getPointLocalReconstructionLevel() = 0;
-      for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
-        for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+        tbb::parallel_for( size_t( 0 ), patchSize, [&]( const size_t block ) {
+          const size_t u0                                 = block % patch.getSizeU0();
+          const size_t v0                                 = block / patch.getSizeU0();
           patch.getPointLocalReconstructionMode( u0, v0 ) = 0;
           const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
-          if ( blockToPatch[blockIndex] == patchIndexPlusOne ) {
-            auto&        srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
-            PCCPointSet3 blockSrcPointCloud;
-            const size_t xMin = u0 * patch.getOccupancyResolution() + patch.getU1();
-            const size_t yMin = v0 * patch.getOccupancyResolution() + patch.getV1();
-            for ( size_t i = 0; i < srcPointCloudPatch.getPointCount(); i++ ) {
-              if ( xMin <= srcPointCloudPatch[i][patch.getTangentAxis()] &&
-                   srcPointCloudPatch[i][patch.getTangentAxis()] < xMin + patch.getOccupancyResolution() &&
-                   yMin <= srcPointCloudPatch[i][patch.getBitangentAxis()] &&
-                   srcPointCloudPatch[i][patch.getBitangentAxis()] < yMin + patch.getOccupancyResolution() ) {
-                blockSrcPointCloud.addPoint( srcPointCloudPatch[i] );
-              }
-            }
-            std::vector<PCCPointSet3> reconstruct;
-            std::vector<float>        distance;
-            reconstruct.resize( nbOfOptimizationMode );
-            distance.resize( nbOfOptimizationMode );
-            size_t optimizationIndex    = 0;
-            size_t optimizationIndexMin = 0;
-            for ( size_t i = 0; i < nbOfOptimizationMode; i++ ) {
-              auto& mode = context.getPointLocalReconstructionMode( i );
-              for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
-                const size_t v = v0 * patch.getOccupancyResolution() + v1;
-                for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
-                  const size_t u = u0 * patch.getOccupancyResolution() + u1;
-                  size_t       x;
-                  size_t       y;
-                  const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
-                  if ( !occupancy ) { continue; }
-                  auto createdPoints = generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y,
-                                                       mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
-                  if ( !createdPoints.empty() ) {
-                    for ( const auto& createdPoint : createdPoints ) {
-                      if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                        reconstruct[optimizationIndex].addPoint( createdPoint );
-                      } else {
-                        PCCVector3D tmp;
-                        PCCPatch::InverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                                       params.geometryBitDepth3D_, createdPoint, tmp );
-                        reconstruct[optimizationIndex].addPoint( tmp );
-                      }
-                    }
-                  }
-                }
-              }
-              float distancePSrcRec;
-              float distancePRecSrc;
-              blockSrcPointCloud.distanceGeo( reconstruct[optimizationIndex], distancePSrcRec, distancePRecSrc );
-              distance[optimizationIndex] = ( std::max )( distancePSrcRec, distancePRecSrc );
-              if ( optimizationIndex == 0 || distance[optimizationIndexMin] > distance[optimizationIndex] ) {
-                optimizationIndexMin                            = optimizationIndex;
-                patch.getPointLocalReconstructionMode( u0, v0 ) = optimizationIndexMin;
-              }
-              optimizationIndex++;
+          if ( blockToPatch[blockIndex] != patchIndexPlusOne ) { return; }
+          const auto&     blockSrcPointCloud = blockSrcPointClouds[block];
+          const PCCKdTree srcKdtree( blockSrcPointCloud );
+          float           distanceMin = 0.F;
+          for ( size_t i = 0; i < modes.size(); i++ ) {
+            PCCPointSet3 reconstruct;
+            generateBlockPoints( patchIndex, u0, v0, modes[i], true, reconstruct );
+            const float distance = pointLocalReconstructionDistance( blockSrcPointCloud, srcKdtree, reconstruct );
+            if ( i == 0 || distanceMin > distance ) {
+              distanceMin                                     = distance;
+              patch.getPointLocalReconstructionMode( u0, v0 ) = i;
             }
-          }  // if block is used
-        }
+          }
+        } );
       }
-    }
-  }  // patch
+    } );
+  } );
 }
 
 bool PCCEncoder::resizeGeometryVideo( PCCContext& context ) {
@@ -4358,6 +4478,12 @@ bool PCCEncoder::resizeGeometryVideo( PCCContext& context ) {
   }
   maxWidth  = ( std::max )( maxWidth, params_.minimumImageWidth_ );
   maxHeight = ( std::max )( maxHeight, params_.minimumImageHeight_ );
+  // the pixel coordinates of the points are stored on 16 bits
+  if ( maxWidth > ( std::numeric_limits<uint16_t>::max )() || maxHeight > ( std::numeric_limits<uint16_t>::max )() ) {
+    std::cout << "Error: frame size (" << maxWidth << "x" << maxHeight << ") > "
+              << ( std::numeric_limits<uint16_t>::max )() << std::endl;
+    exit( -1 );
+  }
   for ( auto& frame : context.getFrames() ) {
     frame.getWidth()  = maxWidth;
     frame.getHeight() = maxHeight;
@@ -4459,7 +4585,7 @@ bool PCCEncoder::dilateGeometryVideo( const PCCGroupOfFrames& sources, PCCContex
 
 template <typename T>
 void PCCEncoder::dilate( PCCFrameContext& frame, PCCImage<T, 3>& image, const PCCImage<T, 3>* reference ) {
-  auto          occupancyMapTemp         = frame.getOccupancyMap();
+  const auto&   occupancyMap             = frame.getOccupancyMap();
   const size_t  pixelBlockCount          = params_.occupancyResolution_ * params_.occupancyResolution_;
   const size_t  occupancyMapSizeU        = image.getWidth() / params_.occupancyResolution_;
   const size_t  occupancyMapSizeV        = image.getHeight() / params_.occupancyResolution_;
@@ -4469,6 +4595,9 @@ void PCCEncoder::dilate( PCCFrameContext& frame, PCCImage<T, 3>& image, const PC
   size_t              count[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
   PCCVector3<int32_t> values[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
 
+  // the occupancy of the block being dilated, updated with the iteration where each pixel is filled
+  uint32_t blockOccupancy[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
+
   for ( size_t v1 = 0; v1 < occupancyMapSizeV; ++v1 ) {
     const int64_t v0 = v1 * params_.occupancyResolution_;
     for ( size_t u1 = 0; u1 < occupancyMapSizeU; ++u1 ) {
@@ -4480,10 +4609,11 @@ void PCCEncoder::dilate( PCCFrameContext& frame, PCCImage<T, 3>& image, const PC
           const int64_t y0 = v0 + v2;
           assert( x0 < int64_t( image.getWidth() ) && y0 < int64_t( image.getHeight() ) );
           const size_t location0 = y0 * image.getWidth() + x0;
+          blockOccupancy[v2][u2] = occupancyMap[location0];
           if ( params_.enhancedOccupancyMapCode_ ) {
-            nonZeroPixelCount += ( occupancyMapTemp[location0] > 0 );
+            nonZeroPixelCount += ( occupancyMap[location0] > 0 );
           } else {
-            nonZeroPixelCount += ( occupancyMapTemp[location0] == 1 );
+            nonZeroPixelCount += ( occupancyMap[location0] == 1 );
           }
         }
       }
@@ -4538,18 +4668,12 @@ void PCCEncoder::dilate( PCCFrameContext& frame, PCCImage<T, 3>& image, const PC
             const int64_t x0 = u0 + u2;
             const int64_t y0 = v0 + v2;
             assert( x0 < int64_t( image.getWidth() ) && y0 < int64_t( image.getHeight() ) );
-            const size_t location0 = y0 * image.getWidth() + x0;
-            if ( occupancyMapTemp[location0] == iteration ) {
+            if ( blockOccupancy[v2][u2] == iteration ) {
               for ( auto neighbor : neighbors ) {
-                const int64_t x1        = x0 + neighbor[0];
-                const int64_t y1        = y0 + neighbor[1];
-                const size_t  location1 = y1 * image.getWidth() + x1;
-                if ( x1 >= u0 && x1 < int64_t( u0 + params_.occupancyResolution_ ) && y1 >= v0 &&
-                     y1 < int64_t( v0 + params_.occupancyResolution_ ) && occupancyMapTemp[location1] == 0 ) {
-                  const int64_t u3 = u2 + neighbor[0];
-                  const int64_t v3 = v2 + neighbor[1];
-                  assert( u3 >= 0 && u3 < int64_t( params_.occupancyResolution_ ) );
-                  assert( v3 >= 0 && v3 < int64_t( params_.occupancyResolution_ ) );
+                const int64_t u3 = u2 + neighbor[0];
+                const int64_t v3 = v2 + neighbor[1];
+                if ( u3 >= 0 && u3 < int64_t( params_.occupancyResolution_ ) && v3 >= 0 &&
+                     v3 < int64_t( params_.occupancyResolution_ ) && blockOccupancy[v3][u3] == 0 ) {
                   for ( size_t k = 0; k < 3; ++k ) { values[v3][u3][k] += image.getValue( k, x0, y0 ); }
                   ++count[v3][u3];
                 }
@@ -4561,12 +4685,11 @@ void PCCEncoder::dilate( PCCFrameContext& frame, PCCImage<T, 3>& image, const PC
           for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
             if ( count[v2][u2] ) {
               ++nonZeroPixelCount;
-              const size_t x0             = u0 + u2;
-              const size_t y0             = v0 + v2;
-              const size_t location0      = y0 * image.getWidth() + x0;
-              const size_t c              = count[v2][u2];
-              const size_t c2             = c / 2;
-              occupancyMapTemp[location0] = iteration + 1;
+              const size_t x0        = u0 + u2;
+              const size_t y0        = v0 + v2;
+              const size_t c         = count[v2][u2];
+              const size_t c2        = c / 2;
+              blockOccupancy[v2][u2] = iteration + 1;
               for ( size_t k = 0; k < 3; ++k ) { image.setValue( k, x0, y0, T( ( values[v2][u2][k] + c2 ) / c ) ); }
               values[v2][u2] = 0;
               count[v2][u2]  = 0UL;
@@ -4823,10 +4946,10 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
 // interpolate using 5-point laplacian inpainting
 template <typename T>
 void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
+  const auto&                        occupancyMap = frame.getOccupancyMap();
+  int                                i            = 0;
   std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  std::vector<std::vector<uint8_t>>  mipOccupancyMapVec;
   int                                miplev = 0;
 
   // create coarse image by dyadic sampling
@@ -4837,7 +4960,7 @@ void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<
       CreateCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
                          mipOccupancyMapVec[miplev] );
     } else {
-      CreateCoarseLayer( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+      CreateCoarseLayer( image, mipVec[miplev], occupancyMap, mipOccupancyMapVec[miplev] );
     }
 
     if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
@@ -4845,21 +4968,24 @@ void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<
   }
   miplev++;
   // push phase: inpaint laplacian
-  regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
-    } else {
-      regionFill( image, occupancyMapTemp, mipVec[i] );
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
+    for ( i = miplev - 1; i >= 0; --i ) {
+      if ( i > 0 ) {
+        regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
+      } else {
+        regionFill( image, occupancyMap, mipVec[i] );
+      }
     }
-  }
+  } );
 }
 
 template <typename T>
-void PCCEncoder::CreateCoarseLayer( PCCImage<T, 3>&        image,
-                                    PCCImage<T, 3>&        mip,
-                                    std::vector<uint32_t>& occupancyMap,
-                                    std::vector<uint32_t>& mipOccupancyMap ) {
+void PCCEncoder::CreateCoarseLayer( const PCCImage<T, 3>&       image,
+                                    PCCImage<T, 3>&             mip,
+                                    const std::vector<uint8_t>& occupancyMap,
+                                    std::vector<uint8_t>&       mipOccupancyMap ) {
   int dyadicWidth = 1;
   while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
   int dyadicHeight = 1;
@@ -4899,157 +5025,143 @@ void PCCEncoder::CreateCoarseLayer( PCCImage<T, 3>&        image,
   }
 }
 
+// Solves the 5-point laplacian of the empty pixels: for each of them
+//   count * x[i] - sum of the empty neighbors = sum of the occupied neighbors
+// with count the number of neighbors inside the image. Each channel is solved with a matrix-free Jacobi-preconditioned
+// conjugate gradient working on the whole image: the preconditioned residual and the search direction are null on the
+// occupied pixels, so the stencil does not test the occupancy of the neighbors. The product of the matrix with the
+// search direction is updated from the one of the preconditioned residual, which gives two passes per iteration. The
+// rows are processed in parallel and the dot products are summed in row order.
 template <typename T>
-void PCCEncoder::regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
-  int                   stride        = image.getWidth();
-  int                   numElem       = 0;
-  int                   numSparseElem = 0;
-  std::vector<uint32_t> indexing;
-  indexing.resize( occupancyMap.size() );
-  for ( int i = 0; i < occupancyMap.size(); i++ ) {
-    if ( occupancyMap[i] == 0 ) {
-      indexing[i] = numElem;
-      numElem++;
-    }
-  }
-  // create a sparse matrix with the coefficients
-  std::vector<uint32_t> iSparse;
-  std::vector<uint32_t> jSparse;
-  std::vector<double>   valSparse;
-  iSparse.resize( numElem * 5 );
-  jSparse.resize( numElem * 5 );
-  valSparse.resize( numElem * 5 );
-  // create an initial solution using the low-resolution
-  std::vector<double> b[3];
-  b[0].resize( numElem );
-  b[1].resize( numElem );
-  b[2].resize( numElem );
-  // fill in the system
-  int idx       = 0;
-  int idxSparse = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        int count = 0;
-        b[0][idx] = 0;
-        b[1][idx] = 0;
-        b[2][idx] = 0;
-        for ( int i = -1; i < 2; i++ ) {
-          for ( int j = -1; j < 2; j++ ) {
-            if ( ( i == j ) || ( i == -j ) ) { continue; }
-            if ( ( column + j < 0 ) || ( column + j > image.getWidth() - 1 ) ) { continue; }
-            if ( ( row + i < 0 ) || ( row + i > image.getHeight() - 1 ) ) { continue; }
-            count++;
-            if ( occupancyMap[column + j + stride * ( row + i )] == 1 ) {
-              b[0][idx] += image.getValue( 0, column + j, row + i );
-              b[1][idx] += image.getValue( 1, column + j, row + i );
-              b[2][idx] += image.getValue( 2, column + j, row + i );
-            } else {
-              iSparse[idxSparse]   = idx;
-              jSparse[idxSparse]   = indexing[column + j + stride * ( row + i )];
-              valSparse[idxSparse] = -1;
-              idxSparse++;
-            }
-          }
-        }
-        // now insert the weight of the center pixel
-        iSparse[idxSparse]   = idx;
-        jSparse[idxSparse]   = idx;
-        valSparse[idxSparse] = count;
-        idx++;
-        idxSparse++;
-      }
-    }
-  }
-  numSparseElem = idxSparse;
-  // now solve the linear system Ax=b using Gauss-Siedel relaxation, with
-  // initial guess coming from the lower
-  // resolution
-  std::vector<double> x[3];
-  x[0].resize( numElem );
-  x[1].resize( numElem );
-  x[2].resize( numElem );
-  if ( imageLowRes.getWidth() == image.getWidth() ) {
-    // low resolution image not provided, let's use for the initialization the
-    // mean value of the active pixels
-    double mean[3] = {0.0, 0.0, 0.0};
-    idx            = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 1 ) {
-          mean[0] += double( image.getValue( 0, column, row ) );
-          mean[1] += double( image.getValue( 1, column, row ) );
-          mean[2] += double( image.getValue( 2, column, row ) );
-          idx++;
-        }
-      }
-    }
-    mean[0] /= idx;
-    mean[1] /= idx;
-    mean[2] /= idx;
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = mean[0];
-          x[1][idx] = mean[1];
-          x[2][idx] = mean[2];
-          idx++;
-        }
-      }
+void PCCEncoder::regionFill( PCCImage<T, 3>&             image,
+                             const std::vector<uint8_t>& occupancyMap,
+                             const PCCImage<T, 3>&       imageLowRes ) {
+  const int          width   = image.getWidth();
+  const int          height  = image.getHeight();
+  const size_t       size    = size_t( width ) * height;
+  size_t             numElem = 0;
+  std::vector<float> invCount( size, 0.f );
+  for ( int row = 0; row < height; row++ ) {
+    for ( int column = 0; column < width; column++ ) {
+      const size_t i = size_t( row ) * width + column;
+      if ( occupancyMap[i] == 0 ) {
+        invCount[i] = 1.f / ( ( column > 0 ) + ( column < width - 1 ) + ( row > 0 ) + ( row < height - 1 ) );
+        numElem++;
+      }
+    }
+  }
+  if ( numElem == 0 ) { return; }
+  const std::vector<float> zeros( width, 0.f );
+  // out[column] = scale * out[column] + count * v[column] - sum of the neighbors of v inside the image, on one row
+  auto laplacian = [&]( const std::vector<float>& v, const int row, const float scale, float* out ) {
+    const float* center = v.data() + size_t( row ) * width;
+    const float* up     = row > 0 ? center - width : zeros.data();
+    const float* down   = row < height - 1 ? center + width : zeros.data();
+    const float  count  = float( ( row > 0 ) + ( row < height - 1 ) + 2 );
+    for ( int column = 1; column < width - 1; column++ ) {
+      out[column] = scale * out[column] + count * center[column] -
+                    ( up[column] + down[column] + center[column - 1] + center[column + 1] );
+    }
+    // first and last columns
+    for ( int column = 0; column < width; column += std::max( width - 1, 1 ) ) {
+      float sum = up[column] + down[column];
+      float n   = count - 2.f;
+      if ( column > 0 ) {
+        sum += center[column - 1];
+        n++;
+      }
+      if ( column < width - 1 ) {
+        sum += center[column + 1];
+        n++;
+      }
+      out[column] = scale * out[column] + n * center[column] - sum;
     }
-  } else {
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = imageLowRes.getValue( 0, column / 2, row / 2 );
-          x[1][idx] = imageLowRes.getValue( 1, column / 2, row / 2 );
-          x[2][idx] = imageLowRes.getValue( 2, column / 2, row / 2 );
-          idx++;
-        }
-      }
-    }
-  }
-  int    maxIteration = 1024;
-  double maxError     = 0.00001;
-  for ( int cc = 0; cc < 3; cc++ ) {
-    int it = 0;
-    for ( ; it < maxIteration; it++ ) {
-      int    idxSparse = 0;
-      double error     = 0;
-      double val       = 0;
-      for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
-        // add the b result
-        val = b[cc][centerIdx];
-        while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
-          if ( valSparse[idxSparse] < 0 ) {
-            val += x[cc][jSparse[idxSparse]];
-            idxSparse++;
-          } else {
-            // final value
-            val /= valSparse[idxSparse];
-            // accumulate the error
-            error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
-            // update the value
-            x[cc][centerIdx] = val;
-            idxSparse++;
-          }
+  };
+  // initial solution: the low-resolution image or, if not provided, the mean value of the active pixels
+  double mean[3] = {0.0, 0.0, 0.0};
+  if ( imageLowRes.getWidth() == image.getWidth() && numElem < size ) {
+    for ( size_t i = 0; i < size; i++ ) {
+      if ( occupancyMap[i] == 1 ) {
+        for ( size_t cc = 0; cc < 3; cc++ ) { mean[cc] += double( image.getChannel( cc )[i] ); }
+      }
+    }
+    for ( size_t cc = 0; cc < 3; cc++ ) { mean[cc] /= double( size - numElem ); }
+  }
+  const int           maxIteration = 1024;
+  const double        maxError     = params_.textureBGFillTolerance_;
+  std::vector<float>  x( size ), r( size ), z( size ), p( size ), q( size );
+  std::vector<double> rowDot( height ), rowError( height );
+  for ( size_t cc = 0; cc < 3; cc++ ) {
+    auto& channel = image.getChannel( cc );
+    tbb::parallel_for( 0, height, [&]( const int row ) {
+      for ( int column = 0; column < width; column++ ) {
+        const size_t i = size_t( row ) * width + column;
+        if ( occupancyMap[i] == 1 ) {
+          x[i] = channel[i];
+        } else if ( imageLowRes.getWidth() == image.getWidth() ) {
+          x[i] = float( mean[cc] );
+        } else {
+          x[i] = imageLowRes.getValue( cc, column / 2, row / 2 );
         }
       }
-      error = error / numElem;
-      if ( error < maxError ) { break; }
-    }
-  }
-  // put the value back in the image
-  idx = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        image.setValue( 0, column, row, x[0][idx] );
-        image.setValue( 1, column, row, x[1][idx] );
-        image.setValue( 2, column, row, x[2][idx] );
-        idx++;
+    } );
+    // residual r = b - Ax and preconditioned residual z = r / count, which is the Jacobi update
+    tbb::parallel_for( 0, height, [&]( const int row ) {
+      const size_t begin = size_t( row ) * width;
+      double       dot   = 0;
+      double       error = 0;
+      laplacian( x, row, 0.f, r.data() + begin );
+      for ( size_t i = begin; i < begin + width; i++ ) {
+        r[i] = -r[i];
+        z[i] = r[i] * invCount[i];
+        dot += double( r[i] ) * z[i];
+        error += double( z[i] ) * z[i];
+      }
+      rowDot[row]   = dot;
+      rowError[row] = error;
+    } );
+    double rz        = std::accumulate( rowDot.begin(), rowDot.end(), 0.0 );
+    double meanError = std::accumulate( rowError.begin(), rowError.end(), 0.0 ) / numElem;
+    float  beta      = 0.f;
+    for ( int it = 0; it < maxIteration && meanError >= maxError; it++ ) {
+      // q = Ap = Az + beta * q
+      tbb::parallel_for( 0, height, [&]( const int row ) {
+        const size_t begin = size_t( row ) * width;
+        double       dot   = 0;
+        laplacian( z, row, beta, q.data() + begin );
+        for ( size_t i = begin; i < begin + width; i++ ) {
+          p[i] = z[i] + beta * p[i];
+          dot += double( p[i] ) * q[i];
+        }
+        rowDot[row] = dot;
+      } );
+      const double pq = std::accumulate( rowDot.begin(), rowDot.end(), 0.0 );
+      if ( pq <= 0 ) { break; }
+      const float alpha = float( rz / pq );
+      tbb::parallel_for( 0, height, [&]( const int row ) {
+        const size_t begin = size_t( row ) * width;
+        double       dot   = 0;
+        double       error = 0;
+        for ( size_t i = begin; i < begin + width; i++ ) {
+          x[i] += alpha * p[i];
+          r[i] -= alpha * q[i];
+          z[i] = r[i] * invCount[i];
+          dot += double( r[i] ) * z[i];
+          error += double( z[i] ) * z[i];
+        }
+        rowDot[row]   = dot;
+        rowError[row] = error;
+      } );
+      const double rzNext = std::accumulate( rowDot.begin(), rowDot.end(), 0.0 );
+      beta                = float( rzNext / rz );
+      rz                  = rzNext;
+      meanError           = std::accumulate( rowError.begin(), rowError.end(), 0.0 ) / numElem;
+    }
+    // put the value back in the image, rounded and clamped to the range of T
+    const float maxT = float( std::numeric_limits<T>::max() );
+    for ( size_t i = 0; i < size; i++ ) {
+      if ( occupancyMap[i] == 0 ) {
+        channel[i] = static_cast<T>( std::round( std::min( std::max( x[i], 0.F ), maxT ) ) );
       }
     }
   }
@@ -5071,202 +5183,179 @@ int PCCEncoder::mean4w( T             p1,
 }
 
 // Generates a weighted mipmap
+// The rows of the mipmap are computed in parallel, each with its three channels. The samples of the last column and
+// row of an image with odd dimensions are read as empty.
 template <typename T>
-void PCCEncoder::pushPullMip( const PCCImage<T, 3>&        image,
-                              PCCImage<T, 3>&              mip,
-                              const std::vector<uint32_t>& occupancyMap,
-                              std::vector<uint32_t>&       mipOccupancyMap ) {
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  unsigned char val1;
-  unsigned char val2;
-  unsigned char val3;
-  unsigned char val4;
-  const size_t  width     = image.getWidth();
-  const size_t  height    = image.getHeight();
-  const size_t  newWidth  = ( ( width + 1 ) >> 1 );
-  const size_t  newHeight = ( ( height + 1 ) >> 1 );
+void PCCEncoder::pushPullMip( const PCCImage<T, 3>&       image,
+                              PCCImage<T, 3>&             mip,
+                              const std::vector<uint8_t>& occupancyMap,
+                              std::vector<uint8_t>&       mipOccupancyMap ) {
+  // ( sum * reciprocal[count] ) >> 16 is the mean of count 8-bit values
+  static const uint32_t       reciprocal[5] = {0, 65536, 32768, 21846, 16384};
+  const size_t                width         = image.getWidth();
+  const size_t                height        = image.getHeight();
+  const size_t                newWidth      = ( ( width + 1 ) >> 1 );
+  const size_t                newHeight     = ( ( height + 1 ) >> 1 );
+  const std::vector<uint8_t>  emptyOccupancy( width, 0 );
+  const std::vector<T>        emptyValues( width, 0 );
   // allocate the mipmap with half the resolution
   mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
   mipOccupancyMap.resize( newWidth * newHeight, 0 );
-  for ( size_t y = 0; y < newHeight; ++y ) {
-    const size_t yUp = y << 1;
+  tbb::parallel_for( size_t( 0 ), newHeight, [&]( const size_t y ) {
+    const size_t   yUp  = y << 1;
+    const uint8_t* occ0 = occupancyMap.data() + width * yUp;
+    const uint8_t* occ1 = yUp + 1 < height ? occ0 + width : emptyOccupancy.data();
     for ( size_t x = 0; x < newWidth; ++x ) {
-      const size_t xUp = x << 1;
-      if ( occupancyMap[xUp + width * yUp] == 0 ) {
-        w1 = 0;
-      } else {
-        w1 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
-        w2 = 0;
-      } else {
-        w2 = 255;
-      }
-      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
-        w3 = 0;
-      } else {
-        w3 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
-        w4 = 0;
-      } else {
-        w4 = 255;
-      }
-      if ( w1 + w2 + w3 + w4 > 0 ) {
-        for ( int cc = 0; cc < 3; cc++ ) {
-          val1 = image.getValue( cc, xUp, yUp );
-          if ( xUp + 1 >= width ) {
-            val2 = 0;
-          } else {
-            val2 = image.getValue( cc, xUp + 1, yUp );
-          }
-          if ( yUp + 1 >= height ) {
-            val3 = 0;
-          } else {
-            val3 = image.getValue( cc, xUp, yUp + 1 );
-          }
-          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
-            val4 = 0;
-          } else {
-            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
-          }
-          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
-          mip.setValue( cc, x, y, newVal );
-        }
+      const size_t xUp   = x << 1;
+      const size_t xUp1  = ( std::min )( xUp + 1, width - 1 );
+      const bool   right = xUp + 1 < width;
+      if ( ( occ0[xUp] != 0 ) || ( occ1[xUp] != 0 ) || ( right && ( ( occ0[xUp1] != 0 ) || ( occ1[xUp1] != 0 ) ) ) ) {
         mipOccupancyMap[x + newWidth * y] = 1;
       }
     }
-  }
+    for ( int cc = 0; cc < 3; cc++ ) {
+      const T* src0 = image.getChannel( cc ).data() + width * yUp;
+      const T* src1 = yUp + 1 < height ? src0 + width : emptyValues.data();
+      T*       dst  = mip.getChannel( cc ).data() + newWidth * y;
+      for ( size_t x = 0; x < newWidth; ++x ) {
+        const size_t   xUp   = x << 1;
+        const size_t   xUp1  = ( std::min )( xUp + 1, width - 1 );
+        const uint32_t right = xUp + 1 < width;
+        const uint32_t w1    = occ0[xUp] != 0;
+        const uint32_t w2    = right & ( occ0[xUp1] != 0 );
+        const uint32_t w3    = occ1[xUp] != 0;
+        const uint32_t w4    = right & ( occ1[xUp1] != 0 );
+        const uint32_t sum   = w1 * static_cast<uint8_t>( src0[xUp] ) + w2 * static_cast<uint8_t>( src0[xUp1] ) +
+                             w3 * static_cast<uint8_t>( src1[xUp] ) + w4 * static_cast<uint8_t>( src1[xUp1] );
+        const uint32_t count = w1 + w2 + w3 + w4;
+        const T        mean  = static_cast<T>( ( sum * reciprocal[count] ) >> 16 );
+        const T        same  = dst[x];
+        dst[x]               = count > 0 ? mean : same;
+      }
+    }
+  } );
 }
 
 // interpolate using mipmap
+// The rows of the image are filled in parallel, each with its three channels. The pixels that have all their
+// neighbors in the mipmap are averaged with a shift, the few on its borders with the complete weighted mean.
 template <typename T>
-void PCCEncoder::pushPullFill( PCCImage<T, 3>&              image,
-                               const PCCImage<T, 3>&        mip,
-                               const std::vector<uint32_t>& occupancyMap,
-                               int                          numIters ) {
-  const size_t width    = mip.getWidth();
-  const size_t height   = mip.getHeight();
-  const size_t widthUp  = image.getWidth();
-  const size_t heightUp = image.getHeight();
+void PCCEncoder::pushPullFill( PCCImage<T, 3>&             image,
+                               const PCCImage<T, 3>&       mip,
+                               const std::vector<uint8_t>& occupancyMap,
+                               int                         numIters ) {
+  const int width    = mip.getWidth();
+  const int height   = mip.getHeight();
+  const int widthUp  = image.getWidth();
+  const int heightUp = image.getHeight();
   assert( ( ( widthUp + 1 ) >> 1 ) == width );
   assert( ( ( heightUp + 1 ) >> 1 ) == height );
-  int           x;
-  int           y;
-  int           xUp;
-  int           yUp;
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  for ( yUp = 0; yUp < heightUp; ++yUp ) {
-    y = yUp >> 1;
-    for ( xUp = 0; xUp < widthUp; ++xUp ) {
-      x = xUp >> 1;
-      if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
-        if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val       = mip.getValue( cc, x, y );
-            T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
-            T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val        = mip.getValue( cc, x, y );
-            T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
-            T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val         = mip.getValue( cc, x, y );
-            T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
-            T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val          = mip.getValue( cc, x, y );
-            T valRight     = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valDown      = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownRight = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
-            T newVal       = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        }
+  // weights 144, 48, 48 and 16 of the pixel of the mipmap, of its horizontal, vertical and diagonal neighbors toward
+  // the position of (xUp, yUp)
+  auto fill = [&]( const int cc, const int xUp, const int yUp ) {
+    const int  x       = xUp >> 1;
+    const int  y       = yUp >> 1;
+    const int  xn      = ( xUp % 2 == 0 ) ? x - 1 : x + 1;
+    const int  yn      = ( yUp % 2 == 0 ) ? y - 1 : y + 1;
+    const bool xInside = xn >= 0 && xn < width;
+    const bool yInside = yn >= 0 && yn < height;
+    T          val     = mip.getValue( cc, x, y );
+    T          valX    = xInside ? mip.getValue( cc, xn, y ) : 0;
+    T          valY    = yInside ? mip.getValue( cc, x, yn ) : 0;
+    T          valXY   = ( xInside && yInside ) ? mip.getValue( cc, xn, yn ) : 0;
+    T          newVal  = mean4w( val, 144, valX, xInside ? 48 : 0, valY, yInside ? 48 : 0, valXY,
+                           ( xInside && yInside ) ? 16 : 0 );
+    image.setValue( cc, xUp, yUp, newVal );
+  };
+  // the channels are detached from the copies of the image before being written by the concurrent rows
+  image.detach();
+  T* const channels[3] = {image.getChannel( 0 ).data(), image.getChannel( 1 ).data(), image.getChannel( 2 ).data()};
+  tbb::parallel_for( 0, heightUp, [&]( const int yUp ) {
+    const int      y   = yUp >> 1;
+    const int      yn  = ( yUp % 2 == 0 ) ? y - 1 : y + 1;
+    const uint8_t* occ = occupancyMap.data() + widthUp * yUp;
+    for ( int cc = 0; cc < 3; cc++ ) {
+      // [xUpBegin, xUpEnd) is the range of the pixels averaged with a shift
+      int xUpBegin = widthUp;
+      int xUpEnd   = widthUp;
+      if ( yn >= 0 && yn < height ) {
+        const T* mip0 = mip.getChannel( cc ).data() + width * y;
+        const T* mip1 = mip.getChannel( cc ).data() + width * yn;
+        T*       dst  = channels[cc] + widthUp * yUp;
+        for ( int x = 1; x < width - 1; ++x ) {
+          const uint32_t center = 144 * uint32_t( mip0[x] ) + 48 * uint32_t( mip1[x] );
+          const uint32_t left   = center + 48 * uint32_t( mip0[x - 1] ) + 16 * uint32_t( mip1[x - 1] );
+          const uint32_t right  = center + 48 * uint32_t( mip0[x + 1] ) + 16 * uint32_t( mip1[x + 1] );
+          const T        even   = dst[2 * x];
+          const T        odd    = dst[2 * x + 1];
+          dst[2 * x]            = occ[2 * x] == 0 ? static_cast<T>( left >> 8 ) : even;
+          dst[2 * x + 1]        = occ[2 * x + 1] == 0 ? static_cast<T>( right >> 8 ) : odd;
+        }
+        xUpBegin = ( std::min )( 2, widthUp );
+        xUpEnd   = ( std::max )( xUpBegin, 2 * width - 2 );
+      }
+      for ( int xUp = 0; xUp < widthUp; xUp = ( xUp + 1 == xUpBegin ) ? xUpEnd : xUp + 1 ) {
+        if ( occ[xUp] == 0 ) { fill( cc, xUp, yUp ); }
       }
     }
-  }
-  auto tmpImage( image );
+  } );
+  auto tmpImage = image.clone();
   for ( size_t n = 0; n < numIters; n++ ) {
-    for ( int y = 0; y < heightUp; y++ ) {
-      for ( int x = 0; x < widthUp; x++ ) {
-        if ( occupancyMap[x + widthUp * y] == 0 ) {
-          int x1 = ( x > 0 ) ? x - 1 : x;
-          int y1 = ( y > 0 ) ? y - 1 : y;
-          int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
-          int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
-          for ( size_t c = 0; c < 3; c++ ) {
-            int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
-                      image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
-                      image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
-            tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
+    tbb::parallel_for( 0, heightUp, [&]( const int y ) {
+      const int      y1  = ( y > 0 ) ? y - 1 : y;
+      const int      y2  = ( y < heightUp - 1 ) ? y + 1 : y;
+      const uint8_t* occ = occupancyMap.data() + widthUp * y;
+      for ( int c = 0; c < 3; c++ ) {
+        const T* up   = image.getChannel( c ).data() + widthUp * y1;
+        const T* row  = image.getChannel( c ).data() + widthUp * y;
+        const T* down = image.getChannel( c ).data() + widthUp * y2;
+        T*       dst  = tmpImage.getChannel( c ).data() + widthUp * y;
+        for ( int x = 0; x < widthUp; x = ( x == 0 && widthUp > 2 ) ? widthUp - 1 : x + 1 ) {
+          const int x1 = ( x > 0 ) ? x - 1 : x;
+          const int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
+          if ( occ[x] == 0 ) {
+            int val = up[x1] + up[x2] + down[x1] + down[x2] + row[x1] + row[x2] + up[x] + down[x];
+            dst[x]  = static_cast<T>( ( val + 4 ) >> 3 );
           }
         }
+        for ( int x = 1; x < widthUp - 1; x++ ) {
+          const int val = up[x - 1] + up[x + 1] + down[x - 1] + down[x + 1] + row[x - 1] + row[x + 1] + up[x] + down[x];
+          const T   mean = static_cast<T>( ( val + 4 ) >> 3 );
+          const T   same = row[x];
+          dst[x]         = occ[x] == 0 ? mean : same;
+        }
       }
-    }
-    swap( image, tmpImage );
+    } );
+    image.swap( tmpImage );
   }
 }
 
 template <typename T>
 void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
+  const auto&                        occupancyMap = frame.getOccupancyMap();
+  int                                i            = 0;
   std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  std::vector<std::vector<uint8_t>>  mipOccupancyMapVec;
   int                                div    = 2;
   int                                miplev = 0;
 
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+
   // pull phase create the mipmap
-  while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    div *= 2;
-    if ( miplev > 0 ) {
-      pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
-    } else {
-      pushPullMip( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+  limited.execute( [&] {
+    while ( true ) {
+      mipVec.resize( mipVec.size() + 1 );
+      mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+      div *= 2;
+      if ( miplev > 0 ) {
+        pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
+      } else {
+        pushPullMip( image, mipVec[miplev], occupancyMap, mipOccupancyMapVec[miplev] );
+      }
+      if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
+      ++miplev;
     }
-    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
-    ++miplev;
-  }
+  } );
   miplev++;
 #if DEBUG_PATCH
   for ( int k = 0; k < miplev; k++ ) {
@@ -5278,14 +5367,16 @@ void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>&
 #endif
   // push phase: refill
   int numIters = 4;
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
-    } else {
-      pushPullFill( image, mipVec[i], occupancyMapTemp, numIters );
+  limited.execute( [&] {
+    for ( i = miplev - 1; i >= 0; --i ) {
+      if ( i > 0 ) {
+        pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
+      } else {
+        pushPullFill( image, mipVec[i], occupancyMap, numIters );
+      }
+      numIters = ( std::min )( numIters + 1, 16 );
     }
-    numIters = ( std::min )( numIters + 1, 16 );
-  }
+  } );
 #if DEBUG_PATCH
   for ( int k = 0; k < miplev; k++ ) {
     char buf[100];
@@ -5472,11 +5563,11 @@ bool PCCEncoder::generateTextureVideo( const PCCPointSet3& reconstruct,
   }
 
   for ( size_t i = 0; i < pointCount; ++i ) {
-    const PCCVector3<size_t> location = pointToPixel[i];
-    const PCCColor3B         color    = reconstruct.getColor( i );
-    const size_t             u        = location[0];
-    const size_t             v        = location[1];
-    const size_t             f        = location[2];
+    const PCCVector3<uint16_t> location = pointToPixel[i];
+    const PCCColor3B           color    = reconstruct.getColor( i );
+    const size_t               u        = location[0];
+    const size_t               v        = location[1];
+    const size_t               f        = location[2];
     if ( params_.singleMapPixelInterleaving_ ) {
       if ( ( f == 0 && ( ( u + v ) % 2 == 0 ) ) || ( f == 1 && ( ( u + v ) % 2 == 1 ) ) ) {
         auto& image = video.getFrame( curNumOfVideoFrames );
@@ -5705,6 +5796,9 @@ void PCCEncoder::generateGlobalPatches( PCCContext&    context,
                                         size_t         preIndex ) {
   auto& curPatches = context[frameIndex].getPatches();
   assert( !curPatches.empty() );
+  // the patches that can match a previous patch are the ones of the same bucket that overlap it.
+  PCCPatchRectIndex   rectIndex( curPatches );
+  std::vector<size_t> candidates;
   for ( auto& globalPatchTrack : globalPatchTracks ) {
     auto& trackPatches = globalPatchTrack.second;  // !!!< <frameIndex, patchIndex> >;
     if ( trackPatches.empty() ) { continue; }
@@ -5712,12 +5806,13 @@ void PCCEncoder::generateGlobalPatches( PCCContext&    context,
     const auto& prePatch       = context[preGlobalPatch.first].getPatches()[preGlobalPatch.second];
     float       thresholdIOU   = 0.2F;
     float       maxIou         = 0.0F;
-    int32_t     bestIdx        = -1;       // best matched patch index in curPatches;
-    int32_t     cId            = 0;        // patch index in curPatches;
-    for ( auto& curPatch : curPatches ) {  // curPatches; may be modified;
-      if ( prePatch.getViewId() == curPatch.getViewId() && !( curPatch.getCurGPAPatchData().isMatched ) &&
-           ( prePatch.getLodScaleX() == curPatch.getLodScaleX() &&
-             prePatch.getLodScaleY() == curPatch.getLodScaleY() ) ) {
+    int32_t     bestIdx        = -1;  // best matched patch index in curPatches;
+    const int   bucket         = rectIndex.getBucket( prePatch );
+    if ( bucket >= 0 ) {
+      rectIndex.getCandidates( bucket, prePatch, candidates );
+      for ( const auto cId : candidates ) {  // patch index in curPatches;
+        auto& curPatch = curPatches[cId];
+        if ( curPatch.getCurGPAPatchData().isMatched ) { continue; }
         Rect  preRect = Rect( prePatch.getU1(), prePatch.getV1(), prePatch.getSizeU(), prePatch.getSizeV() );
         Rect  curRect = Rect( curPatch.getU1(), curPatch.getV1(), curPatch.getSizeU(), curPatch.getSizeV() );
         float iou     = computeIOU( preRect, curRect );
@@ -5726,7 +5821,6 @@ void PCCEncoder::generateGlobalPatches( PCCContext&    context,
           bestIdx = cId;
         }
       }
-      cId++;
     }
     if ( maxIou > thresholdIOU ) {                                // !!!best match found;
       curPatches[bestIdx].getCurGPAPatchData().isMatched = true;  // indicating the patch is already matched;
@@ -5827,15 +5921,18 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
   size_t height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  int               numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
+  int              numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   for ( auto& iter : unionPatchTemp ) {
     auto& curPatchUnion = iter.second;  // [u0, v0] may be modified;
     assert( curPatchUnion.getSizeU0() < occupancySizeU );
     assert( curPatchUnion.getSizeV0() < occupancySizeV );
     bool  locationFound = false;
     auto& occupancy     = curPatchUnion.getOccupancy();
+    std::vector<PCCPackingFootprint> footprints( PATCH_ORIENTATION_MROT270 + 1 );
+    for ( size_t orientation = 0; orientation < footprints.size(); orientation++ ) {
+      curPatchUnion.getPackingFootprint( footprints[orientation], orientation, params_.lowDelayEncoding_, safeguard );
+    }
     while ( !locationFound ) {
       for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
         for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
@@ -5843,8 +5940,7 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
           curPatchUnion.getV0() = v;
           if ( params_.packingStrategy_ == 0 ) {
             curPatchUnion.getPatchOrientation() = PATCH_ORIENTATION_DEFAULT;
-            if ( curPatchUnion.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard ) ) {
+            if ( occupancyMap.checkFit( footprints[PATCH_ORIENTATION_DEFAULT], u, v ) ) {
               locationFound = true;
               if ( printDetailedInfo ) {
                 std::cout << "Orientation " << curPatchUnion.getPatchOrientation() << " selected for unionPatch "
@@ -5854,8 +5950,7 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
           } else {
             if ( useRefFrame && ( curPatchUnion.getPatchOrientation() != -1 ) ) {
               // already knonw Patch Orientation. just try.
-              if ( curPatchUnion.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                      params_.lowDelayEncoding_, safeguard ) ) {
+              if ( occupancyMap.checkFit( footprints[curPatchUnion.getPatchOrientation()], u, v ) ) {
                 locationFound = true;
                 if ( printDetailedInfo ) {
                   std::cout << "location u0,v0 selected for unionPatch " << curPatchUnion.getIndex() << " (" << u << ","
@@ -5869,8 +5964,7 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
                 } else {
                   curPatchUnion.getPatchOrientation() = orientation_vertical[orientationIdx];
                 }
-                if ( curPatchUnion.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                        params_.lowDelayEncoding_, safeguard ) ) {
+                if ( occupancyMap.checkFit( footprints[curPatchUnion.getPatchOrientation()], u, v ) ) {
                   locationFound = true;
                   if ( printDetailedInfo ) {
                     std::cout << "Orientation " << curPatchUnion.getPatchOrientation() << " selected for unionPatch "
@@ -5884,16 +5978,14 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       }
     }
     for ( size_t v0 = 0; v0 < curPatchUnion.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < curPatchUnion.getSizeU0(); ++u0 ) {
         int coord = curPatchUnion.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-        if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curPatchUnion.getSizeU0() + u0];
+        if ( params_.lowDelayEncoding_ || occupancy[v0 * curPatchUnion.getSizeU0() + u0] ) {
+          occupancyMap.setOccupied( coord );
         }
       }
     }
@@ -5936,8 +6028,7 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
   {
     int numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-    std::vector<bool> occupancyMap;
-    occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+    PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
 
     for ( auto& patch : patches ) {
       assert( patch.getSizeU0() <= occupancySizeU );
@@ -5957,8 +6048,7 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
           // try to place on the same position as the matched patch
           curGPAPatchData.u0 = prevPatches[patch.getBestMatchIdx()].getU0();
           curGPAPatchData.v0 = prevPatches[patch.getBestMatchIdx()].getV0();
-          if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV,
-                                                params_.lowDelayEncoding_ ) ) {
+          if ( patch.checkFitPatchCanvasForGPA( occupancyMap, params_.lowDelayEncoding_ ) ) {
             locationFound = true;
             if ( printDetailedInfo ) {
               std::cout << "Maintained orientation " << curGPAPatchData.patchOrientation
@@ -5968,12 +6058,14 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
           }
           // if the patch couldn't fit, try to fit the patch in the top left
           // position
+          PCCPackingFootprint footprint;
+          patch.getPackingFootprintForGPA( footprint, curGPAPatchData.patchOrientation, params_.lowDelayEncoding_,
+                                           safeguard );
           for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-            for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
+            for ( int u = occupancyMap.getFirstCandidate( footprint, v ); u <= occupancySizeU && !locationFound; ++u ) {
               curGPAPatchData.u0 = u;
               curGPAPatchData.v0 = v;
-              if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard ) ) {
+              if ( occupancyMap.checkFit( footprint, u, v ) ) {
                 locationFound = true;
                 if ( printDetailedInfo ) {
                   std::cout << "Maintained orientation " << curGPAPatchData.patchOrientation << " for matched patch:("
@@ -5984,8 +6076,16 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
           }
         } else {
           // best effort
+          std::vector<PCCPackingFootprint> footprints( numOrientations );
+          for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+            patch.getPackingFootprintForGPA( footprints[orientationIdx],
+                                             getPackingOrientation( params_.packingStrategy_, curGPAPatchData.sizeU0,
+                                                                    curGPAPatchData.sizeV0, orientationIdx ),
+                                             params_.lowDelayEncoding_, safeguard );
+          }
           for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-            for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+            for ( size_t u = occupancyMap.getFirstCandidate( footprints, v ); u < occupancySizeU && !locationFound;
+                  ++u ) {
               curGPAPatchData.u0 = u;
               curGPAPatchData.v0 = v;
               for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
@@ -5998,8 +6098,7 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
                     curGPAPatchData.patchOrientation = orientation_vertical[orientationIdx];
                   }
                 }
-                if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV,
-                                                      params_.lowDelayEncoding_, safeguard ) ) {
+                if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
                   locationFound = true;
                   if ( printDetailedInfo ) {
                     std::cout << "Orientation " << curGPAPatchData.patchOrientation << " selected for unmatched patch:("
@@ -6012,16 +6111,14 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
         }
         if ( !locationFound ) {
           occupancySizeV *= 2;
-          occupancyMap.resize( occupancySizeU * occupancySizeV );
+          occupancyMap.resize( occupancySizeU, occupancySizeV );
         }
       }
       for ( size_t v0 = 0; v0 < curGPAPatchData.sizeV0; ++v0 ) {
         for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
           int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
-          if ( params_.lowDelayEncoding_ ) {
-            occupancyMap[coord] = true;
-          } else {
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( params_.lowDelayEncoding_ || occupancy[v0 * patch.getSizeU0() + u0] ) {
+            occupancyMap.setOccupied( coord );
           }
         }
       }
@@ -6250,8 +6347,7 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
     widthGPA  = occupancySizeU * params_.occupancyResolution_;
     heightGPA = occupancySizeV * params_.occupancyResolution_;
     size_t            maxOccupancyRow{0};
-    std::vector<bool> occupancyMap;
-    occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+    PCCPackingCanvas occupancyMap( occupancySizeU, occupancySizeV );
     // !!!packing global matched patch;
     for ( auto& patch : patches ) {
       GPAPatchData& curGPAPatchData = patch.getCurGPAPatchData();
@@ -6270,10 +6366,8 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
         for ( size_t v0 = 0; v0 < curGPAPatchData.sizeV0; ++v0 ) {
           for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
             int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
-            if ( params_.lowDelayEncoding_ ) {
-              occupancyMap[coord] = true;
-            } else {
-              occupancyMap[coord] = occupancyMap[coord] || curGPAPatchData.occupancy[v0 * curGPAPatchData.sizeU0 + u0];
+            if ( params_.lowDelayEncoding_ || curGPAPatchData.occupancy[v0 * curGPAPatchData.sizeU0 + u0] ) {
+              occupancyMap.setOccupied( coord );
             }
           }
         }
@@ -6347,7 +6441,7 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
     size_t&            occupancySizeU,
     size_t&            occupancySizeV,
     const size_t       safeguard,
-    std::vector<bool>& occupancyMap,
+    PCCPackingCanvas&  occupancyMap,
     size_t&            heightGPA,
     size_t&            widthGPA,
     size_t&            maxOccupancyRow ) {  // GPA_HAMONIZATION, the whole function has been
@@ -6360,16 +6454,22 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
   assert( curGPAPatchData.sizeV0 <= occupancySizeV );
   bool  locationFound = false;
   auto& occupancy     = patch.getOccupancy();
+  std::vector<PCCPackingFootprint> footprints( numOrientations );
+  for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+    patch.getPackingFootprintForGPA(
+        footprints[orientationIdx],
+        getPackingOrientation( params_.packingStrategy_, patch.getSizeU0(), patch.getSizeV0(), orientationIdx ),
+        params_.lowDelayEncoding_, safeguard );
+  }
   while ( !locationFound ) {
     for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-      for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+      for ( size_t u = occupancyMap.getFirstCandidate( footprints, v ); u < occupancySizeU && !locationFound; ++u ) {
         curGPAPatchData.u0 = u;
         curGPAPatchData.v0 = v;
         if ( params_.packingStrategy_ == 0 ) {
           curGPAPatchData.patchOrientation = PATCH_ORIENTATION_DEFAULT;
           // std::cout<<"checkFitPatchCanvasForGPA"<<std::endl;
-          if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                                safeguard ) ) {
+          if ( occupancyMap.checkFit( footprints[0], u, v ) ) {
             locationFound = true;
             if ( printDetailedInfo ) {
               std::cout << "Orientation " << curGPAPatchData.patchOrientation << " selected for Patch: ["
@@ -6388,8 +6488,7 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
                 curGPAPatchData.patchOrientation = orientation_vertical[orientationIdx];
               }
             }
-            if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV,
-                                                  params_.lowDelayEncoding_, safeguard ) ) {
+            if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
               locationFound = true;
               if ( printDetailedInfo ) {
                 std::cout << "Orientation " << curGPAPatchData.patchOrientation << "selected for Patch: [" << icount
@@ -6403,7 +6502,7 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
     }
     if ( !locationFound ) {
       occupancySizeV *= 2;
-      occupancyMap.resize( occupancySizeU * occupancySizeV );
+      occupancyMap.resize( occupancySizeU, occupancySizeV );
       if ( printDetailedInfo ) { std::cout << "Increase occupancySizeV " << occupancySizeV << std::endl; }
     }
   }
@@ -6411,11 +6510,7 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
   for ( size_t v0 = 0; v0 < curGPAPatchData.sizeV0; ++v0 ) {
     for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
       int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
-      if ( params_.lowDelayEncoding_ ) {
-        occupancyMap[coord] = true;
-      } else {
-        occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
-      }
+      if ( params_.lowDelayEncoding_ || occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.setOccupied( coord ); }
     }
   }
   if ( !( curGPAPatchData.isPatchDimensionSwitched() ) ) {
@@ -6440,7 +6535,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
                                                            size_t&                      occupancySizeU,
                                                            size_t&                      occupancySizeV,
                                                            const size_t                 safeguard,
-                                                           std::vector<bool>&           occupancyMap,
+                                                           PCCPackingCanvas&            occupancyMap,
                                                            size_t&                      heightGPA,
                                                            size_t&                      widthGPA,
                                                            size_t&                      maxOccupancyRow ) {
@@ -6468,8 +6563,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
       }
       if ( curGPAPatchData.patchOrientation == -1 ) { assert( curGPAPatchData.patchOrientation != -1 ); }
 
-      if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
+      if ( patch.checkFitPatchCanvasForGPA( occupancyMap, params_.lowDelayEncoding_, safeguard ) ) {
         locationFound = true;
         if ( printDetailedInfo ) {
           std::cout << "Maintained TempGPA.orientation " << curGPAPatchData.patchOrientation << " for patch[" << icount
@@ -6480,12 +6574,14 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
 
       // if the patch couldn't fit, try to fit the patch in the top left
       // position
+      PCCPackingFootprint footprint;
+      patch.getPackingFootprintForGPA( footprint, curGPAPatchData.patchOrientation, params_.lowDelayEncoding_,
+                                       safeguard );
       for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-        for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
+        for ( int u = occupancyMap.getFirstCandidate( footprint, v ); u <= occupancySizeU && !locationFound; ++u ) {
           curGPAPatchData.u0 = u;
           curGPAPatchData.v0 = v;
-          if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                                safeguard ) ) {  // !!! function overload for GPA;
+          if ( occupancyMap.checkFit( footprint, u, v ) ) {  // !!! function overload for GPA;
             locationFound = true;
             if ( printDetailedInfo ) {
               std::cout << "Maintained TempGPA.orientation " << curGPAPatchData.patchOrientation
@@ -6496,9 +6592,17 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
         }
       }
     } else {
-      // best effort
+      // best effort: the orientation below always follows the patch aspect ratio
+      std::vector<PCCPackingFootprint> footprints( numOrientations );
+      for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+        patch.getPackingFootprintForGPA( footprints[orientationIdx],
+                                         patch.getSizeU0() > patch.getSizeV0() ? orientation_horizontal[orientationIdx]
+                                                                               : orientation_vertical[orientationIdx],
+                                         params_.lowDelayEncoding_, safeguard );
+      }
       for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-        for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+        for ( size_t u = occupancyMap.getFirstCandidate( footprints, v ); u < occupancySizeU && !locationFound;
+              ++u ) {
           curGPAPatchData.u0 = u;
           curGPAPatchData.v0 = v;
           for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
@@ -6510,8 +6614,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
                 curGPAPatchData.patchOrientation = orientation_vertical[orientationIdx];
               }
             }
-            if ( patch.checkFitPatchCanvasForGPA( occupancyMap, occupancySizeU, occupancySizeV,
-                                                  params_.lowDelayEncoding_, safeguard ) ) {
+            if ( occupancyMap.checkFit( footprints[orientationIdx], u, v ) ) {
               locationFound = true;
               if ( printDetailedInfo ) {
                 std::cout << "Maintained TempGPA.orientation " << curGPAPatchData.patchOrientation
@@ -6525,17 +6628,15 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
     }
     if ( !locationFound ) {
       occupancySizeV *= 2;
-      occupancyMap.resize( occupancySizeU * occupancySizeV );
+      occupancyMap.resize( occupancySizeU, occupancySizeV );
       if ( printDetailedInfo ) { std::cout << "Increase occupancySizeV " << occupancySizeV << std::endl; }
     }
   }
   for ( size_t v0 = 0; v0 < curGPAPatchData.sizeV0; ++v0 ) {
     for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
       int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
-      if ( params_.lowDelayEncoding_ ) {
-        occupancyMap[coord] = true;
-      } else {
-        occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curGPAPatchData.sizeU0 + u0];
+      if ( params_.lowDelayEncoding_ || occupancy[v0 * curGPAPatchData.sizeU0 + u0] ) {
+        occupancyMap.setOccupied( coord );
       }
     }
   }
@@ -55,6 +55,7 @@ PCCEncoderParameters::PCCEncoderParameters() {
   colorSpaceConversionConfig_              = {};
   inverseColorSpaceConversionConfig_       = {};
   nnNormalEstimation_                      = 16;
+  fastNormalEstimation_                    = false;
   gridBasedRefineSegmentation_             = true;
   maxNNCountRefineSegmentation_            = gridBasedRefineSegmentation_ ? 1024 : 256;
   iterationCountRefineSegmentation_        = gridBasedRefineSegmentation_ ? 10 : 100;
@@ -78,6 +79,7 @@ PCCEncoderParameters::PCCEncoderParameters() {
   occupancyPrecision_                      = 4;
   occupancyMapVideoEncoderConfig_          = {};
   occupancyMapQP_                          = 8;
+  occupancyMapCodecId_                     = CODEC_HEVC;
   occupancyMapRefinement_                  = false;
   postprocessSmoothingFilter_              = 1;
   flagGeometrySmoothing_                   = true;
@@ -120,7 +122,10 @@ PCCEncoderParameters::PCCEncoderParameters() {
   useRawPointsSeparateVideo_               = false;
   geometryMPConfig_                        = {};
   textureMPConfig_                         = {};
+  geometryMPCodecId_                       = CODEC_HEVC;
+  textureMPCodecId_                        = CODEC_HEVC;
   nbThread_                                = 1;
+  nbFrameParallelSegmentation_             = 1;
   keepIntermediateFiles_                   = false;
 
   absoluteD1_                             = true;
@@ -163,12 +168,13 @@ PCCEncoderParameters::PCCEncoderParameters() {
   levelOfDetailY_ = 1;
 
   // Flexible Patch Packing
-  packingStrategy_      = 1;
-  textureBGFill_        = 1;
-  safeGuardDistance_    = 0;
-  useEightOrientations_ = false;
-  lowDelayEncoding_     = false;
-  geometryPadding_      = 0U;
+  packingStrategy_        = 1;
+  textureBGFill_          = 1;
+  textureBGFillTolerance_ = 0.00001;
+  safeGuardDistance_      = 0;
+  useEightOrientations_   = false;
+  lowDelayEncoding_       = false;
+  geometryPadding_        = 0U;
 
   // lossy raw points patch
   lossyRawPointsPatch_             = false;
@@ -264,6 +270,7 @@ void PCCEncoderParameters::print() {
   std::cout << "\t groupOfFramesSize                        " << groupOfFramesSize_ << std::endl;
   std::cout << "\t colorTransform                           " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                                 " << nbThread_ << std::endl;
+  std::cout << "\t nbFrameParallelSegmentation              " << nbFrameParallelSegmentation_ << std::endl;
   std::cout << "\t keepIntermediateFiles                    " << keepIntermediateFiles_ << std::endl;
   std::cout << "\t absoluteD1                               " << absoluteD1_ << std::endl;
   std::cout << "\t multipleStreams                          " << multipleStreams_ << std::endl;
@@ -276,6 +283,7 @@ void PCCEncoderParameters::print() {
   std::cout << "\t maxNumRefIndex                           " << maxNumRefAtlasFrame_ << std::endl;
   std::cout << "\t Segmentation" << std::endl;
   std::cout << "\t   nnNormalEstimation                     " << nnNormalEstimation_ << std::endl;
+  std::cout << "\t   fastNormalEstimation                   " << fastNormalEstimation_ << std::endl;
   std::cout << "\t   gridBasedRefineSegmentation            " << gridBasedRefineSegmentation_ << std::endl;
   std::cout << "\t   maxNNCountRefineSegmentation           " << maxNNCountRefineSegmentation_ << std::endl;
   std::cout << "\t   iterationCountRefineSegmentation       " << iterationCountRefineSegmentation_ << std::endl;
@@ -313,6 +321,7 @@ void PCCEncoderParameters::print() {
   std::cout << "\t   patchPrecedenceOrder                   " << patchPrecedenceOrderFlag_ << std::endl;
   std::cout << "\t   lowDelayEncoding                       " << lowDelayEncoding_ << std::endl;
   std::cout << "\t   textureBGFill                          " << textureBGFill_ << std::endl;
+  std::cout << "\t   textureBGFillTolerance                 " << textureBGFillTolerance_ << std::endl;
   std::cout << "\t   geometryPadding                        " << geometryPadding_ << std::endl;
   std::cout << "\t Video encoding" << std::endl;
   std::cout << "\t   geometryQP                             " << geometryQP_ << std::endl;
@@ -338,6 +347,8 @@ void PCCEncoderParameters::print() {
       std::cout << "\t geometryMPConfig                     " << geometryMPConfig_ << std::endl;
       std::cout << "\t textureMPConfig                      " << textureMPConfig_ << std::endl;
     }
+    std::cout << "\t   geometryMPCodecId                      " << geometryMPCodecId_ << std::endl;
+    std::cout << "\t   textureMPCodecId                       " << textureMPCodecId_ << std::endl;
   }
   std::cout << "\t   colorSpaceConversionConfig             " << colorSpaceConversionConfig_ << std::endl;
   std::cout << "\t   inverseColorSpaceConversionConfig      " << inverseColorSpaceConversionConfig_ << std::endl;
@@ -350,6 +361,7 @@ void PCCEncoderParameters::print() {
   std::cout << "\t   occupancyPrecision                     " << occupancyPrecision_ << std::endl;
   std::cout << "\t   occupancyMapVideoEncoderConfig         " << occupancyMapVideoEncoderConfig_ << std::endl;
   std::cout << "\t   occupancyMapQP                         " << occupancyMapQP_ << std::endl;
+  std::cout << "\t   occupancyMapCodecId                    " << occupancyMapCodecId_ << std::endl;
   std::cout << "\t   EOMFixBitCount                         " << EOMFixBitCount_ << std::endl;
   std::cout << "\t   occupancyMapRefinement                 " << occupancyMapRefinement_ << std::endl;
   std::cout << "\t Lossy occupancy Map coding" << std::endl;
@@ -695,7 +707,12 @@ bool PCCEncoderParameters::check() {
     }
   }
 
-  if ( occupancyMapVideoEncoderConfig_.empty() ) {
+  if ( occupancyMapCodecId_ > CODEC_LOSSLESS || geometryMPCodecId_ > CODEC_LOSSLESS ||
+       textureMPCodecId_ > CODEC_LOSSLESS ) {
+    ret = false;
+    std::cerr << "the video codec ids must be 0 (HEVC) or 1 (built-in lossless codec) \n";
+  }
+  if ( occupancyMapVideoEncoderConfig_.empty() && occupancyMapCodecId_ == CODEC_HEVC ) {
     ret = false;
     std::cerr << "to use segmentation, you must define a segmentationDataPath \n";
   }
@@ -737,6 +754,10 @@ bool PCCEncoderParameters::check() {
     ret = false;
     std::cerr << "EOMFixBitCount shall be greater than 0. \n";
   }
+  if ( !std::isfinite( textureBGFillTolerance_ ) || textureBGFillTolerance_ < 0.0 ) {
+    ret = false;
+    std::cerr << "textureBGFillTolerance shall be a finite value greater than or equal to 0. \n";
+  }
   return ret;
 }
 
@@ -805,6 +826,8 @@ void PCCEncoderParameters::initializeContext( PCCContext& context ) {
     }
   }
 
+  oi.setOccupancyCodecId( static_cast<uint8_t>( occupancyMapCodecId_ ) );
+  gi.setAuxiliaryGeometryCodecId( static_cast<uint8_t>( geometryMPCodecId_ ) );
   ai.setAttributeCount( noAttributes_ ? 0 : 1 );
   ai.allocate();
   if ( static_cast<int>( noAttributes_ ) == 0 ) {
@@ -813,6 +836,7 @@ void PCCEncoderParameters::initializeContext( PCCContext& context ) {
   }
   for ( size_t i = 0; i < ai.getAttributeCount(); i++ ) {
     ai.setAttributeMapAbsoluteCodingPersistenceFlag( i, absoluteT1_ );
+    ai.setAuxiliaryAttributeCodecId( i, static_cast<uint8_t>( textureMPCodecId_ ) );
   }
   asps.setLog2PatchPackingBlockSize( std::log2( occupancyResolution_ ) );
   asps.setLog2MaxAtlasFrameOrderCntLsbMinus4( 4 );
@@ -153,15 +153,85 @@ void PCCNormalsGenerator3::computeNormal( const size_t
     numberOfNearestNeighborsInNormalEstimation_[index] = uint32_t( nNResult.count() );
   }
 }
+// Single precision version of computeNormal, with the neighbors searched by the caller: the covariance is accumulated
+// in float and diagonalized in closed form instead of by Jacobi iterations.
+void PCCNormalsGenerator3::computeNormalFast( const size_t                          index,
+                                              const PCCPointSet3&                   pointCloud,
+                                              const PCCNormalsGenerator3Parameters& params,
+                                              const size_t*                         neighbors,
+                                              const size_t                          neighborCount ) {
+  const PCCPoint3D* positions = pointCloud.getPositions().data();
+  PCCVector3<float> bary( positions[index][0], positions[index][1], positions[index][2] );
+  PCCVector3<float> normal( 0.F );
+  PCCVector3<float> eigenval( 0.F );
+  if ( neighborCount > 1 ) {
+    bary = 0.F;
+    for ( size_t i = 0; i < neighborCount; ++i ) {
+      const PCCPoint3D& point = positions[neighbors[i]];
+      bary += PCCVector3<float>( point[0], point[1], point[2] );
+    }
+    bary /= float( neighborCount );
+    float cov[6] = {0.F, 0.F, 0.F, 0.F, 0.F, 0.F};
+    for ( size_t i = 0; i < neighborCount; ++i ) {
+      const PCCPoint3D& point = positions[neighbors[i]];
+      const float       x     = point[0] - bary[0];
+      const float       y     = point[1] - bary[1];
+      const float       z     = point[2] - bary[2];
+      cov[0] += x * x;
+      cov[1] += y * y;
+      cov[2] += z * z;
+      cov[3] += x * y;
+      cov[4] += x * z;
+      cov[5] += y * z;
+    }
+    const float       scale = 1.F / ( neighborCount - 1.F );
+    PCCMatrix3<float> covMat;
+    covMat[0][0] = cov[0] * scale;
+    covMat[1][1] = cov[1] * scale;
+    covMat[2][2] = cov[2] * scale;
+    covMat[0][1] = covMat[1][0] = cov[3] * scale;
+    covMat[0][2] = covMat[2][0] = cov[4] * scale;
+    covMat[1][2] = covMat[2][1] = cov[5] * scale;
+    PCCDiagonalizeClosedForm( covMat, eigenval, normal );
+    eigenval = PCCVector3<float>( std::fabs( eigenval[0] ), std::fabs( eigenval[1] ), std::fabs( eigenval[2] ) );
+  }
+  const PCCVector3D normalD( normal[0], normal[1], normal[2] );
+  if ( normalD * ( params.viewPoint_ - pointCloud[index] ) < 0.0 ) {
+    normals_[index] = -normalD;
+  } else {
+    normals_[index] = normalD;
+  }
+  if ( params.storeEigenvalues_ ) { eigenvalues_[index] = PCCVector3D( eigenval[0], eigenval[1], eigenval[2] ); }
+  if ( params.storeCentroids_ ) { barycenters_[index] = PCCVector3D( bary[0], bary[1], bary[2] ); }
+  if ( params.storeNumberOfNearestNeighborsInNormalEstimation_ ) {
+    numberOfNearestNeighborsInNormalEstimation_[index] = uint32_t( neighborCount );
+  }
+}
 void PCCNormalsGenerator3::computeNormals( const PCCPointSet3&                   pointCloud,
                                            const PCCKdTree&                      kdtree,
                                            const PCCNormalsGenerator3Parameters& params ) {
   const size_t pointCount = pointCloud.getPointCount();
   normals_.resize( pointCount );
+  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+  if ( params.fastNormalEstimation_ ) {
+    // the neighbors are searched by batches of points, whose normals are then estimated in parallel
+    const size_t blockSize = 16384;
+    PCCNNResults results;
+    limited.execute( [&] {
+      for ( size_t start = 0; start < pointCount; start += blockSize ) {
+        const size_t count = ( std::min )( blockSize, pointCount - start );
+        kdtree.search( pointCloud.getPositions().data() + start, count,
+                       params.numberOfNearestNeighborsInNormalEstimation_, results );
+        tbb::parallel_for( size_t( 0 ), count, [&]( const size_t q ) {
+          computeNormalFast( start + q, pointCloud, params, results.indices( q ), results.count( q ) );
+        } );
+      }
+    } );
+    return;
+  }
   std::vector<size_t> subRanges;
   const size_t        chunckCount = 64;
   PCCDivideRange( 0, pointCount, chunckCount, subRanges );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
     tbb::parallel_for( size_t( 0 ), subRanges.size() - 1, [&]( const size_t i ) {
       const size_t start = subRanges[i];
@@ -173,28 +243,71 @@ void PCCNormalsGenerator3::computeNormals( const PCCPointSet3&
     } );
   } );
 }
+// Searches the neighbors used by the spanning tree orientation for all the points, by batches whose queries are run in
+// parallel, and stores them with a stride of nnCount.
+static void searchOrientationNeighbors( const PCCPointSet3&    pointCloud,
+                                        const PCCKdTree&       kdtree,
+                                        const size_t           nnCount,
+                                        const double           radius,
+                                        const size_t           nbThread,
+                                        std::vector<uint32_t>& neighbors,
+                                        std::vector<uint32_t>& neighborCounts ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  const size_t blockSize  = 16384;
+  PCCNNResults results;
+  neighbors.resize( pointCount * nnCount );
+  neighborCounts.resize( pointCount );
+  tbb::task_arena limited( static_cast<int>( nbThread ) );
+  limited.execute( [&] {
+    for ( size_t start = 0; start < pointCount; start += blockSize ) {
+      const size_t      count  = ( std::min )( blockSize, pointCount - start );
+      const PCCPoint3D* points = pointCloud.getPositions().data() + start;
+      if ( radius > 32768.0 ) {
+        kdtree.search( points, count, nnCount, results );
+      } else {
+        kdtree.searchRadius( points, count, nnCount, radius, results );
+      }
+      tbb::parallel_for( size_t( 0 ), count, [&]( const size_t q ) {
+        neighborCounts[start + q] = static_cast<uint32_t>( results.count( q ) );
+        for ( size_t i = 0; i < results.count( q ); ++i ) {
+          neighbors[( start + q ) * nnCount + i] = static_cast<uint32_t>( results.indices( q )[i] );
+        }
+      } );
+    }
+  } );
+}
 void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&                   pointCloud,
                                           const PCCKdTree&                      kdtree,
                                           const PCCNormalsGenerator3Parameters& params ) {
   if ( params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE ) {
-    const size_t pointCount = pointCloud.getPointCount();
-    PCCNNResult  nNResult;
+    const size_t          pointCount = pointCloud.getPointCount();
+    const size_t          nnCount    = params.numberOfNearestNeighborsInNormalOrientation_;
+    const double          radius =
+        static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_;
+    std::vector<uint32_t> neighbors;
+    std::vector<uint32_t> neighborCounts;
+    std::vector<uint32_t> seedNeighbors;
+    PCCNNResult           nNResult;
+    searchOrientationNeighbors( pointCloud, kdtree, nnCount, radius, nbThread_, neighbors, neighborCounts );
     visited_.resize( pointCount );
     std::fill( visited_.begin(), visited_.end(), 0 );
-    PCCNNQuery3 nNQuery             = {PCCPoint3D( 0.0 ),
-                           static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_,
-                           params.numberOfNearestNeighborsInNormalOrientation_};
-    PCCNNQuery3 nNQuery2            = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
-                            params.numberOfNearestNeighborsInNormalOrientation_};
-    size_t      processedPointCount = 0;
+    size_t processedPointCount = 0;
     for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
       if ( visited_[ptIndex] == 0u ) {
         visited_[ptIndex] = 1;
         ++processedPointCount;
         size_t      numberOfNormals;
         PCCVector3D accumulatedNormals;
-        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, nNQuery2, nNResult, accumulatedNormals,
-                      numberOfNormals );
+        // the first point of a tree is linked to its nearest neighbors whatever the radius
+        if ( radius > 32768.0 ) {
+          addNeighbors( uint32_t( ptIndex ), neighbors.data() + ptIndex * nnCount, neighborCounts[ptIndex],
+                        accumulatedNormals, numberOfNormals );
+        } else {
+          kdtree.search( pointCloud[ptIndex], nnCount, nNResult );
+          seedNeighbors.assign( nNResult.indices(), nNResult.indices() + nNResult.count() );
+          addNeighbors( uint32_t( ptIndex ), seedNeighbors.data(), seedNeighbors.size(), accumulatedNormals,
+                        numberOfNormals );
+        }
         if ( numberOfNormals == 0u ) {
           if ( ptIndex != 0u ) {
             accumulatedNormals = normals_[ptIndex - 1];
@@ -211,7 +324,8 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
             visited_[current] = 1;
             ++processedPointCount;
             if ( normals_[edge.start_] * normals_[current] < 0.0 ) { normals_[current] = -normals_[current]; }
-            addNeighbors( current, pointCloud, kdtree, nNQuery, nNResult, accumulatedNormals, numberOfNormals );
+            addNeighbors( current, neighbors.data() + size_t( current ) * nnCount, neighborCounts[current],
+                          accumulatedNormals, numberOfNormals );
           }
         }
       }
@@ -236,24 +350,17 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
     } );
   }
 }
-void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
-                                         const PCCPointSet3& pointCloud,
-                                         const PCCKdTree&    kdtree,
-                                         PCCNNQuery3&        nNQuery,
-                                         PCCNNResult&        nNResult,
-                                         PCCVector3D&        accumulatedNormals,
-                                         size_t&             numberOfNormals ) {
+void PCCNormalsGenerator3::addNeighbors( const uint32_t  current,
+                                         const uint32_t* neighbors,
+                                         const size_t    neighborCount,
+                                         PCCVector3D&    accumulatedNormals,
+                                         size_t&         numberOfNormals ) {
   accumulatedNormals = 0.0;
   numberOfNormals    = 0;
-  if ( nNQuery.radius > 32768.0 ) {
-    kdtree.search( pointCloud[current], nNQuery.nearestNeighborCount, nNResult );
-  } else {
-    kdtree.searchRadius( pointCloud[current], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
-  }
   PCCWeightedEdge newEdge;
   uint32_t        index;
-  for ( size_t i = 0; i < nNResult.count(); ++i ) {
-    index = static_cast<uint32_t>( nNResult.indices( i ) );
+  for ( size_t i = 0; i < neighborCount; ++i ) {
+    index = neighbors[i];
     if ( visited_[index] == 0u ) {
       newEdge.weight_ = fabs( normals_[current] * normals_[index] );
       newEdge.end_    = index;
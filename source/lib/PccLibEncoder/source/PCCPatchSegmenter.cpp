@@ -87,7 +87,8 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
                                                            PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE,
                                                            false,
                                                            false,
-                                                           false};
+                                                           false,
+                                                           params.fastNormalEstimation_};
   normalsGen.compute( geometry, kdtree, normalsGenParams, nbThread_ );
   std::cout << "[done]" << std::endl;
 
@@ -168,66 +169,72 @@ void PCCPatchSegmenter3::initialSegmentation( const PCCPointSet3&         geomet
   } );
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                                               const PCCKdTree&                  kdtree,
-                                               std::vector<std::vector<size_t>>& adj,
-                                               const size_t                      maxNNCount ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
-      PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+// Builds the rows of the graph by blocks of points: the neighbors of each block are searched by one batched query,
+// whose result arrays are reused from block to block, then the rows are sized from the counts of the results and
+// copied at their final offsets in parallel.
+template <typename Search>
+static void buildAdjacencyGraph( PCCAdjacencyGraph& adj,
+                                 const size_t       pointCount,
+                                 const bool         withDists,
+                                 const size_t       nbThread,
+                                 Search             search ) {
+  const size_t blockSize = 16384;
+  auto&        offsets   = adj.getOffsets();
+  auto&        indices   = adj.getIndices();
+  auto&        dists     = adj.getDists();
+  PCCNNResults results;
+  offsets.assign( pointCount + 1, 0 );
+  indices.clear();
+  dists.clear();
+  tbb::task_arena limited( static_cast<int>( nbThread ) );
+  for ( size_t start = 0; start < pointCount; start += blockSize ) {
+    const size_t end = ( std::min )( start + blockSize, pointCount );
+    limited.execute( [&] { search( start, end - start, results ); } );
+    for ( size_t i = start; i < end; ++i ) { offsets[i + 1] = offsets[i] + results.count( i - start ); }
+    indices.resize( offsets[end] );
+    if ( withDists ) { dists.resize( offsets[end] ); }
+    limited.execute( [&] {
+      tbb::parallel_for( start, end, [&]( const size_t i ) {
+        const size_t* nnIndices = results.indices( i - start );
+        const double* nnDists   = results.dist( i - start );
+        for ( size_t j = 0; j < offsets[i + 1] - offsets[i]; ++j ) {
+          indices[offsets[i] + j] = static_cast<uint32_t>( nnIndices[j] );
+          if ( withDists ) { dists[offsets[i] + j] = static_cast<float>( nnDists[j] ); }
+        }
+      } );
     } );
-  } );
+  }
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3&               pointCloud,
-                                                       const PCCKdTree&                  kdtree,
-                                                       std::vector<std::vector<size_t>>& adj,
-                                                       const size_t                      maxNNCount,
-                                                       const size_t                      radius ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
-      PCCNNResult result;
-      kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
-      std::vector<size_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
-    } );
-  } );
+void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                                               const PCCKdTree&    kdtree,
+                                               PCCAdjacencyGraph&  adj,
+                                               const size_t        maxNNCount ) {
+  buildAdjacencyGraph( adj, pointCloud.getPointCount(), false, nbThread_,
+                       [&]( size_t start, size_t count, PCCNNResults& results ) {
+                         kdtree.search( &pointCloud.getPositions()[start], count, maxNNCount, results );
+                       } );
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                                   const PCCKdTree&                  kdtree,
-                                                   std::vector<std::vector<size_t>>& adj,
-                                                   std::vector<std::vector<double>>& adjDist,
-                                                   const size_t                      maxNNCount ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
-  adjDist.resize( pointCount );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
-      PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors     = adj[i];
-      std::vector<double>& neighborsDist = adjDist[i];
-      neighbors.resize( result.count() );
-      neighborsDist.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) {
-        neighbors[j]     = result.indices( j );
-        neighborsDist[j] = result.dist( j );
-      }
-    } );
-  } );
+void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3& pointCloud,
+                                                       const PCCKdTree&    kdtree,
+                                                       PCCAdjacencyGraph&  adj,
+                                                       const size_t        maxNNCount,
+                                                       const size_t        radius ) {
+  buildAdjacencyGraph( adj, pointCloud.getPointCount(), false, nbThread_,
+                       [&]( size_t start, size_t count, PCCNNResults& results ) {
+                         kdtree.searchRadius( &pointCloud.getPositions()[start], count, maxNNCount, radius, results );
+                       } );
+}
+
+void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3& pointCloud,
+                                                   const PCCKdTree&    kdtree,
+                                                   PCCAdjacencyGraph&  adj,
+                                                   const size_t        maxNNCount ) {
+  buildAdjacencyGraph( adj, pointCloud.getPointCount(), true, nbThread_,
+                       [&]( size_t start, size_t count, PCCNNResults& results ) {
+                         kdtree.search( &pointCloud.getPositions()[start], count, maxNNCount, results );
+                       } );
 }
 
 void printChunk( const std::vector<std::pair<int, int>>& chunk ) {
@@ -498,19 +505,18 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   size_t numEOMOnlyPoints = 0;
   // size_t numRawPoints=0;
   std::cout << "\n\t Computing adjacency info... ";
-  std::vector<std::vector<size_t>>              adj;
-  std::vector<std::vector<double>>              adjDist;
-  std::vector<bool>                             flagExp;
-  int                                           numROIs;
-  int                                           numChunks;
-  std::vector<PCCPointSet3>                     pointsChunks;
-  std::vector<std::vector<size_t>>              pointsIndexChunks;
-  std::vector<size_t>                           pointCountChunks;
-  std::vector<PCCKdTree>                        kdtreeChunks;
-  std::vector<PCCBox3D>                         boundingBoxChunks;
-  std::vector<std::vector<std::vector<size_t>>> adjChunks;
+  PCCAdjacencyGraph                adj;
+  std::vector<bool>                flagExp;
+  int                              numROIs;
+  int                              numChunks;
+  std::vector<PCCPointSet3>        pointsChunks;
+  std::vector<std::vector<size_t>> pointsIndexChunks;
+  std::vector<size_t>              pointCountChunks;
+  std::vector<PCCKdTree>           kdtreeChunks;
+  std::vector<PCCBox3D>            boundingBoxChunks;
+  std::vector<PCCAdjacencyGraph>   adjChunks;
   if ( patchExpansionEnabled ) {
-    computeAdjacencyInfoDist( points, kdtree, adj, adjDist, maxNNCount );
+    computeAdjacencyInfoDist( points, kdtree, adj, maxNNCount );
     flagExp.resize( pointCount, false );
   } else {
     if ( !enablePointCloudPartitioning ) {
@@ -887,7 +893,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
                  ( clusterIndex + 3 == partition[n] ) || ( clusterIndex == partition[n] + 3 ) ) {
               continue;
             }
-            const double dist2 = adjDist[i][ac];  // sum of square
+            const double dist2 = adj.getDists( i )[ac];  // sum of square
             if ( dist2 <= 2 ) {                   // <-- expansion distance
               fifoa.push_back( n );
               flagExp[n] = true;  // add point
@@ -1255,7 +1261,7 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
                                              const size_t                iterationCount,
                                              std::vector<size_t>&        partition ) {
   assert( orientations );
-  std::vector<std::vector<size_t>> adj;
+  PCCAdjacencyGraph adj;
   computeAdjacencyInfo( pointCloud, kdtree, adj, maxNNCount );
   const size_t                     pointCount = pointCloud.getPointCount();
   const double                     weight     = lambda / maxNNCount;
@@ -1322,87 +1328,103 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   const size_t gridDimShiftSqr = gridDimShift << 1;
   const size_t voxDimHalf      = voxDim >> 1;
 
-  struct voxelType {
-    std::vector<size_t> pointIndices;
-    std::vector<size_t> scoreSmooth;
-
-    size_t pointCount;
-    void   init( size_t cap, size_t orientationCount ) {
-      pointIndices.reserve( cap );
-      scoreSmooth.resize( orientationCount, 0 );
-      pointCount = 0;
-    }
-  };
   auto subToInd = [&]( size_t x, size_t y, size_t z ) { return x + ( y << gridDimShift ) + ( z << gridDimShiftSqr ); };
 
-  PCCPointSet3                          gridCenters;
-  std::unordered_map<size_t, voxelType> grid;
-  for ( size_t i = 0; i < pointCount; ++i ) {
-    const auto&  pos = pointCloud[i];
-    const size_t x0  = ( ( static_cast<size_t>( pos[0] ) + voxDimHalf ) >> voxDimShift );
-    const size_t y0  = ( ( static_cast<size_t>( pos[1] ) + voxDimHalf ) >> voxDimShift );
-    const size_t z0  = ( ( static_cast<size_t>( pos[2] ) + voxDimHalf ) >> voxDimShift );
-    size_t       p   = subToInd( x0, y0, z0 );
-    if ( grid.count( p ) == 0u ) {
-      grid[p].init( 64, orientationCount );
-      gridCenters.addPoint( PCCVector3D( x0, y0, z0 ) );
+  // The voxels are numbered in the order of their first point, as the grid centers, and stored densely: the points
+  // of the voxel v are voxelPoints[ voxelOffsets[v]; voxelOffsets[v+1] ), in point order. The voxels are found by
+  // sorting the points on their voxel key.
+  std::vector<std::pair<size_t, uint32_t>> keys( pointCount );
+  tbb::task_arena                          limited( static_cast<int>( nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+      const auto&  pos = pointCloud[i];
+      const size_t x0  = ( ( static_cast<size_t>( pos[0] ) + voxDimHalf ) >> voxDimShift );
+      const size_t y0  = ( ( static_cast<size_t>( pos[1] ) + voxDimHalf ) >> voxDimShift );
+      const size_t z0  = ( ( static_cast<size_t>( pos[2] ) + voxDimHalf ) >> voxDimShift );
+      keys[i]          = std::make_pair( subToInd( x0, y0, z0 ), static_cast<uint32_t>( i ) );
+    } );
+    tbb::parallel_sort( keys.begin(), keys.end() );
+  } );
+  const uint32_t        undefinedVoxel = ( std::numeric_limits<uint32_t>::max )();
+  std::vector<uint32_t> firstPointGroup( pointCount, undefinedVoxel );
+  std::vector<uint32_t> pointGroup( pointCount );
+  uint32_t              groupCount = 0;
+  for ( size_t k = 0; k < pointCount; ++k ) {
+    if ( k == 0 || keys[k].first != keys[k - 1].first ) { firstPointGroup[keys[k].second] = groupCount++; }
+    pointGroup[keys[k].second] = groupCount - 1;
+  }
+  std::vector<uint32_t> groupToVoxel( groupCount );
+  std::vector<size_t>   voxelOffsets( groupCount + 1, 0 );
+  PCCPointSet3          gridCenters;
+  gridCenters.resize( groupCount );
+  for ( size_t i = 0, voxelIndex = 0; i < pointCount; ++i ) {
+    if ( firstPointGroup[i] != undefinedVoxel ) {
+      const auto& pos = pointCloud[i];
+      gridCenters[voxelIndex] =
+          PCCPoint3D( ( ( static_cast<size_t>( pos[0] ) + voxDimHalf ) >> voxDimShift ),
+                      ( ( static_cast<size_t>( pos[1] ) + voxDimHalf ) >> voxDimShift ),
+                      ( ( static_cast<size_t>( pos[2] ) + voxDimHalf ) >> voxDimShift ) );
+      groupToVoxel[firstPointGroup[i]] = static_cast<uint32_t>( voxelIndex++ );
     }
-    auto& voxel = grid[p];
-    voxel.pointIndices.push_back( i );
-    voxel.pointCount++;
+    ++voxelOffsets[groupToVoxel[pointGroup[i]] + 1];
+  }
+  const size_t voxelCount = groupCount;
+  for ( size_t v = 0; v < voxelCount; ++v ) { voxelOffsets[v + 1] += voxelOffsets[v]; }
+  std::vector<uint32_t> voxelPoints( pointCount );
+  std::vector<size_t>   voxelFill( voxelOffsets.begin(), voxelOffsets.end() - 1 );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    voxelPoints[voxelFill[groupToVoxel[pointGroup[i]]]++] = static_cast<uint32_t>( i );
   }
+  std::vector<std::pair<size_t, uint32_t>>().swap( keys );
 
-  PCCKdTree                        kdtree( gridCenters );
-  const size_t                     voxSearchRadius  = searchRadius >> voxDimShift;
-  const size_t                     maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
-  std::vector<std::vector<size_t>> adj( gridCenters.getPointCount() );
+  PCCKdTree         kdtree( gridCenters );
+  const size_t      voxSearchRadius  = searchRadius >> voxDimShift;
+  const size_t      maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
+  PCCAdjacencyGraph adj;
   computeAdjacencyInfoInRadius( gridCenters, kdtree, adj, maxNeighborCount, voxSearchRadius );
 
-  std::vector<size_t> tmpPartition( pointCount );
+  // Each iteration only reads the partition of the previous one: the voxel scores are counted, then the points of
+  // the voxels are classified, both in parallel over the voxels.
+  std::vector<uint32_t>                                voxelScores( voxelCount * orientationCount );
+  std::vector<size_t>                                  tmpPartition( pointCount );
+  tbb::enumerable_thread_specific<std::vector<size_t>> scoreSmoothBuffers( std::vector<size_t>( orientationCount, 0 ) );
   for ( size_t n = 0; n < iterationCount; ++n ) {
-    for ( auto& gridElm : grid ) {
-      auto& voxel = gridElm.second;
-      std::fill( voxel.scoreSmooth.begin(), voxel.scoreSmooth.end(), 0 );
-      for ( auto& j : voxel.pointIndices ) { ++voxel.scoreSmooth[partition[j]]; }
-    }
-    /*tbb::task_arena limited((int)nbThread_);
-    limited.execute([&] {
-      tbb::parallel_for(size_t(0), gridCenters.getPointCount(), [&](const size_t
-    i) {*/
-    for ( size_t i = 0; i < gridCenters.getPointCount(); ++i ) {
-      auto&               pos = gridCenters[i];
-      size_t              p   = subToInd( pos[0], pos[1], pos[2] );
-      std::vector<size_t> scoreSmooth( orientationCount, 0 );
-      size_t              nnPointCount = 0;
-      for ( auto& j : adj[i] ) {
-        auto&  pos = gridCenters[j];
-        size_t q   = subToInd( pos[0], pos[1], pos[2] );
-        /*std::transform(scoreSmooth.begin(), scoreSmooth.end(),
-          grid[q].scoreSmooth.begin(),
-          scoreSmooth.begin(), std::plus<size_t>());*/
-        auto& vox = grid[q];
-        for ( size_t k = 0; k < orientationCount; ++k ) { scoreSmooth[k] += vox.scoreSmooth[k]; }
-        nnPointCount += vox.pointCount;
-        if ( nnPointCount >= maxNNCount ) { break; }
-      }
-      const double weight = lambda / nnPointCount;
-      auto&        pI     = grid[p].pointIndices;
-      for ( auto& j : pI ) {
-        const PCCVector3D normal       = normalsGen.getNormal( j );
-        size_t            clusterIndex = partition[j];
-        double            bestScore    = 0.0;
-        for ( size_t k = 0; k < orientationCount; ++k ) {
-          const double scoreNormal = normal * orientations[k];
-          const double score       = scoreNormal + weight * scoreSmooth[k];
-          if ( score > bestScore ) {
-            bestScore    = score;
-            clusterIndex = k;
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), voxelCount, [&]( const size_t v ) {
+        uint32_t* scores = voxelScores.data() + v * orientationCount;
+        std::fill( scores, scores + orientationCount, 0 );
+        for ( size_t k = voxelOffsets[v]; k < voxelOffsets[v + 1]; ++k ) { ++scores[partition[voxelPoints[k]]]; }
+      } );
+    } );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), voxelCount, [&]( const size_t v ) {
+        auto& scoreSmooth = scoreSmoothBuffers.local();
+        std::fill( scoreSmooth.begin(), scoreSmooth.end(), 0 );
+        size_t nnPointCount = 0;
+        for ( const auto q : adj[v] ) {
+          const uint32_t* scores = voxelScores.data() + q * orientationCount;
+          for ( size_t o = 0; o < orientationCount; ++o ) { scoreSmooth[o] += scores[o]; }
+          nnPointCount += voxelOffsets[q + 1] - voxelOffsets[q];
+          if ( nnPointCount >= maxNNCount ) { break; }
+        }
+        const double weight = lambda / nnPointCount;
+        for ( size_t k = voxelOffsets[v]; k < voxelOffsets[v + 1]; ++k ) {
+          const size_t      j            = voxelPoints[k];
+          const PCCVector3D normal       = normalsGen.getNormal( j );
+          size_t            clusterIndex = partition[j];
+          double            bestScore    = 0.0;
+          for ( size_t o = 0; o < orientationCount; ++o ) {
+            const double scoreNormal = normal * orientations[o];
+            const double score       = scoreNormal + weight * scoreSmooth[o];
+            if ( score > bestScore ) {
+              bestScore    = score;
+              clusterIndex = o;
+            }
           }
+          tmpPartition[j] = clusterIndex;
         }
-        tmpPartition[j] = clusterIndex;
-      }
-    } /*);
-   });*/
+      } );
+    } );
     swap( tmpPartition, partition );
   }
 }
@@ -1427,7 +1449,7 @@ void PCCPatchSegmenter3::separateHighGradientPoints( const PCCPointSet3&
                                                      const double                      minGradient,
                                                      const size_t                      minNumHighGradientPoints,
                                                      std::vector<size_t>&              partition,
-                                                     std::vector<std::vector<size_t>>& adj,
+                                                     const PCCAdjacencyGraph&          adj,
                                                      std::vector<std::vector<size_t>>& connectedComponents ) {
   // detect and remove high gradient points
   std::vector<std::vector<size_t>> highGradientConnectedComponents;
@@ -1615,7 +1637,7 @@ void PCCPatchSegmenter3::calculateGradient( const PCCPointSet3&               po
                                             const double                      minGradient,
                                             const size_t                      minNumHighGradientPoints,
                                             PCCPatch&                         patch,
-                                            std::vector<std::vector<size_t>>& adj,
+                                            const PCCAdjacencyGraph&          adj,
                                             std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                             std::vector<bool>&                isRemoved ) {
   /* for the case that the xyz components of a normal are the same:
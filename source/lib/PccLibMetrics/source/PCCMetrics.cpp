@@ -54,8 +54,7 @@ void convertRGBtoYUV( const PCCColor3B& rgb, std::vector<float>& yuv ) {
   yuv[2] = float( ( 0.615 * rgb[0] - 0.515 * rgb[1] - 0.100 * rgb[2] ) / 255.0 );
 }
 
-void convertRGBtoYUV_BT709( const PCCColor3B& rgb, std::vector<float>& yuv ) {
-  yuv.resize( 3 );
+static void convertRGBtoYUV_BT709( const PCCColor3B& rgb, float* yuv ) {
   yuv[0] = float( ( 0.2126 * rgb[0] + 0.7152 * rgb[1] + 0.0722 * rgb[2] ) / 255.0 );
   yuv[1] = float( ( -0.1146 * rgb[0] - 0.3854 * rgb[1] + 0.5000 * rgb[2] ) / 255.0 + 0.5000 );
   yuv[2] = float( ( 0.5000 * rgb[0] - 0.4542 * rgb[1] - 0.0458 * rgb[2] ) / 255.0 + 0.5000 );
@@ -80,134 +79,166 @@ QualityMetrics::QualityMetrics() :
 void QualityMetrics::setParameters( const PCCMetricsParameters& params ) { params_ = params; }
 
 void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet3& pointcloudB ) {
-  double maxC2c         = ( std::numeric_limits<double>::min )();
-  double maxC2p         = ( std::numeric_limits<double>::min )();
-  double sseC2p         = 0;
-  double sseC2c         = 0;
-  double sseReflectance = 0;
-  size_t num            = 0;
-  double sseColor[3];
-  sseColor[0] = sseColor[1] = sseColor[2] = 0.0;
-
-  psnr_ = params_.resolution_;
-
-  PCCKdTree    kdtree( pointcloudB );
-  PCCNNResult  result;
+  // Errors accumulated over a block of points of A, summed in block order to keep the results deterministic.
+  struct BlockErrors {
+    double maxC2c         = ( std::numeric_limits<double>::min )();
+    double maxC2p         = ( std::numeric_limits<double>::min )();
+    double sseC2p         = 0;
+    double sseC2c         = 0;
+    double sseReflectance = 0;
+    double sseColor[3]    = {0.0, 0.0, 0.0};
+  };
+  const size_t blockSize        = 4096;
   const size_t num_results_max  = 30;
   const size_t num_results_incr = 5;
+  const size_t pointCountA      = pointcloudA.getPointCount();
+  const size_t pointCountB      = pointcloudB.getPointCount();
+  const bool   useC2p           = params_.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals();
+  const bool   useColor         = params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors();
+  const bool   useReflectance   =
+      params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances();
+  const size_t num              = pointCountA;
+
+  psnr_ = params_.resolution_;
 
-  auto& normalsB = pointcloudB.getNormals();
-  for ( size_t indexA = 0; indexA < pointcloudA.getPointCount(); indexA++ ) {
-    // For point 'i' in A, find its nearest neighbor in B. store it in 'j'
-    size_t num_results = 0;
-    do {
-      num_results += num_results_incr;
+  PCCKdTree                kdtree( pointcloudB );
+  std::vector<BlockErrors> blockErrors( ( pointCountA + blockSize - 1 ) / blockSize );
+  auto&                    normalsB = pointcloudB.getNormals();
+  tbb::parallel_for( size_t( 0 ), blockErrors.size(), [&]( const size_t block ) {
+    auto&       errors = blockErrors[block];
+    PCCNNResult result;
+    size_t      sameDistList[num_results_max];
+    for ( size_t indexA = block * blockSize; indexA < ( std::min )( pointCountA, ( block + 1 ) * blockSize );
+          indexA++ ) {
+      // For point 'i' in A, find its nearest neighbor in B. store it in 'j'. The search is only extended to the
+      // maximum number of results when all the first neighbors are at the same distance: the neighbors of same
+      // distance are then the ones a progressively growing search finds.
+      size_t num_results = ( std::min )( num_results_incr, pointCountB );
       kdtree.search( pointcloudA[indexA], num_results, result );
-    } while ( result.dist( 0 ) == result.dist( num_results - 1 ) && num_results + num_results_incr <= num_results_max );
+      if ( num_results < pointCountB && result.dist( 0 ) == result.dist( num_results - 1 ) ) {
+        num_results = ( std::min )( num_results_max, pointCountB );
+        kdtree.search( pointcloudA[indexA], num_results, result );
+      }
 
-    // Compute point-to-point, which should be equal to sqrt( dist[0] )
-    double distProjC2c = result.dist( 0 );
+      // Compute point-to-point, which should be equal to sqrt( dist[0] )
+      double distProjC2c = result.dist( 0 );
 
-    // Build the list of all the points of same distances.
-    std::vector<size_t> sameDistList;
-    if ( params_.computeColor_ || params_.computeC2p_ ) {
-      for ( size_t j = 0; j < num_results && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
-        sameDistList.push_back( result.indices( j ) );
+      // Build the list of all the points of same distances.
+      size_t sameDistCount = 0;
+      if ( params_.computeColor_ || params_.computeC2p_ ) {
+        for ( size_t j = 0; j < num_results && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
+          sameDistList[sameDistCount++] = result.indices( j );
+        }
       }
-    }
-    std::sort( sameDistList.begin(), sameDistList.end() );
+      std::sort( sameDistList, sameDistList + sameDistCount );
 
-    // Compute point-to-plane, normals in B will be used for point-to-plane
-    double distProjC2p = 0.0;
-    if ( params_.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals() ) {
-      for ( auto& indexB : sameDistList ) {
-        std::vector<double> errVector( 3 );
-        for ( size_t j = 0; j < 3; j++ ) { errVector[j] = pointcloudA[indexA][j] - pointcloudB[indexB][j]; }
-        double dist = pow( errVector[0] * normalsB[indexB][0] + errVector[1] * normalsB[indexB][1] +
-                               errVector[2] * normalsB[indexB][2],
-                           2.F );
-        distProjC2p += dist;
+      // Compute point-to-plane, normals in B will be used for point-to-plane
+      double distProjC2p = 0.0;
+      if ( useC2p ) {
+        for ( size_t k = 0; k < sameDistCount; k++ ) {
+          const size_t indexB = sameDistList[k];
+          double       errVector[3];
+          for ( size_t j = 0; j < 3; j++ ) { errVector[j] = pointcloudA[indexA][j] - pointcloudB[indexB][j]; }
+          double dist = pow( errVector[0] * normalsB[indexB][0] + errVector[1] * normalsB[indexB][1] +
+                                 errVector[2] * normalsB[indexB][2],
+                             2.F );
+          distProjC2p += dist;
+        }
+        distProjC2p /= sameDistCount;
       }
-      distProjC2p /= sameDistList.size();
-    }
 
-    size_t indexB = result.indices( 0 );
-    double distColor[3];
-    distColor[0] = distColor[1] = distColor[2] = 0.0;
-    if ( params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors() ) {
-      std::vector<float> yuvA;
-      std::vector<float> yuvB;
-      PCCColor3B         rgb;
-      convertRGBtoYUV_BT709( pointcloudA.getColor( indexA ), yuvA );
-      if ( params_.neighborsProc_ != 0 ) {
-        switch ( params_.neighborsProc_ ) {
-          case 0: break;
-          case 1:  // Average
-          case 2:  // Weighted average
-          {
-            int          nbdupcumul = 0;
-            unsigned int r          = 0;
-            unsigned int g          = 0;
-            unsigned int b          = 0;
-            for ( unsigned long long i : sameDistList ) {
-              int nbdup = 1;  // pointcloudB.xyz.nbdup[ indices_sameDst[n] ];
-              r += nbdup * pointcloudB.getColor( i )[0];
-              g += nbdup * pointcloudB.getColor( i )[1];
-              b += nbdup * pointcloudB.getColor( i )[2];
-              nbdupcumul += nbdup;
-            }
-            rgb[0] = static_cast<unsigned char>( round( static_cast<double>( r ) / nbdupcumul ) );
-            rgb[1] = static_cast<unsigned char>( round( static_cast<double>( g ) / nbdupcumul ) );
-            rgb[2] = static_cast<unsigned char>( round( static_cast<double>( b ) / nbdupcumul ) );
-            convertRGBtoYUV_BT709( rgb, yuvB );
-            for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
-          } break;
-          case 3:  // Min
-          case 4:  // Max
-          {
-            float  distBest  = 0;
-            size_t indexBest = 0;
-            for ( auto index : sameDistList ) {
-              convertRGBtoYUV_BT709( pointcloudB.getColor( index ), yuvB );
-              float dist =
-                  pow( yuvA[0] - yuvB[0], 2.F ) + pow( yuvA[1] - yuvB[1], 2.F ) + pow( yuvA[2] - yuvB[2], 2.F );
-              if ( ( ( params_.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
-                   ( ( params_.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
-                distBest  = dist;
-                indexBest = index;
+      size_t indexB = result.indices( 0 );
+      double distColor[3];
+      distColor[0] = distColor[1] = distColor[2] = 0.0;
+      if ( useColor ) {
+        float      yuvA[3];
+        float      yuvB[3];
+        PCCColor3B rgb;
+        convertRGBtoYUV_BT709( pointcloudA.getColor( indexA ), yuvA );
+        if ( params_.neighborsProc_ != 0 ) {
+          switch ( params_.neighborsProc_ ) {
+            case 0: break;
+            case 1:  // Average
+            case 2:  // Weighted average
+            {
+              int          nbdupcumul = 0;
+              unsigned int r          = 0;
+              unsigned int g          = 0;
+              unsigned int b          = 0;
+              for ( size_t k = 0; k < sameDistCount; k++ ) {
+                const size_t i     = sameDistList[k];
+                int          nbdup = 1;  // pointcloudB.xyz.nbdup[ indices_sameDst[n] ];
+                r += nbdup * pointcloudB.getColor( i )[0];
+                g += nbdup * pointcloudB.getColor( i )[1];
+                b += nbdup * pointcloudB.getColor( i )[2];
+                nbdupcumul += nbdup;
+              }
+              rgb[0] = static_cast<unsigned char>( round( static_cast<double>( r ) / nbdupcumul ) );
+              rgb[1] = static_cast<unsigned char>( round( static_cast<double>( g ) / nbdupcumul ) );
+              rgb[2] = static_cast<unsigned char>( round( static_cast<double>( b ) / nbdupcumul ) );
+              convertRGBtoYUV_BT709( rgb, yuvB );
+            } break;
+            case 3:  // Min
+            case 4:  // Max
+            {
+              float  distBest  = 0;
+              size_t indexBest = 0;
+              for ( size_t k = 0; k < sameDistCount; k++ ) {
+                const size_t index = sameDistList[k];
+                convertRGBtoYUV_BT709( pointcloudB.getColor( index ), yuvB );
+                float dist =
+                    pow( yuvA[0] - yuvB[0], 2.F ) + pow( yuvA[1] - yuvB[1], 2.F ) + pow( yuvA[2] - yuvB[2], 2.F );
+                if ( ( ( params_.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
+                     ( ( params_.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
+                  distBest  = dist;
+                  indexBest = index;
+                }
               }
-            }
-            convertRGBtoYUV_BT709( pointcloudB.getColor( indexBest ), yuvB );
-          } break;
+              convertRGBtoYUV_BT709( pointcloudB.getColor( indexBest ), yuvB );
+            } break;
+          }
+        } else {
+          convertRGBtoYUV_BT709( pointcloudB.getColor( indexB ), yuvB );
         }
-      } else {
-        convertRGBtoYUV_BT709( pointcloudB.getColor( indexB ), yuvB );
+        for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
       }
-      for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
-    }
 
-    double distReflectance = 0.0;
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
-      distReflectance = pow( pointcloudA.getReflectance( indexA ) - pointcloudB.getReflectance( indexB ), 2.F );
-    }
-    num++;
+      double distReflectance = 0.0;
+      if ( useReflectance ) {
+        distReflectance = pow( pointcloudA.getReflectance( indexA ) - pointcloudB.getReflectance( indexB ), 2.F );
+      }
 
-    // mean square distance
-    if ( params_.computeC2c_ ) {
-      sseC2c += distProjC2c;
-      if ( distProjC2c > maxC2c ) { maxC2c = distProjC2c; }
-    }
-    if ( params_.computeC2p_ ) {
-      sseC2p += distProjC2p;
-      if ( distProjC2p > maxC2p ) { maxC2p = distProjC2p; }
-    }
-    if ( params_.computeColor_ ) {
-      for ( size_t i = 0; i < 3; i++ ) { sseColor[i] += distColor[i]; }
-    }
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
-      sseReflectance += distReflectance;
+      // mean square distance
+      if ( params_.computeC2c_ ) {
+        errors.sseC2c += distProjC2c;
+        if ( distProjC2c > errors.maxC2c ) { errors.maxC2c = distProjC2c; }
+      }
+      if ( params_.computeC2p_ ) {
+        errors.sseC2p += distProjC2p;
+        if ( distProjC2p > errors.maxC2p ) { errors.maxC2p = distProjC2p; }
+      }
+      if ( params_.computeColor_ ) {
+        for ( size_t i = 0; i < 3; i++ ) { errors.sseColor[i] += distColor[i]; }
+      }
+      if ( useReflectance ) { errors.sseReflectance += distReflectance; }
     }
+  } );
+
+  BlockErrors errors;
+  for ( auto& blockError : blockErrors ) {
+    errors.maxC2c = ( std::max )( errors.maxC2c, blockError.maxC2c );
+    errors.maxC2p = ( std::max )( errors.maxC2p, blockError.maxC2p );
+    errors.sseC2c += blockError.sseC2c;
+    errors.sseC2p += blockError.sseC2p;
+    errors.sseReflectance += blockError.sseReflectance;
+    for ( size_t i = 0; i < 3; i++ ) { errors.sseColor[i] += blockError.sseColor[i]; }
   }
+  const double maxC2c         = errors.maxC2c;
+  const double maxC2p         = errors.maxC2p;
+  const double sseC2c         = errors.sseC2c;
+  const double sseC2p         = errors.sseC2p;
+  const double sseReflectance = errors.sseReflectance;
+  const double sseColor[3]    = {errors.sseColor[0], errors.sseColor[1], errors.sseColor[2]};
 
   if ( params_.computeC2c_ ) {
     c2cMse_  = float( sseC2c / num );
@@ -374,9 +405,13 @@ void PCCMetrics::compute( PCCPointSet3& source, PCCPointSet3& reconstruct, const
   QualityMetrics q1;
   QualityMetrics q2;
   q1.setParameters( params_ );
-  q1.compute( source, reconstruct );
   q2.setParameters( params_ );
-  q2.compute( reconstruct, source );
+  // the two directions are independent and computed at the same time.
+  tbb::task_arena limited( params_.nbThread_ > 0 ? static_cast<int>( params_.nbThread_ )
+                                                 : static_cast<int>( tbb::task_arena::automatic ) );
+  limited.execute( [&] {
+    tbb::parallel_invoke( [&] { q1.compute( source, reconstruct ); }, [&] { q2.compute( reconstruct, source ); } );
+  } );
   quality1.push_back( q1 );
   quality2.push_back( q2 );
   qualityF.push_back( q1 + q2 );
@@ -38,6 +38,28 @@
 
 using namespace pcc;
 
+// read only stream buffer over the bytes of a video bitstream, seekable as the HM byte stream reader requires
+class PCCMemoryStreamBuffer : public std::streambuf {
+ public:
+  PCCMemoryStreamBuffer( const uint8_t* data, size_t size ) {
+    char* begin = reinterpret_cast<char*>( const_cast<uint8_t*>( data ) );
+    setg( begin, begin, begin + size );
+  }
+
+ protected:
+  pos_type seekoff( off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which ) override {
+    if ( ( which & std::ios_base::in ) == 0 ) { return pos_type( off_type( -1 ) ); }
+    char* base     = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+    char* position = base + offset;
+    if ( position < eback() || position > egptr() ) { return pos_type( off_type( -1 ) ); }
+    setg( eback(), position, egptr() );
+    return pos_type( off_type( position - eback() ) );
+  }
+  pos_type seekpos( pos_type position, std::ios_base::openmode which ) override {
+    return seekoff( off_type( position ), std::ios_base::beg, which );
+  }
+};
+
 template <typename T>
 PCCHMLibVideoDecoderImpl<T>::PCCHMLibVideoDecoderImpl() {}
 
@@ -49,12 +71,11 @@ void PCCHMLibVideoDecoderImpl<T>::decode( PCCVideoBitstream& bitstream,
                                           size_t             outputBitDepth,
                                           bool               RGB2GBR,
                                           PCCVideo<T, 3>&    video ) {
-  std::string         s( reinterpret_cast<char*>( bitstream.buffer() ), bitstream.size() );
-  std::istringstream  iss( s );
-  std::istream&       bitstreamFile = iss;
-  Int                 poc;
-  TComList<TComPic*>* pcListPic = NULL;
-  m_bRGB2GBR                    = RGB2GBR;
+  PCCMemoryStreamBuffer streamBuffer( bitstream.buffer(), bitstream.size() );
+  std::istream          bitstreamFile( &streamBuffer );
+  Int                   poc;
+  TComList<TComPic*>*   pcListPic = NULL;
+  m_bRGB2GBR                      = RGB2GBR;
   InputByteStream bytestream( bitstreamFile );
   if ( outputBitDepth ) {
     m_outputBitDepth[CHANNEL_TYPE_LUMA]   = outputBitDepth;